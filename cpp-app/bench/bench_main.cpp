@@ -0,0 +1,508 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include "VulnerabilityManager.h"
+#include "SystemChecker.h"
+#include "OllamaClient.h"
+
+// Benchmarks dos caminhos quentes: carga do catálogo, leitura da resposta da
+// IA, latência de cada verificação e varredura completa. Os catálogos
+// sintéticos repetem as regras Linux do catálogo distribuído, então os números
+// são comparáveis entre execuções na mesma máquina.
+
+// Contagem de alocações: com a glibc, malloc/calloc/realloc deste executável
+// substituem os da biblioteca para todo o processo (inclusive o Qt)
+static std::atomic<quint64> g_allocations(0);
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) __THROW
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) __THROW
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+static const bool ALLOCATIONS_COUNTED = true;
+#else
+static const bool ALLOCATIONS_COUNTED = false;
+#endif
+
+// Memória em uso no heap, incluindo blocos grandes servidos por mmap
+#if defined(__GLIBC__)
+#include <malloc.h>
+static qint64 heapInUse()
+{
+#if __GLIBC_PREREQ(2, 33)
+    const struct mallinfo2 info = mallinfo2();
+#else
+    const struct mallinfo info = mallinfo();
+#endif
+    return qint64(info.uordblks) + qint64(info.hblkhd);
+}
+static const bool HEAP_MEASURED = true;
+#else
+static qint64 heapInUse()
+{
+    return 0;
+}
+static const bool HEAP_MEASURED = false;
+#endif
+
+struct BenchResult {
+    QString name;
+    int iterations;
+    qint64 medianNs;
+    qint64 p99Ns;
+    double allocationsPerIteration;
+};
+
+struct MemoryResult {
+    QString name;
+    int rules;
+    qint64 bytes;
+};
+
+class BenchRunner
+{
+public:
+    BenchRunner(const QString &filter, int iterationsOverride)
+        : m_filter(filter)
+        , m_iterationsOverride(iterationsOverride)
+    {
+    }
+    
+    bool wants(const QString &name) const
+    {
+        return m_filter.isEmpty() || name.contains(m_filter);
+    }
+    
+    void run(const QString &name, int iterations, const std::function<void()> &body)
+    {
+        if (!wants(name)) {
+            return;
+        }
+        if (m_iterationsOverride > 0) {
+            iterations = m_iterationsOverride;
+        }
+        
+        QVector<qint64> samples;
+        samples.reserve(iterations);
+        quint64 allocations = 0;
+        
+        // Uma iteração de aquecimento: caches de arquivos, sessões, plugins do Qt
+        body();
+        
+        for (int i = 0; i < iterations; i++) {
+            const quint64 before = g_allocations.load(std::memory_order_relaxed);
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            samples.append(timer.nsecsElapsed());
+            allocations += g_allocations.load(std::memory_order_relaxed) - before;
+        }
+        
+        std::sort(samples.begin(), samples.end());
+        BenchResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.medianNs = samples.at(samples.size() / 2);
+        result.p99Ns = samples.at(qMin<int>(samples.size() - 1, (samples.size() * 99) / 100));
+        result.allocationsPerIteration = double(allocations) / iterations;
+        m_results.append(result);
+        
+        qDebug().noquote() << name << formatDuration(result.medianNs);
+    }
+    
+    // Memória retida: diferença no heap entre o início do corpo e a chamada de
+    // sample(), que o corpo faz enquanto as estruturas medidas estão vivas
+    void measure(const QString &name, int rules, const std::function<void(const std::function<void()> &)> &body)
+    {
+        if (!wants(name) || !HEAP_MEASURED) {
+            return;
+        }
+        
+        const qint64 before = heapInUse();
+        qint64 retained = 0;
+        body([&retained, before]() {
+            retained = heapInUse() - before;
+        });
+        
+        MemoryResult result;
+        result.name = name;
+        result.rules = rules;
+        result.bytes = retained;
+        m_memory.append(result);
+        
+        qDebug().noquote() << name << retained / qMax(1, rules) << "bytes/regra";
+    }
+    
+    const QVector<BenchResult> &results() const
+    {
+        return m_results;
+    }
+    
+    const QVector<MemoryResult> &memory() const
+    {
+        return m_memory;
+    }
+    
+    static QString formatDuration(qint64 ns)
+    {
+        if (ns < 10000) {
+            return QString("%1 ns").arg(ns);
+        }
+        if (ns < 10000000) {
+            return QString("%1 µs").arg(ns / 1000.0, 0, 'f', 1);
+        }
+        return QString("%1 ms").arg(ns / 1000000.0, 0, 'f', 1);
+    }
+
+private:
+    QString m_filter;
+    int m_iterationsOverride;
+    QVector<BenchResult> m_results;
+    QVector<MemoryResult> m_memory;
+};
+
+// Catálogo com count regras Linux, repetindo as regras de base com ids únicos
+static QByteArray syntheticCatalog(const QJsonArray &baseRules, int count)
+{
+    QJsonArray rules;
+    for (int i = 0; i < count; i++) {
+        QJsonObject rule = baseRules.at(i % baseRules.size()).toObject();
+        if (i >= baseRules.size()) {
+            rule["id"] = QString("%1_%2").arg(rule["id"].toString()).arg(i, 5, 10, QChar('0'));
+        }
+        rule["tags"] = QJsonArray({ QString("grupo-%1").arg(i % 50) });
+        rules.append(rule);
+    }
+    
+    QJsonObject catalog;
+    catalog["linux"] = rules;
+    return QJsonDocument(catalog).toJson(QJsonDocument::Compact);
+}
+
+// Resposta no formato que o modelo costuma devolver: texto, bloco de código e
+// o objeto "vulnerabilities", com regras até atingir minBytes
+static QString syntheticAiResponse(int minBytes)
+{
+    const QString filler = QString("Configuração observada no sistema analisado que aumenta a superfície de ataque. ").repeated(4);
+    
+    QJsonArray vulnerabilities;
+    int size = 0;
+    for (int i = 0; size < minBytes || vulnerabilities.isEmpty(); i++) {
+        QJsonObject vuln;
+        vuln["id"] = QString("AI_RULE_%1").arg(i, 6, 10, QChar('0'));
+        vuln["name"] = QString("Regra sugerida %1").arg(i);
+        vuln["description"] = filler;
+        vuln["impact"] = filler.left(120);
+        vuln["severity"] = (i % 3 == 0) ? "Alta" : (i % 3 == 1) ? "Média" : "Baixa";
+        vuln["fix"] = QString("sed -i 's/^Opcao%1.*/Opcao%1 no/' /etc/exemplo.conf").arg(i);
+        vulnerabilities.append(vuln);
+        size += 2 * filler.size() + 300;
+    }
+    
+    QJsonObject root;
+    root["vulnerabilities"] = vulnerabilities;
+    return "Aqui está a análise de segurança do sistema:\n\n```json\n"
+           + QString::fromUtf8(QJsonDocument(root).toJson(QJsonDocument::Indented))
+           + "```\n\nRevise as correções antes de aplicá-las.";
+}
+
+// Executa as regras com o SystemChecker e espera o fim pelo laço de eventos
+static void runScan(SystemChecker &checker, const QVector<VulnerabilityDefinition> &rules)
+{
+    bool done = false;
+    QEventLoop loop;
+    QObject::connect(&checker, &SystemChecker::allChecksCompleted, &loop, [&done, &loop]() {
+        done = true;
+        loop.quit();
+    });
+    
+    checker.beginScan(rules);
+    checker.checkAll(rules);
+    if (!done) {
+        loop.exec();
+    }
+}
+
+static void printText(const QVector<BenchResult> &results, const QVector<MemoryResult> &memory)
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5")
+               .arg(QString("caso"), -44)
+               .arg(QString("iter"), 6)
+               .arg(QString("mediana"), 12)
+               .arg(QString("p99"), 12)
+               .arg(QString("aloc/iter"), 12)
+        << Qt::endl;
+    for (const BenchResult &result : results) {
+        const QString allocations = ALLOCATIONS_COUNTED
+            ? QString::number(result.allocationsPerIteration, 'f', 0) : QString("-");
+        out << QString("%1 %2 %3 %4 %5")
+                   .arg(result.name, -44)
+                   .arg(result.iterations, 6)
+                   .arg(BenchRunner::formatDuration(result.medianNs), 12)
+                   .arg(BenchRunner::formatDuration(result.p99Ns), 12)
+                   .arg(allocations, 12)
+            << Qt::endl;
+    }
+    
+    if (memory.isEmpty()) {
+        return;
+    }
+    out << Qt::endl
+        << QString("%1 %2 %3 %4")
+               .arg(QString("memória"), -44)
+               .arg(QString("regras"), 6)
+               .arg(QString("bytes"), 12)
+               .arg(QString("bytes/regra"), 12)
+        << Qt::endl;
+    for (const MemoryResult &result : memory) {
+        out << QString("%1 %2 %3 %4")
+                   .arg(result.name, -44)
+                   .arg(result.rules, 6)
+                   .arg(result.bytes, 12)
+                   .arg(result.bytes / qMax(1, result.rules), 12)
+            << Qt::endl;
+    }
+}
+
+static void printJson(const QVector<BenchResult> &results, const QVector<MemoryResult> &memory)
+{
+    QJsonArray entries;
+    for (const BenchResult &result : results) {
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["iterations"] = result.iterations;
+        entry["median_ns"] = result.medianNs;
+        entry["p99_ns"] = result.p99Ns;
+        if (ALLOCATIONS_COUNTED) {
+            entry["allocations"] = result.allocationsPerIteration;
+        }
+        entries.append(entry);
+    }
+    
+    QJsonArray memoryEntries;
+    for (const MemoryResult &result : memory) {
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["rules"] = result.rules;
+        entry["bytes"] = result.bytes;
+        entry["bytes_per_rule"] = double(result.bytes) / qMax(1, result.rules);
+        memoryEntries.append(entry);
+    }
+    
+    QJsonObject root;
+    root["results"] = entries;
+    root["memory"] = memoryEntries;
+    QTextStream out(stdout);
+    out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("SecurityCheckerBench");
+    
+    // Cache de resultados e demais arquivos do usuário ficam fora do lugar real
+    QStandardPaths::setTestModeEnabled(true);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks do SecurityChecker");
+    parser.addHelpOption();
+    QCommandLineOption rulesOption("rules", "Catálogo de base (padrão: vulnerabilities.json ao lado do executável)", "arquivo");
+    QCommandLineOption filterOption("filter", "Executar só os casos cujo nome contém o texto", "texto");
+    QCommandLineOption iterationsOption("iterations", "Iterações de cada caso (padrão: depende do caso)", "n", "0");
+    QCommandLineOption formatOption("format", "Formato da saída: text ou json (padrão: text)", "formato", "text");
+    QCommandLineOption verboseOption("verbose", "Mostrar mensagens de depuração em stderr");
+    parser.addOption(rulesOption);
+    parser.addOption(filterOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(formatOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+    
+    // A depuração do código medido também custa; fica desligada como em produção
+    if (!parser.isSet(verboseOption)) {
+        QLoggingCategory::setFilterRules("*.debug=false");
+    }
+    
+    const QString rulesPath = parser.isSet(rulesOption) ? parser.value(rulesOption)
+                                                        : app.applicationDirPath() + "/vulnerabilities.json";
+    QFile rulesFile(rulesPath);
+    if (!rulesFile.open(QIODevice::ReadOnly)) {
+        qCritical().noquote() << "Não foi possível abrir o catálogo:" << rulesPath;
+        return 1;
+    }
+    const QJsonArray baseRules = QJsonDocument::fromJson(rulesFile.readAll()).object()["linux"].toArray();
+    rulesFile.close();
+    if (baseRules.isEmpty()) {
+        qCritical().noquote() << "Catálogo sem regras Linux:" << rulesPath;
+        return 1;
+    }
+    
+    QTemporaryDir fixtures;
+    if (!fixtures.isValid()) {
+        qCritical() << "Não foi possível criar o diretório temporário";
+        return 1;
+    }
+    
+    BenchRunner runner(parser.value(filterOption), parser.value(iterationsOption).toInt());
+    
+    // Catálogo: leitura do arquivo, parse do JSON e construção das regras
+    const QVector<QPair<int, int>> catalogSizes = { { 30, 200 }, { 1000, 30 }, { 50000, 5 } };
+    for (const auto &size : catalogSizes) {
+        const QString name = QString("catalog/load+linux/%1").arg(size.first);
+        
+        // Os casos de cada tamanho compartilham o arquivo gerado
+        bool wanted = false;
+        for (const char *prefix : { "catalog/load+linux/", "catalog/lookup/", "memory/json/", "memory/catalog/",
+                                    "memory/catalog+scanner/", "memory/catalog+ui/" }) {
+            wanted = wanted || runner.wants(prefix + QString::number(size.first));
+        }
+        if (!wanted) {
+            continue;
+        }
+        const QString path = fixtures.filePath(QString("catalog-%1.json").arg(size.first));
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(syntheticCatalog(baseRules, size.first)) < 0) {
+            qCritical().noquote() << "Não foi possível gravar" << path;
+            return 1;
+        }
+        file.close();
+        
+        runner.run(name, size.second, [&path]() {
+            VulnerabilityManager manager;
+            manager.loadDefinitions(path);
+            const QVector<VulnerabilityDefinition> rules = manager.getDefinitionsForOS("linux");
+            Q_UNUSED(rules);
+        });
+        
+        // Consultas sobre o catálogo já carregado: índice por id, severidade e tag
+        const QString lookupName = QString("catalog/lookup/%1").arg(size.first);
+        if (runner.wants(lookupName)) {
+            VulnerabilityManager manager;
+            manager.loadDefinitions(path);
+            const RuleCatalogPtr catalog = manager.catalog();
+            const QVector<VulnerabilityDefinition> rules = catalog->rules("linux");
+            runner.run(lookupName, 200, [&catalog, &rules]() {
+                int found = 0;
+                for (int i = 0; i < rules.size(); i += qMax(1, rules.size() / 1000)) {
+                    found += catalog->indexOf("linux", rules[i].id) >= 0;
+                }
+                found += catalog->withSeverity("linux", Severity::Alta).size();
+                found += catalog->withTag("linux", "grupo-7").size();
+                Q_UNUSED(found);
+            });
+        }
+        
+        // Memória retida por regra: o JSON interpretado (o que o catálogo guardava
+        // antes), o catálogo compacto e as regras entregues ao scanner e à interface
+        runner.measure(QString("memory/json/%1").arg(size.first), size.first,
+                       [&path](const std::function<void()> &sample) {
+            QFile source(path);
+            source.open(QIODevice::ReadOnly);
+            const QJsonDocument document = QJsonDocument::fromJson(source.readAll());
+            source.close();
+            sample();
+        });
+        runner.measure(QString("memory/catalog/%1").arg(size.first), size.first,
+                       [&path](const std::function<void()> &sample) {
+            VulnerabilityManager manager;
+            manager.loadDefinitions(path);
+            manager.catalog()->ruleCount("linux");
+            sample();
+        });
+        runner.measure(QString("memory/catalog+scanner/%1").arg(size.first), size.first,
+                       [&path](const std::function<void()> &sample) {
+            VulnerabilityManager manager;
+            manager.loadDefinitions(path);
+            const QVector<VulnerabilityDefinition> rules = manager.getDefinitionsForOS("linux", RuleText::Summary);
+            sample();
+        });
+        runner.measure(QString("memory/catalog+ui/%1").arg(size.first), size.first,
+                       [&path](const std::function<void()> &sample) {
+            VulnerabilityManager manager;
+            manager.loadDefinitions(path);
+            const QVector<VulnerabilityDefinition> rules = manager.getDefinitionsForOS("linux", RuleText::Full);
+            sample();
+        });
+    }
+    
+    // Resposta da IA: curta e com vários megabytes
+    const QVector<QPair<int, int>> responseSizes = { { 4 * 1024, 500 }, { 4 * 1024 * 1024, 10 } };
+    for (const auto &size : responseSizes) {
+        const QString name = QString("ai/parse/%1KiB").arg(size.first / 1024);
+        if (!runner.wants(name)) {
+            continue;
+        }
+        const QString response = syntheticAiResponse(size.first);
+        runner.run(name, size.second, [&response]() {
+            const QVector<VulnerabilityDefinition> rules = OllamaClient::parseVulnerabilitiesFromResponse(response);
+            Q_UNUSED(rules);
+        });
+    }
+    
+    // Verificações reais do sistema atual, com o catálogo de base
+    VulnerabilityManager manager;
+    manager.loadDefinitions(rulesPath);
+    const QVector<VulnerabilityDefinition> systemRules = manager.getDefinitionsForOS(manager.getCurrentOS());
+    
+    // Latência de cada regra: coleta dos fatos e avaliação (ou o comando "shell")
+    SystemChecker checker;
+    checker.setIncremental(false);
+    for (const VulnerabilityDefinition &rule : systemRules) {
+        const QString name = QString("check/%1").arg(rule.id);
+        if (!runner.wants(name)) {
+            continue;
+        }
+        const QVector<VulnerabilityDefinition> single = { rule };
+        runner.run(name, 20, [&checker, &single]() {
+            runScan(checker, single);
+        });
+    }
+    
+    // Varredura completa como em uma execução do cron: verificador novo, sem cache
+    runner.run("scan/full", 5, [&systemRules]() {
+        SystemChecker fresh;
+        fresh.setIncremental(false);
+        runScan(fresh, systemRules);
+    });
+    
+    if (parser.value(formatOption) == "json") {
+        printJson(runner.results(), runner.memory());
+    } else {
+        printText(runner.results(), runner.memory());
+    }
+    return 0;
+}
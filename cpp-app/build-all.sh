@@ -73,6 +73,7 @@ RUN mkdir -p build-linux && cd build-linux && \
 # Criar pacote
 RUN mkdir -p /output && \
     cp build-linux/SecurityChecker /output/ && \
+    cp build-linux/SecurityCheckerScan /output/ && \
     cp data/vulnerabilities.json /output/ && \
     cp README.md /output/
 
@@ -0,0 +1,252 @@
+#!/bin/bash
+
+# Gera árvores de rootfs sintéticas com uma mistura de estados vulneráveis do
+# catálogo Linux, para testar o SecurityCheckerScan --root em escala sem tocar
+# no sistema real. O resultado esperado de cada regra fica em manifest.json.
+#
+# Uso:
+#   ./generate_rootfs_fixtures.sh [-n raízes] [-o diretório] [-p porcentagem]
+#                                 [-f arquivos] [-s semente] [-v estados]
+#   ./generate_rootfs_fixtures.sh --verify manifest.json relatorio.json
+#
+#   -n  número de raízes (padrão: 10)
+#   -o  diretório de saída (padrão: ./rootfs-fixtures)
+#   -p  chance, em %, de cada estado vulnerável em cada raiz (padrão: 50)
+#   -f  arquivos de enchimento por raiz em /usr/share/fixture (padrão: 1000)
+#   -s  semente; a mesma semente gera as mesmas raízes (padrão: 1)
+#   -v  estados sorteados, separados por vírgula (padrão: todos)
+#
+# Estados: ssh_root, ssh_port, sudo_nopasswd, shadow_mode, no_firewall,
+# ufw_disabled, no_fail2ban, no_apparmor, old_kernel, no_unattended
+#
+# Regras que dependem do sistema em execução (serviços) não são avaliadas
+# offline e ficam como not_applicable no manifesto.
+
+set -e
+
+ALL_STATES="ssh_root,ssh_port,sudo_nopasswd,shadow_mode,no_firewall,ufw_disabled,no_fail2ban,no_apparmor,old_kernel,no_unattended"
+
+# Confere um relatório do SecurityCheckerScan --root contra o manifesto
+verify() {
+    local manifest="$1"
+    local report="$2"
+
+    if ! command -v jq >/dev/null 2>&1; then
+        echo "❌ jq é necessário para --verify" >&2
+        exit 2
+    fi
+
+    local mismatches
+    mismatches=$(jq -rn --slurpfile m "$manifest" --slurpfile r "$report" '
+        ($r[0].roots
+            | map({key: .root, value: (.results | map({key: .id, value: .status}) | from_entries)})
+            | from_entries) as $got
+        | $m[0].roots[]
+        | .root as $root
+        | .expected | to_entries[]
+        | select($got[$root][.key] != .value)
+        | "\($root)\t\(.key)\tesperado \(.value), obtido \($got[$root][.key] // "ausente")"')
+
+    local total
+    total=$(jq '[.roots[].expected | length] | add // 0' "$manifest")
+
+    if [[ -n "$mismatches" ]]; then
+        echo "$mismatches"
+        echo "❌ $(echo "$mismatches" | wc -l) de $total veredictos divergentes" >&2
+        exit 1
+    fi
+    echo "✅ $total veredictos conferem"
+}
+
+if [[ "$1" == "--verify" ]]; then
+    if [[ $# -ne 3 ]]; then
+        echo "Uso: $0 --verify manifest.json relatorio.json" >&2
+        exit 2
+    fi
+    verify "$2" "$3"
+    exit 0
+fi
+
+COUNT=10
+OUTPUT="./rootfs-fixtures"
+PERCENT=50
+FILLER=1000
+SEED=1
+STATES="$ALL_STATES"
+
+while getopts "n:o:p:f:s:v:" opt; do
+    case "$opt" in
+        n) COUNT="$OPTARG" ;;
+        o) OUTPUT="$OPTARG" ;;
+        p) PERCENT="$OPTARG" ;;
+        f) FILLER="$OPTARG" ;;
+        s) SEED="$OPTARG" ;;
+        v) STATES="$OPTARG" ;;
+        *) exit 2 ;;
+    esac
+done
+
+for state in ${STATES//,/ }; do
+    if [[ ",$ALL_STATES," != *",$state,"* ]]; then
+        echo "❌ Estado desconhecido: $state" >&2
+        exit 2
+    fi
+done
+
+mkdir -p "$OUTPUT"
+OUTPUT="$(cd "$OUTPUT" && pwd)"
+RANDOM=$SEED
+
+# Sorteia um estado para a raiz atual; estados fora de -v ficam seguros
+roll() {
+    local roll=$((RANDOM % 100))
+    [[ ",$STATES," == *",$1,"* ]] && (( roll < PERCENT ))
+}
+
+# Executável vazio, suficiente para binary_exists
+stub() {
+    mkdir -p "$(dirname "$1")"
+    printf '#!/bin/sh\nexit 0\n' > "$1"
+    chmod 755 "$1"
+}
+
+# Veredicto de uma regra nativa a partir do estado sorteado ("on" de generate_root)
+v() {
+    [[ -n "${on[$1]}" ]] && echo vulnerable || echo safe
+}
+
+package_stanza() {
+    printf 'Package: %s\nStatus: install ok installed\nArchitecture: %s\nVersion: %s\n\n' "$1" "$2" "$3"
+}
+
+generate_root() {
+    local root="$1"
+    local -a active=()
+    local state
+
+    # Sorteio em ordem fixa, para a semente reproduzir as mesmas raízes
+    declare -A on=()
+    for state in ${ALL_STATES//,/ }; do
+        if roll "$state"; then
+            on[$state]=1
+            active+=("$state")
+        fi
+    done
+
+    rm -rf "$root"
+    mkdir -p "$root"/etc/ssh "$root"/etc/sudoers.d "$root"/etc/ufw \
+             "$root"/usr/bin "$root"/usr/sbin "$root"/var/lib/dpkg "$root"/var/lib/apt/lists
+
+    # Base de um Debian mínimo
+    ln -s usr/bin "$root/bin"
+    ln -s usr/sbin "$root/sbin"
+    echo "root:x:0:0:root:/root:/bin/bash" > "$root/etc/passwd"
+    echo "root:*:19700:0:99999:7:::" > "$root/etc/shadow"
+    echo "root:x:0:" > "$root/etc/group"
+    echo "root:*::" > "$root/etc/gshadow"
+    chmod 644 "$root/etc/passwd" "$root/etc/group"
+    chmod 600 "$root/etc/shadow" "$root/etc/gshadow"
+    printf 'Defaults\tenv_reset\nroot\tALL=(ALL:ALL) ALL\n@includedir /etc/sudoers.d\n' > "$root/etc/sudoers"
+    echo "%sudo ALL=(ALL:ALL) ALL" > "$root/etc/sudoers.d/10-admins"
+
+    {
+        echo "Include /etc/ssh/sshd_config.d/*.conf"
+        [[ -n "${on[ssh_port]}" ]] && echo "Port 22" || echo "Port 2222"
+        [[ -n "${on[ssh_root]}" ]] && echo "PermitRootLogin yes" || echo "PermitRootLogin no"
+        echo "PasswordAuthentication no"
+    } > "$root/etc/ssh/sshd_config"
+
+    if [[ -n "${on[sudo_nopasswd]}" ]]; then
+        echo "deploy ALL=(ALL) NOPASSWD: ALL" > "$root/etc/sudoers.d/90-deploy"
+    fi
+    if [[ -n "${on[shadow_mode]}" ]]; then
+        chmod 644 "$root/etc/shadow"
+    fi
+    if [[ -z "${on[no_firewall]}" ]]; then
+        stub "$root/usr/sbin/ufw"
+        [[ -n "${on[ufw_disabled]}" ]] && echo "ENABLED=no" > "$root/etc/ufw/ufw.conf" \
+                                       || echo "ENABLED=yes" > "$root/etc/ufw/ufw.conf"
+    fi
+    if [[ -z "${on[no_fail2ban]}" ]]; then
+        stub "$root/usr/bin/fail2ban-server"
+    fi
+    if [[ -z "${on[no_apparmor]}" ]]; then
+        stub "$root/usr/sbin/apparmor_status"
+    fi
+
+    # Banco do dpkg e lista do apt: o candidato mais novo torna o kernel antigo
+    {
+        package_stanza base-files amd64 12.4
+        package_stanza linux-image-6.1.0-18-amd64 amd64 6.1.76-1
+        if [[ -z "${on[no_unattended]}" ]]; then
+            package_stanza unattended-upgrades all 2.9.1
+        fi
+        if [[ -z "${on[no_fail2ban]}" ]]; then
+            package_stanza fail2ban all 1.0.2-2
+        fi
+    } > "$root/var/lib/dpkg/status"
+    {
+        printf 'Package: linux-image-6.1.0-18-amd64\nArchitecture: amd64\n'
+        [[ -n "${on[old_kernel]}" ]] && printf 'Version: 6.1.90-1\n\n' || printf 'Version: 6.1.76-1\n\n'
+    } > "$root/var/lib/apt/lists/deb.debian.org_debian_dists_bookworm_main_binary-amd64_Packages"
+
+    # Enchimento: mil arquivos por diretório
+    local dir i
+    for ((i = 0; i < FILLER; i += 1000)); do
+        dir="$root/usr/share/fixture/d$(printf '%04d' $((i / 1000)))"
+        mkdir -p "$dir"
+        (cd "$dir" && seq -f "f%05g" "$i" "$(( (i + 999 < FILLER - 1) ? i + 999 : FILLER - 1 ))" | xargs touch)
+    done
+
+    # Veredictos esperados, no vocabulário do relatório do SecurityCheckerScan
+    local ufw_inactive
+    ufw_inactive=$([[ -n "${on[no_firewall]}" ]] && echo not_applicable || v ufw_disabled)
+
+    local states_json=""
+    if [[ ${#active[@]} -gt 0 ]]; then
+        states_json=$(printf '"%s",' "${active[@]}")
+    fi
+    cat <<EOF
+    {
+      "root": "$root",
+      "states": [${states_json%,}],
+      "expected": {
+        "SSH_ROOT_LOGIN": "$(v ssh_root)",
+        "NO_FIREWALL": "$(v no_firewall)",
+        "UFW_INACTIVE": "$ufw_inactive",
+        "SSH_DEFAULT_PORT": "$(v ssh_port)",
+        "FAIL2BAN_NOT_INSTALLED": "$(v no_fail2ban)",
+        "FAIL2BAN_INACTIVE": "not_applicable",
+        "UNATTENDED_UPGRADES_OFF": "not_applicable",
+        "APPARMOR_NOT_INSTALLED": "$(v no_apparmor)",
+        "APPARMOR_INACTIVE": "not_applicable",
+        "SUDO_NOPASSWD": "$(v sudo_nopasswd)",
+        "WEAK_FILE_PERMS": "$(v shadow_mode)",
+        "OLD_KERNEL": "$(v old_kernel)"
+      }
+    }
+EOF
+}
+
+echo "🧪 Gerando $COUNT raízes em $OUTPUT (semente $SEED, $PERCENT% de chance por estado)" >&2
+
+MANIFEST="$OUTPUT/manifest.json"
+{
+    echo "{"
+    echo "  \"seed\": $SEED,"
+    echo "  \"percent\": $PERCENT,"
+    echo "  \"filler\": $FILLER,"
+    echo "  \"roots\": ["
+    for ((n = 0; n < COUNT; n++)); do
+        generate_root "$OUTPUT/root-$(printf '%05d' "$n")"
+        (( n < COUNT - 1 )) && echo "    ,"
+    done
+    echo "  ]"
+    echo "}"
+} > "$MANIFEST"
+
+echo "✅ Manifesto: $MANIFEST" >&2
+echo "" >&2
+echo "Para conferir:" >&2
+echo "   ./SecurityCheckerScan \$(printf -- '--root %s ' $OUTPUT/root-*) > report.json" >&2
+echo "   $0 --verify $MANIFEST report.json" >&2
@@ -0,0 +1,34 @@
+#ifndef APPLICABILITY_H
+#define APPLICABILITY_H
+
+#include <QString>
+#include <QStringList>
+#include <QSharedPointer>
+#include <QJsonValue>
+
+struct PlatformFingerprint;
+
+// Condições do campo "applies_to" de uma regra. São avaliadas uma vez por
+// varredura contra a PlatformFingerprint; regras fora delas ficam como "não
+// aplicável" sem coletar fatos nem executar nada.
+// Todas as condições presentes precisam valer. Um dado que a plataforma não
+// informa (sem os-release, por exemplo) não exclui a regra.
+struct Applicability {
+    QStringList distros;          // ID ou um dos ID_LIKE do os-release
+    QString minVersion;           // VERSION_ID, inclusive, na ordem do dpkg
+    QString maxVersion;
+    QStringList packageManagers;
+    QStringList initSystems;
+    int container;                // -1 indiferente, 0 só fora, 1 só dentro de contêiner
+    QStringList binaries;         // todos presentes no PATH (ou na raiz)
+    
+    Applicability() : container(-1) {}
+    
+    // Nulo com error preenchido se o valor for inválido
+    static QSharedPointer<const Applicability> fromJson(const QJsonValue &value, QString *error);
+    
+    // root vazio = sistema atual. reason recebe a primeira condição que falhou
+    bool matches(const PlatformFingerprint &platform, const QString &root, QString *reason = nullptr) const;
+};
+
+#endif // APPLICABILITY_H
@@ -0,0 +1,76 @@
+#ifndef CHECKEXPRESSION_H
+#define CHECKEXPRESSION_H
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QJsonValue>
+#include <QRegularExpression>
+#include "SystemFacts.h"
+
+// Regra de verificação declarada no campo "check" do vulnerabilities.json.
+// Primitivas tipadas são avaliadas em C++ sobre a fotografia de fatos e podem
+// ser combinadas com "all", "any" e "not". O resultado verdadeiro indica
+// vulnerabilidade. {"type": "shell"} continua disponível, mas só no topo.
+class CheckExpression
+{
+public:
+    enum class Type {
+        All,
+        Any,
+        Not,
+        FileExists,
+        FileMatches,
+        FileMode,
+        BinaryExists,
+        ServiceActive,
+        ServiceEnabled,
+        PackageInstalled,
+        PackageUpgradable,
+        PackageVersion,
+        PortListening,
+        Sysctl,
+        Shell
+    };
+    
+    // Retorna nulo e preenche error se a expressão for inválida
+    static QSharedPointer<const CheckExpression> fromJson(const QJsonValue &value, QString *error);
+    
+    Type type() const;
+    bool isShell() const;
+    QString shellCommand() const;
+    
+    FactRequirements requirements() const;
+    bool evaluate(const SystemFacts &facts) const;
+    // Fatos observados pelas primitivas, uma linha por fato (ex.: a linha do
+    // arquivo que casou, o estado do serviço, a versão do pacote)
+    QString evidence(const SystemFacts &facts) const;
+
+private:
+    // Ocorrências de file_matches comparadas com "capture"
+    enum class Match {
+        Any,      // alguma
+        First,    // só a primeira
+        All       // todas (e ao menos uma)
+    };
+    
+    CheckExpression();
+    
+    static QSharedPointer<CheckExpression> parse(const QJsonValue &value, QString *error);
+    void collectRequirements(FactRequirements &req) const;
+    void collectEvidence(const SystemFacts &facts, QStringList &lines) const;
+    
+    Type m_type;
+    QVector<QSharedPointer<const CheckExpression>> m_children;
+    QString m_path;           // arquivo, diretório, binário, serviço, pacote, chave sysctl ou porta
+    bool m_isDirectory;
+    bool m_exposedOnly;
+    quint16 m_port;
+    QRegularExpression m_pattern;
+    Match m_match;
+    int m_mode;
+    int m_modeMask;           // bits de m_mode comparados; 07777 = permissões exatas
+    QString m_value;          // shell, valor do sysctl, protocolo, versão limite ou grupo capturado
+};
+
+#endif // CHECKEXPRESSION_H
@@ -0,0 +1,116 @@
+#ifndef HEADLESSSCANNER_H
+#define HEADLESSSCANNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "VulnerabilityDefinition.h"
+#include "VulnerabilityManager.h"
+#include "SystemChecker.h"
+#include "RuleWatcher.h"
+#include "OfflineScanner.h"
+#include "MetricsExporter.h"
+
+// Varredura completa sem interface: carrega o catálogo do sistema atual,
+// verifica todas as regras, imprime o resultado e encerra a aplicação com um
+// código de saída que reflete a maior severidade encontrada.
+// No modo de observação o processo não termina: depois do relatório inicial,
+// regras são reavaliadas quando suas entradas mudam e cada mudança de estado
+// vira uma linha na saída. O catálogo também é observado: um arquivo novo e
+// válido substitui as regras assim que a reavaliação em andamento termina.
+// Com raízes alternativas (--root) a varredura é offline: sistemas de arquivos
+// montados são avaliados em paralelo pelo OfflineScanner, um relatório por raiz.
+class HeadlessScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class OutputFormat {
+        Json,
+        Text
+    };
+    
+    // Códigos de saída do processo
+    enum ExitCode {
+        ExitClean = 0,        // nenhuma vulnerabilidade
+        ExitLow = 1,          // maior severidade encontrada: baixa
+        ExitMedium = 2,
+        ExitHigh = 3,
+        ExitError = 4         // catálogo não carregou, nenhuma regra para o sistema ou
+                              // alguma regra terminou sem resultado (tempo esgotado, pendente)
+    };
+    
+    explicit HeadlessScanner(QObject *parent = nullptr);
+    
+    void setRulesPath(const QString &path);
+    void setOutputFormat(OutputFormat format);
+    void setFullScan(bool fullScan);
+    // intervalSeconds: reavaliação periódica das regras que o inotify não cobre
+    void setWatchMode(bool enabled, int intervalSeconds = DEFAULT_WATCH_INTERVAL_S);
+    void setRoots(const QStringList &roots);
+    // Raízes avaliadas ao mesmo tempo; 0 = uma por núcleo
+    void setJobs(int jobs);
+    // Arquivo .prom regravado ao fim de cada varredura ou reavaliação
+    void setMetricsPath(const QString &path);
+    
+    static const int DEFAULT_WATCH_INTERVAL_S;
+    
+    // Inicia a varredura; ao terminar, chama QCoreApplication::exit()
+    void start();
+    int exitCode() const;
+
+private slots:
+    void onCheckCompleted(const QString &id, bool isVulnerable, const QString &evidence);
+    void onCheckTimedOut(const QString &id, const QString &evidence);
+    void onCheckNotApplicable(const QString &id);
+    void onAllChecksCompleted();
+    void onErrorOccurred(const QString &error);
+    void onRulesChanged(const QStringList &ids);
+    void onPollTimeout();
+    void onDefinitionsReloaded();
+
+private:
+    VulnerabilityManager *m_vulnerabilityManager;
+    SystemChecker *m_systemChecker;
+    QString m_rulesPath;
+    OutputFormat m_format;
+    QString m_currentOS;
+    RuleCatalogPtr m_catalog;                 // de onde vieram m_rules; índices valem para ele
+    QVector<VulnerabilityDefinition> m_rules;
+    QHash<QString, CheckResult> m_results;
+    int m_exitCode;
+    bool m_watch;
+    bool m_initialScanDone;
+    bool m_reloadPending;
+    RuleWatcher *m_watcher;
+    QTimer *m_pollTimer;
+    QStringList m_roots;
+    int m_jobs;
+    QString m_metricsPath;
+    MetricsExporter m_metrics;
+    QElapsedTimer m_scanTimer;
+    
+    void updateResult(const QString &id, CheckStatus status, const QString &evidence);
+    void startWatching();
+    void applyCatalog();
+    void scanRoots();
+    void writeMetrics();
+    void printReport() const;
+    void printTransition(const VulnerabilityDefinition &rule, CheckStatus from, const CheckResult &result) const;
+    void finish(int exitCode);
+    void printJson() const;
+    void printText() const;
+    void printRootsJson(const QVector<RootScanResult> &scans, const QVector<int> &exitCodes) const;
+    void printRootsText(const QVector<RootScanResult> &scans) const;
+    QJsonArray resultsJson(const QHash<QString, CheckResult> &results, QJsonObject *summary) const;
+    int severityExitCode(const QHash<QString, CheckResult> &results) const;
+    
+    static QString statusName(CheckStatus status);
+    static QString severityName(Severity severity);
+};
+
+#endif // HEADLESSSCANNER_H
@@ -16,6 +16,9 @@ class MainWindow : public QMainWindow
 public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+    
+    void setFullScan(bool fullScan);
+    void setMetricsPath(const QString &path);
 
 private slots:
     void showLandingPage();
@@ -0,0 +1,68 @@
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include "VulnerabilityDefinition.h"
+
+struct ScanCounters;
+struct OllamaUsage;
+
+// Métricas da varredura no formato texto do Prometheus, para o coletor
+// "textfile" do node_exporter. Histogramas acumulam enquanto o objeto existe:
+// no modo de observação cada reavaliação soma observações; numa execução
+// única cada regra contribui com uma.
+class MetricsExporter
+{
+public:
+    MetricsExporter();
+    
+    // Regras conhecidas; os resultados de regras fora da lista são ignorados
+    void setRules(const QVector<VulnerabilityDefinition> &rules);
+    void setResult(const QString &id, CheckStatus status);
+    void observeRuleDuration(const QString &id, double seconds);
+    void observeScanDuration(double seconds);
+    void setCounters(const ScanCounters &counters);
+    void observeOllamaRequest(const OllamaUsage &usage);
+    
+    QByteArray render() const;
+    // Escrita atômica (arquivo temporário + rename no mesmo diretório), como
+    // o coletor textfile exige; o arquivo deve terminar em .prom
+    bool write(const QString &path) const;
+
+private:
+    struct Histogram {
+        QVector<quint64> buckets;   // contagem acumulada por limite
+        quint64 count;
+        double sum;
+        
+        Histogram();
+        void observe(double value, const QVector<double> &bounds);
+    };
+    
+    struct RuleState {
+        Severity severity;
+        CheckStatus status;
+        Histogram duration;
+    };
+    
+    QStringList m_order;                 // ordem do catálogo, para uma saída estável
+    QHash<QString, RuleState> m_rules;
+    Histogram m_scanDuration;
+    Histogram m_ollamaDuration;
+    quint64 m_commands;
+    quint64 m_timeouts;
+    quint64 m_failures;
+    quint64 m_ollamaRequests;
+    quint64 m_promptTokens;
+    quint64 m_responseTokens;
+    qint64 m_lastScanTimestamp;
+    
+    static QString statusName(CheckStatus status);
+    static QString severityName(Severity severity);
+};
+
+#endif // METRICSEXPORTER_H
@@ -0,0 +1,49 @@
+#ifndef NETWORKEXPOSURE_H
+#define NETWORKEXPOSURE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+struct ListeningSocket {
+    QString protocol;         // tcp, tcp6, udp, udp6
+    QString address;
+    quint16 port;
+    quint64 inode;
+    qint64 pid;               // 0 se nenhum processo visível possui o socket
+    QString process;          // /proc/<pid>/comm
+    QString executable;       // /proc/<pid>/exe
+    QString unit;             // unidade systemd, pelo cgroup do processo
+    
+    ListeningSocket() : port(0), inode(0), pid(0) {}
+    
+    bool isLoopback() const;
+    QString toString() const;
+};
+
+// Sockets TCP/UDP em escuta, obtidos pelo netlink sock_diag (ou /proc/net/*
+// quando o netlink não está disponível) e atribuídos ao processo dono com uma
+// única passada por /proc/*/fd. Só faz algo no Linux.
+class NetworkExposure
+{
+public:
+    NetworkExposure();
+    
+    bool collect();
+    void clear();
+    bool isLoaded() const;
+    
+    QVector<ListeningSocket> sockets() const;
+    // protocol vazio = tcp ou udp; exposedOnly ignora endereços de loopback
+    bool isListening(quint16 port, const QString &protocol = QString(), bool exposedOnly = false) const;
+
+private:
+    QVector<ListeningSocket> m_sockets;
+    bool m_loaded;
+    
+    bool collectNetlink();
+    void collectProcNet();
+    void attributeProcesses();
+};
+
+#endif // NETWORKEXPOSURE_H
@@ -0,0 +1,43 @@
+#ifndef OFFLINESCANNER_H
+#define OFFLINESCANNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include "VulnerabilityDefinition.h"
+#include "PlatformFingerprint.h"
+
+struct RootScanResult {
+    QString root;
+    PlatformFingerprint platform;          // usada para o "applies_to" das regras
+    QHash<QString, CheckResult> results;   // id -> resultado
+};
+
+// Varre sistemas de arquivos montados (imagens de contêiner, chroots, discos de
+// VMs) sem executar nada dentro deles: só as primitivas nativas são avaliadas,
+// com caminhos resolvidos dentro de cada raiz. Regras "shell", sem verificação
+// ou que dependem do sistema em execução (serviços, sockets, /proc) ficam como
+// não aplicáveis, assim como as que o "applies_to" exclui da distribuição da
+// raiz. Cada raiz é independente e roda em uma thread do pool.
+class OfflineScanner
+{
+public:
+    explicit OfflineScanner(const QVector<VulnerabilityDefinition> &rules);
+    
+    // 0 = QThread::idealThreadCount()
+    void setMaxThreads(int count);
+    int maxThreads() const;
+    
+    // Bloqueia até todas as raízes terminarem; resultados na ordem de roots
+    QVector<RootScanResult> scan(const QStringList &roots) const;
+    RootScanResult scanRoot(const QString &root) const;
+    
+    static bool isOfflineCapable(const VulnerabilityDefinition &rule);
+
+private:
+    QVector<VulnerabilityDefinition> m_rules;
+    int m_maxThreads;
+};
+
+#endif // OFFLINESCANNER_H
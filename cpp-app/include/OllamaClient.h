@@ -10,6 +10,7 @@
 #include <QTimer>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QElapsedTimer>
 #include "VulnerabilityDefinition.h"
 
 struct OllamaModel {
@@ -19,6 +20,15 @@ struct OllamaModel {
     QString digest;
 };
 
+// Custo de uma análise: latência medida aqui, tokens informados pelo servidor
+struct OllamaUsage {
+    double seconds;
+    qint64 promptTokens;
+    qint64 responseTokens;
+    
+    OllamaUsage() : seconds(0), promptTokens(0), responseTokens(0) {}
+};
+
 struct SystemInfo {
     QString osType;
     QString osVersion;
@@ -47,6 +57,9 @@ public:
     // Verificar conectividade
     void testConnection();
     
+    // Extrai as regras do JSON devolvido pelo modelo (aceita texto ao redor)
+    static QVector<VulnerabilityDefinition> parseVulnerabilitiesFromResponse(const QString &response);
+    
     // Constantes
     static const QString OLLAMA_ENDPOINT;
 
@@ -55,6 +68,8 @@ signals:
     void vulnerabilitiesReceived(const QVector<VulnerabilityDefinition> &vulnerabilities);
     void errorOccurred(const QString &error);
     void connectionTestResult(bool success, const QString &message);
+    // Emitido quando a resposta de uma análise chega, com ou sem sucesso
+    void usageReported(const OllamaUsage &usage);
 
 private slots:
     void onModelsReplyFinished();
@@ -67,9 +82,11 @@ private:
     QNetworkAccessManager *m_networkManager;
     QTimer *m_timeoutTimer;
     QNetworkReply *m_currentReply;
+    QString m_requestModel;
+    QElapsedTimer m_requestTimer;
+    qint64 m_requestStartUs;    // TraceRecorder::now() ao enviar a análise
     
     QString buildSystemAnalysisPrompt(const SystemInfo &systemInfo) const;
-    QVector<VulnerabilityDefinition> parseVulnerabilitiesFromResponse(const QString &response) const;
     void handleNetworkReply(QNetworkReply *reply);
     void cleanup();
 };
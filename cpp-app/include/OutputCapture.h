@@ -0,0 +1,42 @@
+#ifndef OUTPUTCAPTURE_H
+#define OUTPUTCAPTURE_H
+
+#include <QString>
+#include <QByteArray>
+
+// Saída de um comando com memória limitada: guarda os primeiros headBytes e
+// os últimos tailBytes (em um buffer circular de tamanho fixo) e só conta o
+// que ficou no meio. O início costuma explicar o que o comando fez e o final
+// por que ele terminou; um "apt upgrade" tagarela não faz a memória crescer.
+class OutputCapture
+{
+public:
+    explicit OutputCapture(int headBytes = DEFAULT_HEAD_BYTES, int tailBytes = DEFAULT_TAIL_BYTES);
+    
+    // Descarta o conteúdo atual
+    void setLimits(int headBytes, int tailBytes);
+    void append(const QByteArray &data);
+    void clear();
+    
+    qint64 totalBytes() const;
+    qint64 droppedBytes() const;
+    bool isEmpty() const;
+    bool isTruncated() const;
+    
+    // Início e final da saída, com um aviso no lugar dos bytes descartados
+    QString text() const;
+    
+    static const int DEFAULT_HEAD_BYTES;
+    static const int DEFAULT_TAIL_BYTES;
+
+private:
+    QByteArray m_head;
+    QByteArray m_tail;        // alocado uma vez com m_tailLimit bytes
+    int m_headLimit;
+    int m_tailLimit;
+    int m_tailStart;          // posição do byte mais antigo do final
+    int m_tailSize;
+    qint64 m_total;
+};
+
+#endif // OUTPUTCAPTURE_H
@@ -0,0 +1,85 @@
+#ifndef PACKAGEINVENTORY_H
+#define PACKAGEINVENTORY_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+struct PackageRecord {
+    QString name;
+    QString version;
+    QString architecture;
+    QString source;           // pacote fonte (dpkg), SRPM (rpm) ou origin (apk)
+};
+
+// Inventário de pacotes lido direto dos bancos do gerenciador, sem executar
+// apt, dpkg, rpm ou apk. O status do dpkg é mapeado em memória e percorrido
+// uma única vez; rpm usa o banco sqlite e apk o arquivo "installed". Bancos
+// rpm antigos (Berkeley DB, ndb) não têm leitor próprio: ficam com "rpm -qa".
+// Um pacote pode ter várias instâncias: uma por arquitetura (multiarch) e,
+// no rpm, uma por versão instalada (kernels).
+class PackageInventory
+{
+public:
+    enum class Backend {
+        None,
+        Dpkg,
+        Rpm,
+        Apk
+    };
+    
+    PackageInventory();
+    
+    // Gerenciador de pacotes do sistema, pela presença do banco
+    static Backend detectBackend(const QString &root = QString());
+    
+    // Raiz alternativa (imagem montada, chroot) onde ficam os bancos; vazia = "/"
+    void setRoot(const QString &root);
+    
+    // Detecta o gerenciador do sistema e carrega os pacotes instalados
+    bool load();
+    void clear();
+    bool isLoaded() const;
+    Backend backend() const;
+    
+    bool contains(const QString &name) const;
+    // Instância de versão mais alta, de qualquer arquitetura
+    PackageRecord package(const QString &name) const;
+    // Todas as instâncias instaladas do pacote
+    QVector<PackageRecord> instances(const QString &name) const;
+    QVector<PackageRecord> packages() const;
+    int size() const;         // instâncias
+    
+    // Versões candidatas nas listas do apt (apt update), por nome e arquitetura
+    // e só de pacotes instalados. A escolha segue as prioridades do apt: 500
+    // por padrão, 1 ou 100 para repositórios NotAutomatic (experimental,
+    // backports) e os Pin-Priority de /etc/apt/preferences. Listas comprimidas
+    // são lidas com o apt-helper.
+    bool loadAptCandidates();
+    // Pacotes instalados cujo nome casa com o padrão e têm versão mais nova disponível
+    QStringList upgradable(const QString &namePattern) const;
+    
+    // Comparação de versões no formato do Debian (época, upstream, revisão, ~)
+    static int compareDebianVersions(const QString &a, const QString &b);
+    
+    // Arquivos cuja identidade muda quando pacotes são instalados ou atualizados
+    static QStringList databaseFiles();
+    static QStringList aptListFiles(const QString &root = QString());
+    static QStringList aptPreferenceFiles(const QString &root = QString());
+    static QString aptListsDirectory();
+
+private:
+    QHash<QString, QVector<PackageRecord>> m_packages;   // nome -> instâncias
+    QHash<QString, QString> m_candidates;                // "nome:arquitetura" -> versão
+    Backend m_backend;
+    QString m_root;
+    
+    void insert(const PackageRecord &record);
+    bool loadDpkg(const QString &path);
+    bool loadRpm(const QString &path);
+    bool loadRpmCommand();
+    bool loadApk(const QString &path);
+};
+
+#endif // PACKAGEINVENTORY_H
@@ -0,0 +1,31 @@
+#ifndef PLATFORMFINGERPRINT_H
+#define PLATFORMFINGERPRINT_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+
+// Identificação da plataforma sem criar processos: uname(2), os-release e
+// /proc. current() é calculado uma vez por processo; detect() com uma raiz
+// montada só olha os arquivos dela (kernel, contêiner e virtualização ficam
+// vazios). É a chave das regras específicas de distribuição.
+struct PlatformFingerprint {
+    QString family;            // chave do catálogo: "linux", "windows", "macos" ou "unknown"
+    QString distroId;          // ID do os-release: debian, ubuntu, rhel, alpine...
+    QStringList distroLike;    // ID_LIKE
+    QString versionId;         // VERSION_ID
+    QString prettyName;
+    QString kernelRelease;
+    QString architecture;
+    QString initSystem;        // systemd, openrc, runit, sysvinit, launchd, scm; vazio se desconhecido
+    QString container;         // docker, podman, lxc, kubernetes, wsl...; vazio fora de contêiner
+    QString virtualization;    // kvm, vmware, virtualbox, hyper-v, xen, vm; vazio em máquina física
+    QString packageManager;    // apt, dnf, yum, zypper, apk, pacman; vazio se nenhum
+    
+    static const PlatformFingerprint &current();
+    static PlatformFingerprint detect(const QString &root = QString());
+    
+    QJsonObject toJson() const;
+};
+
+#endif // PLATFORMFINGERPRINT_H
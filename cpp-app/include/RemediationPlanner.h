@@ -0,0 +1,52 @@
+#ifndef REMEDIATIONPLANNER_H
+#define REMEDIATIONPLANNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "VulnerabilityDefinition.h"
+#include "PackageInventory.h"
+
+struct RemediationStep {
+    QString description;
+    QString command;
+    QStringList ruleIds;      // regras que dependem do sucesso deste passo
+    int timeoutMs;            // 0 = limite padrão
+    bool requiresRules;       // não roda se um passo anterior de alguma das regras falhou
+    
+    RemediationStep() : timeoutMs(0), requiresRules(false) {}
+};
+
+// Fases executadas em ordem; os passos de uma mesma fase não conflitam entre si
+// e podem rodar em paralelo
+struct RemediationPlan {
+    QVector<QVector<RemediationStep>> phases;
+    QStringList ruleIds;
+    
+    bool isEmpty() const;
+    int stepCount() const;
+    QString toScript() const;
+};
+
+// Junta as correções selecionadas em um único plano:
+//   1. uma atualização de índice e uma transação de pacotes para todas as regras
+//   2. edições agrupadas por arquivo (arquivos diferentes em paralelo), um
+//      passo por regra: no mesmo arquivo as regras editam uma por fase
+//   3. comandos avulsos, um passo por regra e uma regra por vez: a falha de
+//      uma não impede as outras nem as marca como falhas
+//   4. uma validação e um reinício por serviço afetado, só se os passos
+//      anteriores das regras dele tiveram sucesso
+class RemediationPlanner
+{
+public:
+    explicit RemediationPlanner(PackageInventory::Backend backend = PackageInventory::detectBackend());
+    
+    RemediationPlan plan(const QVector<VulnerabilityDefinition> &rules) const;
+
+private:
+    PackageInventory::Backend m_backend;
+    
+    QString packageTransaction(const QStringList &packages, bool upgrade) const;
+};
+
+#endif // REMEDIATIONPLANNER_H
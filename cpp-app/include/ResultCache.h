@@ -0,0 +1,51 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include "VulnerabilityDefinition.h"
+#include "SystemFacts.h"
+
+// Resultados de varreduras anteriores, persistidos entre execuções.
+// Cada resultado guarda a identidade das entradas de que dependeu (inode,
+// tamanho, mtime e ctime dos arquivos, binários resolvidos no PATH e a geração
+// do banco de pacotes) e o usuário efetivo, que decide o que é legível.
+// Se nada mudou, a regra não precisa ser reavaliada e a evidência guardada
+// junto com o veredito é devolvida como está.
+class ResultCache
+{
+public:
+    explicit ResultCache(const QString &filePath = defaultPath());
+    
+    static QString defaultPath();
+    
+    bool load();
+    bool save();
+    void clear();
+    
+    // Assinatura das entradas, obtida só com stat(). Vazia se a regra depende
+    // de algo sem identidade estável (serviços, /proc) e não pode ser cacheada.
+    static QByteArray inputStamp(const FactRequirements &requirements);
+    
+    bool lookup(const VulnerabilityDefinition &vuln, const QByteArray &stamp, bool *isVulnerable,
+                QString *evidence = nullptr) const;
+    void store(const VulnerabilityDefinition &vuln, const QByteArray &stamp, bool isVulnerable,
+               const QString &evidence);
+
+private:
+    struct Entry {
+        QByteArray checkDigest;
+        QByteArray inputStamp;
+        bool isVulnerable;
+        QString evidence;
+        
+        Entry() : isVulnerable(false) {}
+    };
+    
+    QString m_filePath;
+    QHash<QString, Entry> m_entries;
+    bool m_dirty;
+};
+
+#endif // RESULTCACHE_H
@@ -0,0 +1,124 @@
+#ifndef RULECATALOG_H
+#define RULECATALOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QJsonArray>
+#include <QMutex>
+#include <QSharedPointer>
+#include "VulnerabilityDefinition.h"
+#include "StringArena.h"
+
+// Campos de texto materializados em cada regra entregue pelo catálogo
+enum class RuleText {
+    Full,       // tudo, para a interface e relatórios completos
+    Summary     // só id e nome; descrição, impacto, correção e tags ficam vazios
+};
+
+// Catálogo de regras imutável, particionado por sistema. Cada partição guarda
+// o trecho JSON de origem e só é interpretada na primeira consulta. Depois
+// disso cada regra vira um registro de tamanho fixo que aponta para textos em
+// UTF-8 numa StringArena por partição (textos repetidos guardados uma vez), e
+// VulnerabilityDefinition com QString só é montada quando alguém pede regras.
+// O resumo (id e nome, o que o scanner usa) é montado uma vez por partição e
+// compartilhado implicitamente; o texto completo é montado a cada pedido, para
+// descrições e correções não ficarem guardadas duas vezes.
+// Índices por id, severidade e tag. Seguro para consultas de várias threads.
+class RuleCatalog
+{
+public:
+    RuleCatalog();
+    
+    // strict: qualquer regra inválida (sem id, id repetido, "check" inválido)
+    // rejeita o arquivo, e todas as partições são interpretadas na hora.
+    // Sem strict as partições ficam para depois e regras inválidas viram aviso
+    static QSharedPointer<RuleCatalog> fromJson(const QString &path, const QByteArray &data,
+                                                bool strict, QString *error);
+    
+    QString path() const;
+    QByteArray digest() const;         // SHA-1 do arquivo
+    QStringList systems() const;
+    bool isEmpty() const;
+    
+    // RuleText::Summary: cópia rasa do vetor guardado. RuleText::Full: montadas
+    // a cada chamada; a interface guarda só as regras que exibe
+    QVector<VulnerabilityDefinition> rules(const QString &os, RuleText fields = RuleText::Full) const;
+    VulnerabilityDefinition rule(const QString &os, int index, RuleText fields = RuleText::Full) const;
+    int ruleCount(const QString &os) const;
+    // Posições em rules(os); -1 / vazio se não houver
+    int indexOf(const QString &os, const QString &id) const;
+    QVector<int> withSeverity(const QString &os, Severity severity) const;
+    QVector<int> withTag(const QString &os, const QString &tag) const;
+    
+    // Bytes guardados em textos, registros, índices, partes executáveis e
+    // resumo guardado (sem contar as árvores de verificação e as correções)
+    qint64 storageBytes(const QString &os) const;
+    
+    static Severity stringToSeverity(const QString &severityStr);
+    static QString severityToString(Severity severity);
+
+private:
+    struct RuleRecord {
+        StringArena::Ref id;
+        StringArena::Ref name;
+        StringArena::Ref description;
+        StringArena::Ref impact;
+        StringArena::Ref fix;
+        quint32 firstTag;              // posição em tags
+        quint16 tagCount;
+        quint8 severity;
+        qint32 extras;                 // posição em extras; -1 = nenhum
+        qint32 checkTimeoutMs;
+        qint32 fixTimeoutMs;
+    };
+    
+    // Partes executáveis, guardadas só para as regras que as declaram
+    struct RuleExtras {
+        QSharedPointer<const CheckExpression> check;
+        QByteArray checkDigest;
+        Remediation remediation;
+        QStringList dependsOn;
+        QHash<QString, bool> skipIf;
+        QSharedPointer<const Applicability> applicability;
+    };
+    
+    struct Partition {
+        QJsonArray source;             // liberado depois de interpretado
+        bool materialized;
+        StringArena text;
+        QVector<RuleRecord> records;
+        QVector<RuleExtras> extras;
+        QVector<StringArena::Ref> tags;
+        QVector<int> byId;             // posições ordenadas pelo id
+        QHash<int, QVector<int>> bySeverity;
+        QHash<QString, QVector<int>> byTag;
+        // rules(os, RuleText::Summary), montado na primeira chamada
+        mutable QVector<VulnerabilityDefinition> summary;
+        mutable bool summaryBuilt;
+        
+        Partition() : materialized(false), summaryBuilt(false) {}
+    };
+    
+    QString m_path;
+    QByteArray m_digest;
+    QStringList m_systems;             // ordem do arquivo
+    mutable QHash<QString, Partition> m_partitions;
+    mutable QMutex m_mutex;
+    
+    Q_DISABLE_COPY(RuleCatalog)
+    
+    // Chamadas com m_mutex travado
+    const Partition *partition(const QString &os) const;
+    static bool materialize(const QString &os, Partition &partition, bool strict, QString *error);
+    static void store(Partition &partition, const VulnerabilityDefinition &def);
+    static VulnerabilityDefinition definition(const Partition &partition, int index, RuleText fields);
+    static QVector<VulnerabilityDefinition> definitions(const Partition &partition, RuleText fields);
+    static VulnerabilityDefinition parseRule(const QJsonObject &obj, QString *checkError);
+};
+
+typedef QSharedPointer<const RuleCatalog> RuleCatalogPtr;
+
+#endif // RULECATALOG_H
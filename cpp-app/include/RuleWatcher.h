@@ -0,0 +1,67 @@
+#ifndef RULEWATCHER_H
+#define RULEWATCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include "VulnerabilityDefinition.h"
+
+// Observa com inotify as entradas de que cada regra nativa depende (arquivos,
+// diretórios, binários no PATH, banco de pacotes) e avisa quais regras precisam
+// ser reavaliadas. Cada arquivo é observado pelo diretório pai, o que cobre
+// edições no lugar, substituições atômicas por rename e arquivos criados depois.
+// Rajadas de eventos (uma transação do apt) viram uma única notificação.
+// Só faz algo no Linux.
+class RuleWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RuleWatcher(QObject *parent = nullptr);
+    ~RuleWatcher();
+    
+    // Silêncio exigido antes de notificar e atraso máximo durante uma rajada
+    void setDebounce(int quietMs, int maxDelayMs);
+    
+    bool watch(const QVector<VulnerabilityDefinition> &rules);
+    void stop();
+    bool isWatching() const;
+    
+    // Regras sem entradas observáveis: serviços, sockets, /proc e "shell"
+    QStringList unwatchedRules() const;
+    
+    static const int DEFAULT_QUIET_MS;
+    static const int DEFAULT_MAX_DELAY_MS;
+
+signals:
+    void rulesChanged(const QStringList &ids);
+
+private slots:
+    void onEvents();
+    void onDebounceTimeout();
+
+private:
+    int m_fd;
+    QSocketNotifier *m_notifier;
+    QTimer *m_debounce;
+    QElapsedTimer m_burst;
+    int m_maxDelayMs;
+    
+    QHash<QString, QStringList> m_fileRules;  // arquivo -> regras
+    QHash<QString, QStringList> m_dirRules;   // diretório cujo conteúdo importa -> regras
+    QHash<int, QString> m_watches;            // descritor do inotify -> diretório
+    QSet<QString> m_dirtyRules;
+    QStringList m_unwatched;
+    bool m_rebuildPending;
+    
+    void addTarget(QHash<QString, QStringList> &targets, const QString &path, const QString &id);
+    void rebuildWatches();
+    void markDirty(const QString &path, const QString &watchedDir);
+};
+
+#endif // RULEWATCHER_H
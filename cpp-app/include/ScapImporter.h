@@ -0,0 +1,151 @@
+#ifndef SCAPIMPORTER_H
+#define SCAPIMPORTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+
+class QIODevice;
+class QXmlStreamReader;
+
+// Regra XCCDF ou definição OVAL que não virou regra do catálogo
+struct ScapSkip {
+    QString id;
+    QString reason;       // motivo agrupável, ex.: "teste environmentvariable58_test"
+    QString detail;       // item OVAL que causou o descarte
+};
+
+// Converte conteúdo SCAP (benchmark XCCDF, definições OVAL ou um data stream
+// com os dois) em regras no formato do vulnerabilities.json.
+// A leitura é em fluxo com QXmlStreamReader: textos longos, perfis, correções
+// e elementos de tipos sem primitiva nativa são descartados à medida que
+// passam. Ficam em memória só o resumo de cada regra e os testes, objetos e
+// estados traduzíveis: textfilecontent54, file, rpminfo, dpkginfo e sysctl.
+// Plataformas (CPE do XCCDF, "affected" do OVAL) e o formato dos pacotes
+// testados viram o "applies_to" da regra.
+class ScapImporter
+{
+public:
+    ScapImporter();
+    
+    // Vários arquivos podem ser somados (ex.: benchmark e OVAL separados);
+    // referências entre eles são resolvidas em rules()
+    bool addFile(const QString &path, QString *error);
+    bool addDevice(QIODevice *device, const QString &name, QString *error);
+    
+    // Regras para a seção "linux": uma por regra XCCDF com verificação OVAL ou,
+    // sem benchmark, uma por definição OVAL de vulnerabilidade, patch ou conformidade
+    QJsonArray rules();
+    const QVector<ScapSkip> &skipped() const;
+    
+    static const int MAX_TEXT_LENGTH;
+    static const int MAX_TAGS;
+
+private:
+    struct OvalObject {
+        QString kind;         // "familia:tipo", ex.: "unix:file"
+        QStringList targets;  // caminhos, pacotes ou chaves sysctl
+        QString varRef;       // alvos vindos de uma constant_variable
+        QString pattern;
+        bool firstInstance;   // instance = 1: só a primeira ocorrência é item
+        
+        OvalObject() : firstInstance(false) {}
+    };
+    
+    struct OvalState {
+        QString kind;
+        QString value;        // evr limite, valor do sysctl ou subexpressão
+        QString varRef;
+        int mode;
+        int mask;
+        
+        OvalState() : mode(0), mask(0) {}
+    };
+    
+    struct OvalTest {
+        QString kind;
+        QString objectRef;
+        QString stateRef;
+        QString existence;
+        QString check;
+    };
+    
+    struct Criteria {
+        enum class Kind {
+            All,
+            Any,
+            Test,
+            Definition
+        };
+        Kind kind;
+        bool negate;
+        QString ref;
+        QVector<Criteria> children;
+        
+        Criteria() : kind(Kind::All), negate(false) {}
+    };
+    
+    struct OvalDefinition {
+        QString cls;
+        QString title;
+        QString description;
+        QString severity;
+        QStringList platforms;
+        QStringList references;
+        bool deprecated;
+        QString problem;
+        Criteria criteria;
+        
+        OvalDefinition() : deprecated(false) {}
+    };
+    
+    struct XccdfRule {
+        QString id;
+        QString title;
+        QString description;
+        QString rationale;
+        QString severity;
+        QStringList platforms;
+        QStringList idents;
+        QString ovalRef;
+        QString problem;
+    };
+    
+    QHash<QString, OvalObject> m_objects;
+    QHash<QString, OvalState> m_states;
+    QHash<QString, OvalTest> m_tests;
+    QHash<QString, QStringList> m_variables;   // constant_variable -> valores
+    QHash<QString, QString> m_unsupported;     // id de teste, objeto, estado ou variável -> motivo
+    QHash<QString, OvalDefinition> m_definitions;
+    QStringList m_definitionOrder;
+    QVector<XccdfRule> m_rules;
+    QVector<ScapSkip> m_skipped;
+    
+    void parseXccdfContainer(QXmlStreamReader &xml, QStringList platforms);
+    void parseXccdfRule(QXmlStreamReader &xml, const QStringList &platforms);
+    void parseOval(QXmlStreamReader &xml);
+    void parseDefinition(QXmlStreamReader &xml);
+    Criteria parseCriteria(QXmlStreamReader &xml, QString *problem);
+    void parseTest(QXmlStreamReader &xml);
+    void parseObject(QXmlStreamReader &xml);
+    void parseState(QXmlStreamReader &xml);
+    void parseVariable(QXmlStreamReader &xml);
+    
+    // Expressão "check" equivalente; nula com skip preenchido se não houver tradução
+    QJsonValue translateDefinition(const QString &id, QStringList *formats, ScapSkip *skip, int depth) const;
+    QJsonValue translateCriteria(const Criteria &criteria, QStringList *formats, ScapSkip *skip, int depth) const;
+    QJsonValue translateTest(const QString &id, QStringList *formats, ScapSkip *skip) const;
+    
+    static QJsonObject rule(const QString &id, const QString &name, const QString &description,
+                            const QString &impact, const QString &severity, const QStringList &platforms,
+                            const QStringList &tags, const QStringList &formats, const QJsonValue &check);
+    static QJsonObject applicability(const QStringList &platforms, const QStringList &formats);
+    static QString ruleId(const QString &scapId);
+    static QString readText(QXmlStreamReader &xml);
+};
+
+#endif // SCAPIMPORTER_H
@@ -9,16 +9,19 @@
 #include <QProgressBar>
 #include <QComboBox>
 #include <QTextEdit>
+#include <QPlainTextEdit>
 #include <QFrame>
 #include <QTimer>
 #include <QFileDialog>
 #include <QDateTime>
 #include <QScrollArea>
+#include <QElapsedTimer>
 #include "VulnerabilityDefinition.h"
 #include "VulnerabilityManager.h"
 #include "SystemChecker.h"
 #include "OllamaClient.h"
 #include "LandingPage.h"
+#include "MetricsExporter.h"
 
 class SecurityChecker : public QWidget
 {
@@ -28,6 +31,12 @@ public:
     explicit SecurityChecker(QWidget *parent = nullptr);
     
     void setScanMode(LandingPage::ScanMode mode, const QString &modelName = QString());
+    
+    // Ignorar o cache de resultados e reavaliar todas as regras
+    void setFullScan(bool fullScan);
+    
+    // Arquivo .prom regravado ao fim de cada lote de verificações ou correção
+    void setMetricsPath(const QString &path);
 
 signals:
     void backRequested();
@@ -36,15 +45,24 @@ signals:
 private slots:
     void onBackClicked();
     void onStartCheckClicked();
+    void onCheckAllClicked();
     void onFixClicked();
+    void onFixAllClicked();
     void onSkipClicked();
     void onNextClicked();
-    void onCheckCompleted(const QString &id, bool isVulnerable);
-    void onFixCompleted(const QString &id, bool success);
+    void onCheckCompleted(const QString &id, bool isVulnerable, const QString &evidence);
+    void onAllChecksCompleted();
+    void onCheckTimedOut(const QString &id, const QString &evidence);
+    void onCheckNotApplicable(const QString &id);
+    void onFixTimedOut(const QString &id, const QString &log);
+    void onFixCompleted(const QString &id, bool success, const QString &log);
+    void onFixOutput(const QString &step, const QString &text);
     void onErrorOccurred(const QString &error);
     void onSaveReportClicked();
     void onOllamaVulnerabilitiesReceived(const QVector<VulnerabilityDefinition> &vulnerabilities);
     void onOllamaError(const QString &error);
+    void onOllamaUsageReported(const OllamaUsage &usage);
+    void onDefinitionsReloaded();
 
 private:
     void setupUI();
@@ -59,6 +77,7 @@ private:
     void updateCurrentCheck();
     void updateActionButtons();
     void updateOSDisplay();
+    void showCurrentResult();
     void showResults();
     void resetChecker();
     
@@ -67,6 +86,11 @@ private:
     QString getStatusColor(CheckStatus status) const;
     void startOllamaAnalysis();
     SystemInfo collectSystemInfo() const;
+    // m_currentVulnerabilities só muda por aqui, para manter o índice por id
+    void setCurrentVulnerabilities(const QVector<VulnerabilityDefinition> &rules);
+    int ruleIndex(const QString &id) const;     // -1 se não está na lista
+    void observeCheckDuration(const QString &id);
+    void writeMetrics();
     
     // UI Components
     QVBoxLayout *m_mainLayout;
@@ -81,13 +105,16 @@ private:
     QLabel *m_descriptionLabel;
     QLabel *m_impactLabel;
     QTextEdit *m_fixCommandEdit;
+    QPlainTextEdit *m_outputView;
     
     QFrame *m_resultFrame;
     QLabel *m_resultIcon;
     QLabel *m_resultText;
     
     QPushButton *m_startCheckButton;
+    QPushButton *m_checkAllButton;
     QPushButton *m_fixButton;
+    QPushButton *m_fixAllButton;
     QPushButton *m_skipButton;
     QPushButton *m_nextButton;
     
@@ -99,6 +126,7 @@ private:
     SystemChecker *m_systemChecker;
     OllamaClient *m_ollamaClient;
     QVector<VulnerabilityDefinition> m_currentVulnerabilities;
+    QHash<QString, int> m_ruleIndex;    // id -> posição em m_currentVulnerabilities
     QVector<CheckResult> m_checkResults;
     int m_currentCheckIndex;
     QString m_currentOS;
@@ -107,6 +135,11 @@ private:
     // Modo de verificação
     LandingPage::ScanMode m_scanMode;
     QString m_selectedModel;
+    
+    // Métricas (--metrics)
+    QString m_metricsPath;
+    MetricsExporter m_metrics;
+    QElapsedTimer m_scanTimer;
 };
 
 #endif // SECURITYCHECKER_H
\ No newline at end of file
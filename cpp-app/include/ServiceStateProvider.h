@@ -0,0 +1,70 @@
+#ifndef SERVICESTATEPROVIDER_H
+#define SERVICESTATEPROVIDER_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QByteArray>
+#include <functional>
+
+class QObject;
+
+struct UnitState {
+    QString activeState;      // active, inactive, failed...
+    QString subState;         // running, exited, dead...
+    QString unitFileState;    // enabled, disabled, static, masked...
+};
+
+// Estado das unidades do systemd obtido direto do gerenciador via D-Bus.
+// refresh() faz ListUnits e ListUnitFiles em paralelo, numa única ida e volta,
+// e o resultado vale para a varredura inteira. O barramento e o nome do serviço
+// podem ser trocados para apontar para um substituto em um barramento de sessão.
+// Sem D-Bus (contêineres, chroot), refreshFromSystemctl() monta a mesma tabela
+// com list-units e list-unit-files, também uma única vez por varredura.
+// Aliases (ex.: sshd.service -> ssh.service) são resolvidos pelos links dos
+// arquivos de unidade.
+class ServiceStateProvider
+{
+public:
+    // busAddress vazio = barramento do sistema
+    explicit ServiceStateProvider(const QString &busAddress = QString(),
+                                  const QString &serviceName = "org.freedesktop.systemd1");
+    ~ServiceStateProvider();
+    
+    // Consultas bloqueantes, para quem não tem laço de eventos
+    bool refresh();
+    bool refreshFromSystemctl();
+    // A mesma consulta sem bloquear: chamadas D-Bus assíncronas ou, sem D-Bus,
+    // os dois systemctl como processos assíncronos. onReady roda no laço de
+    // eventos quando a tabela fica pronta ou a consulta falha (ver isLoaded()).
+    // context precisa viver menos que o provedor (em geral, é o dono dele);
+    // clear() descarta a consulta em andamento sem chamar onReady.
+    void refreshAsync(QObject *context, const std::function<void()> &onReady);
+    bool isRefreshing() const;
+    bool isLoaded() const;
+    void clear();
+    
+    // Aceita "fail2ban" ou "fail2ban.service", e também aliases
+    UnitState unit(const QString &name) const;
+    QStringList runningServices() const;
+
+private:
+    QString m_busAddress;
+    QString m_serviceName;
+    QString m_connectionName;
+    QHash<QString, UnitState> m_units;
+    QHash<QString, QString> m_aliases;       // alias -> nome real da unidade
+    bool m_loaded;
+    bool m_refreshing;
+    quint64 m_generation;                    // muda a cada clear()
+    
+    void refreshFromSystemctlAsync(QObject *context, quint64 generation, const std::function<void()> &onReady);
+    void loadSystemctlOutput(const QByteArray &units, const QByteArray &files);
+    void addUnitFile(const QString &path, const QString &fileState);
+    
+    static QString unitName(const QString &name);
+    
+    Q_DISABLE_COPY(ServiceStateProvider)
+};
+
+#endif // SERVICESTATEPROVIDER_H
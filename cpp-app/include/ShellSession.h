@@ -0,0 +1,76 @@
+#ifndef SHELLSESSION_H
+#define SHELLSESSION_H
+
+#include <QObject>
+#include <QProcess>
+#include <QByteArray>
+#include <QTimer>
+#include <QStringDecoder>
+#include "OutputCapture.h"
+
+// Sessão de shell de longa duração que executa um comando por vez.
+// No Unix um único /bin/bash atende todos os comandos: cada um roda em um
+// subshell próprio (ambiente e diretório não vazam entre comandos) e o
+// código de saída volta por um marcador no stdout. Cada comando roda em seu
+// próprio grupo de processos, que é encerrado inteiro em timeout ou cancelamento.
+// A saída do comando (stdout e stderr) é repassada aos poucos por
+// outputReceived() e guardada em um OutputCapture limitado até o próximo run().
+// No Windows cada comando ainda cria seu próprio processo.
+class ShellSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ShellSession(QObject *parent = nullptr);
+    ~ShellSession();
+    
+    // timeoutMs <= 0 desativa o limite de tempo
+    bool run(const QString &command, int timeoutMs = 0);
+    void cancel();
+    bool isBusy() const;
+    
+    void setOutputLimits(int headBytes, int tailBytes);
+    const OutputCapture &output() const;
+
+signals:
+    void outputReceived(const QString &text);
+    void commandFinished(int exitCode);
+    void commandFailed(const QString &error);
+    void commandTimedOut();
+    void commandCancelled();
+
+private slots:
+    void onReadyRead();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onTimeout();
+    void onKillTimer();
+
+private:
+    enum class AbortReason {
+        None,
+        TimedOut,
+        Cancelled
+    };
+    
+    QProcess *m_process;
+    QByteArray m_buffer;
+    OutputCapture m_output;
+    QStringDecoder m_decoder;
+    QByteArray m_marker;
+    bool m_busy;
+    qint64 m_commandPid;
+    QString m_command;
+    qint64 m_commandStartUs;  // TraceRecorder::now() ao iniciar o comando
+    AbortReason m_abortReason;
+    int m_killStage;
+    QTimer *m_timeoutTimer;
+    QTimer *m_killTimer;
+    
+    bool ensureStarted();
+    void abort(AbortReason reason);
+    void killProcessGroup(bool force);
+    void completeCommand(int exitCode, bool sessionLost);
+    void appendOutput(const QByteArray &data);
+};
+
+#endif // SHELLSESSION_H
@@ -0,0 +1,35 @@
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+
+// Textos em UTF-8 num único buffer, cada um terminado em '\0'. Textos iguais
+// são guardados uma vez só, o que compacta pacotes grandes em que impactos,
+// correções e tags se repetem. Referências são deslocamentos de 32 bits;
+// a referência 0 é o texto vazio.
+class StringArena
+{
+public:
+    typedef quint32 Ref;
+    
+    StringArena();
+    
+    Ref intern(const QString &text);
+    QString text(Ref ref) const;
+    const char *utf8(Ref ref) const;
+    
+    // Bytes ocupados pelos textos
+    int size() const;
+    
+    // Encerra a construção: libera a tabela de deduplicação e a folga do buffer.
+    // intern() continua funcionando, mas só deduplica os textos novos
+    void squeeze();
+
+private:
+    QByteArray m_data;
+    QHash<QByteArray, Ref> m_index;
+};
+
+#endif // STRINGARENA_H
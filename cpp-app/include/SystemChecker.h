@@ -5,7 +5,25 @@
 #include <QProcess>
 #include <QTimer>
 #include <QRandomGenerator>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QElapsedTimer>
 #include "VulnerabilityDefinition.h"
+#include "SystemFacts.h"
+#include "ResultCache.h"
+#include "RemediationPlanner.h"
+#include "ShellSession.h"
+
+// Contadores acumulados desde a criação do SystemChecker
+struct ScanCounters {
+    quint64 commands;     // comandos de verificação e correção executados
+    quint64 timeouts;
+    quint64 failures;     // não iniciaram ou terminaram de forma anormal
+    
+    ScanCounters() : commands(0), timeouts(0), failures(0) {}
+};
 
 class SystemChecker : public QObject
 {
@@ -14,28 +32,139 @@ class SystemChecker : public QObject
 public:
     explicit SystemChecker(QObject *parent = nullptr);
     
+    // Inicia uma nova varredura: descarta fatos e resultados anteriores.
+    // As regras informadas resolvem os "depends_on"/"skip_if" das verificações,
+    // e o "applies_to" delas é avaliado aqui, uma única vez, contra a plataforma.
+    void beginScan(const QVector<VulnerabilityDefinition> &rules = QVector<VulnerabilityDefinition>());
     void checkVulnerability(const VulnerabilityDefinition &vuln);
+    void checkAll(const QVector<VulnerabilityDefinition> &vulns);
+    // Reavalia regras da varredura atual com fatos relidos, junto com as regras
+    // que dependem delas (modo de observação)
+    void recheck(const QStringList &ids);
     void fixVulnerability(const VulnerabilityDefinition &vuln);
+    // Corrige várias regras com um único plano (ver RemediationPlanner)
+    void fixAll(const QVector<VulnerabilityDefinition> &vulns);
+    bool isFixing() const;
     bool isRunningAsAdmin() const;
+    
+    // Limite de verificações executadas simultaneamente
+    void setMaxConcurrentChecks(int limit);
+    int maxConcurrentChecks() const;
+    int pendingCheckCount() const;
+    
+    // Limites de tempo usados quando a regra não define "timeout"/"fix_timeout"
+    void setDefaultTimeouts(int checkTimeoutMs, int fixTimeoutMs);
+    
+    // Reaproveita resultados de regras cujas entradas não mudaram desde a última
+    // varredura. Desativado (--full) reavalia tudo, mas ainda atualiza o cache.
+    void setIncremental(bool enabled);
+    bool isIncremental() const;
+    
+    // Memória máxima para a saída de cada verificação ou passo de correção;
+    // um quarto guarda o início da saída e o restante, o final
+    void setOutputLimit(int bytes);
+    int outputLimit() const;
+    
+    const ScanCounters &counters() const;
+    // Segundos da última avaliação da regra, da saída da fila ao resultado;
+    // negativo se ela ainda não foi avaliada (ou foi pulada)
+    double checkDuration(const QString &id) const;
+    
+    // Cancela verificações pendentes e em execução, ou a correção em andamento
+    void cancelChecks();
+    void cancelFix();
+    
+    static const int DEFAULT_CHECK_TIMEOUT_MS;
+    static const int DEFAULT_FIX_TIMEOUT_MS;
+    static const int DEFAULT_OUTPUT_LIMIT_BYTES;
 
 signals:
-    void checkCompleted(const QString &id, bool isVulnerable);
-    void fixCompleted(const QString &id, bool success);
+    // Pode ser emitido fora de ordem quando há verificações em paralelo.
+    // evidence traz a saída do comando de verificação ou, para primitivas
+    // nativas, os fatos observados (também quando o resultado vem do cache).
+    void checkCompleted(const QString &id, bool isVulnerable, const QString &evidence);
+    // Também emitido para as verificações canceladas por cancelChecks()
+    void checkTimedOut(const QString &id, const QString &evidence);
+    void checkNotApplicable(const QString &id);
+    void allChecksCompleted();
+    // log traz a saída dos passos do plano que atenderam a regra
+    void fixCompleted(const QString &id, bool success, const QString &log);
+    void fixTimedOut(const QString &id, const QString &log);
+    // Saída parcial, à medida que os comandos a produzem
+    void checkOutput(const QString &id, const QString &text);
+    void fixOutput(const QString &step, const QString &text);
     void errorOccurred(const QString &error);
 
 private slots:
-    void onCheckProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onFixProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onCheckCommandFinished(int exitCode);
+    void onCheckCommandFailed(const QString &error);
+    void onCheckCommandTimedOut();
+    void onCheckCommandCancelled();
+    void onFixCommandFinished(int exitCode);
+    void onFixCommandFailed(const QString &error);
+    void onFixCommandTimedOut();
+    void onFixCommandCancelled();
+    void onCheckOutput(const QString &text);
+    void onFixOutput(const QString &text);
 
 private:
-    QProcess *m_checkProcess;
-    QProcess *m_fixProcess;
-    QString m_currentCheckId;
-    QString m_currentFixId;
-    
-    QString getCheckCommand(const VulnerabilityDefinition &vuln) const;
-    QString getFixCommand(const VulnerabilityDefinition &vuln) const;
-    bool executeCommand(const QString &command, QProcess *process);
+    // Plano de correção em execução: uma fase por vez, passos da fase em paralelo
+    RemediationPlan m_fixPlan;
+    int m_fixPhase;
+    QVector<ShellSession *> m_fixSessions;
+    QHash<ShellSession *, RemediationStep> m_runningFixSteps;
+    QSet<QString> m_failedFixes;
+    QSet<QString> m_timedOutFixes;
+    QHash<QString, QString> m_fixLogs;       // id -> saída dos passos da regra
+    bool m_fixActive;
+    qint64 m_fixPlanStartUs;                 // instantes do TraceRecorder
+    QHash<ShellSession *, qint64> m_fixStepStartUs;
+    
+    // Fila de verificações e sessões de shell reutilizadas entre verificações
+    QList<VulnerabilityDefinition> m_pendingChecks;
+    QVector<ShellSession *> m_checkSessions;
+    QHash<ShellSession *, QString> m_runningChecks;
+    int m_maxConcurrentChecks;
+    bool m_scanActive;
+    int m_checkTimeoutMs;
+    int m_fixTimeoutMs;
+    int m_outputLimit;
+    
+    SystemFacts m_facts;
+    ResultCache m_resultCache;
+    bool m_resultCacheLoaded;
+    bool m_incremental;
+    
+    // Grafo de dependências da varredura atual
+    QHash<QString, VulnerabilityDefinition> m_scanRules;
+    QHash<QString, bool> m_scanResults;      // id -> vulnerável
+    QSet<QString> m_settledChecks;           // concluídas, com ou sem resultado
+    QSet<QString> m_scheduledChecks;         // na fila ou em execução
+    QSet<QString> m_inapplicable;            // "applies_to" não vale nesta plataforma
+    QHash<QString, QByteArray> m_inputStamps; // assinatura das entradas, uma por regra
+    QHash<QString, qint64> m_checkStartUs;   // entrada na fila, com o trace ativo
+    
+    ScanCounters m_counters;
+    QElapsedTimer m_checkClock;
+    QHash<QString, qint64> m_checkRunStartNs;
+    QHash<QString, double> m_checkDurations;
+    
+    void scheduleCheck(const VulnerabilityDefinition &vuln);
+    bool isReady(const VulnerabilityDefinition &vuln) const;
+    bool isSkipped(const VulnerabilityDefinition &vuln) const;
+    void planApplicability(const VulnerabilityDefinition &rule);
+    void settleCheck(const QString &id);
+    void completeCheck(const QString &id, bool isVulnerable, const QString &evidence = QString());
+    QByteArray inputStamp(const VulnerabilityDefinition &vuln);
+    bool cachedResult(const VulnerabilityDefinition &vuln, bool *isVulnerable);
+    void startPendingChecks();
+    ShellSession *idleCheckSession();
+    ShellSession *takeRunningCheck(QString &id);
+    ShellSession *createSession();
+    
+    void startFixPhase();
+    void finishFixStep(bool success, bool timedOut);
+    void finishFixPlan();
 };
 
 #endif // SYSTEMCHECKER_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef SYSTEMFACTS_H
+#define SYSTEMFACTS_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QDateTime>
+#include <functional>
+#include "ServiceStateProvider.h"
+#include "PackageInventory.h"
+#include "NetworkExposure.h"
+
+// Fatos que uma verificação precisa para ser avaliada
+struct FactRequirements {
+    QStringList files;        // conteúdo e permissões
+    QStringList directories;  // todos os arquivos regulares do diretório
+    QStringList binaries;     // presença no PATH
+    QStringList services;     // estado ativo/habilitado
+    QStringList packages;     // pacotes instalados
+    QStringList upgradable;   // padrões de nome de pacotes com atualização disponível
+    QStringList ports;        // portas em escuta, como "22/tcp"
+    
+    void merge(const FactRequirements &other);
+    // Serviços, sockets e /proc só existem no sistema em execução
+    bool needsLiveSystem() const;
+};
+
+struct FileFact {
+    bool exists;
+    uint mode;                // bits de permissão (ex.: 0644)
+    QByteArray content;
+    
+    FileFact() : exists(false), mode(0) {}
+};
+
+struct ServiceFact {
+    QString activeState;      // ActiveState do systemd (active, inactive...)
+    QString enabledState;     // UnitFileState do systemd (enabled, disabled...)
+};
+
+// Fotografia do sistema coletada uma única vez por varredura.
+// collect() só busca o que ainda falta; clear() inicia uma nova varredura.
+class SystemFacts
+{
+public:
+    SystemFacts();
+    
+    // Raiz alternativa (imagem montada, chroot): arquivos, binários e pacotes
+    // são lidos dentro dela. Vazia = sistema em execução.
+    void setRoot(const QString &root);
+    QString root() const;
+    
+    void collect(const FactRequirements &requirements);
+    // Inicia sem bloquear a consulta ao systemd quando requirements pede
+    // serviços e a varredura ainda não a fez. Retorna true se onReady será
+    // chamado; até lá, collect() não preenche o estado dos serviços.
+    bool prefetchServices(const FactRequirements &requirements, QObject *context,
+                          const std::function<void()> &onReady);
+    bool isWaitingForServices() const;
+    void clear();
+    // Descarta só os fatos listados, para que o próximo collect() os leia de novo
+    void invalidate(const FactRequirements &requirements);
+    bool isEmpty() const;
+    QDateTime collectedAt() const;
+    
+    bool fileExists(const QString &path) const;
+    QByteArray fileContent(const QString &path) const;
+    int fileMode(const QString &path) const;   // -1 se o arquivo não existe
+    QStringList filesInDirectory(const QString &dir) const;
+    
+    bool hasBinary(const QString &name) const;
+    bool isServiceActive(const QString &unit) const;
+    bool isServiceEnabled(const QString &unit) const;
+    bool isPackageInstalled(const QString &name) const;
+    bool hasPackageUpdate(const QString &namePattern) const;
+    const PackageInventory &packages() const;
+    bool isPortListening(quint16 port, const QString &protocol, bool exposedOnly) const;
+    const NetworkExposure &network() const;
+    
+    // Caminho real de path dentro de root, resolvendo links simbólicos como um
+    // chroot faria: links absolutos e ".." não escapam da raiz
+    static QString resolveInRoot(const QString &root, const QString &path);
+    // Executável no PATH do sistema atual ou nos diretórios padrão da raiz
+    static bool findBinary(const QString &root, const QString &name);
+
+private:
+    QString m_root;
+    QHash<QString, FileFact> m_files;
+    QHash<QString, QStringList> m_directories;
+    QHash<QString, bool> m_binaries;
+    QHash<QString, ServiceFact> m_services;
+    ServiceStateProvider m_serviceStates;
+    bool m_serviceStatesQueried;
+    PackageInventory m_packages;
+    bool m_packagesLoaded;
+    bool m_packageCandidatesLoaded;
+    NetworkExposure m_network;
+    QDateTime m_collectedAt;
+    
+    void collectFile(const QString &path);
+    void collectServices(const QStringList &units);
+    void collectPackages();
+};
+
+#endif // SYSTEMFACTS_H
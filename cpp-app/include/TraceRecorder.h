@@ -0,0 +1,55 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+// Registro opcional de intervalos de tempo no formato trace-event do Chrome,
+// para abrir no Perfetto (ui.perfetto.dev) ou em chrome://tracing. Desligado,
+// cada ponto instrumentado custa uma leitura atômica. Pode ser usado de
+// qualquer thread; os eventos ficam em memória até flush() ou stop().
+// Processos longos (--watch) gravam com flush() de tempos em tempos e limitam
+// o buffer com setMaxEvents(): passado o limite, os eventos mais antigos são
+// descartados e o arquivo guarda a janela mais recente.
+class TraceRecorder
+{
+public:
+    // Começa a registrar; o arquivo só é escrito em flush() e stop()
+    static void start(const QString &path);
+    static bool stop();
+    // Regrava o arquivo com o que há em memória, sem parar o registro
+    static bool flush();
+    static bool isEnabled();
+    // 0 = sem limite (padrão)
+    static void setMaxEvents(int maxEvents);
+    
+    // Microssegundos desde start()
+    static qint64 now();
+    
+    // Intervalo síncrono, de startUs até agora, na thread atual
+    static void complete(const char *category, const QString &name, qint64 startUs,
+                         const QJsonObject &args = QJsonObject());
+    // Intervalo que pode se sobrepor a outros da mesma thread (comandos em
+    // paralelo, requisições de rede): vira uma trilha assíncrona própria
+    static void completeAsync(const char *category, const QString &name, qint64 startUs,
+                              const QJsonObject &args = QJsonObject());
+};
+
+// Mede o escopo atual: TraceSpan span("facts", "collect");
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const QString &name);
+    ~TraceSpan();
+    
+    void setArg(const QString &key, const QJsonValue &value);
+
+private:
+    const char *m_category;
+    QString m_name;
+    qint64 m_start;
+    QJsonObject m_args;
+};
+
+#endif // TRACERECORDER_H
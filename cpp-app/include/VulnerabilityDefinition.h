@@ -2,6 +2,14 @@
 #define VULNERABILITYDEFINITION_H
 
 #include <QString>
+#include <QSharedPointer>
+#include <QByteArray>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+class CheckExpression;
+struct Applicability;
 
 enum class Severity {
     Alta,
@@ -15,7 +23,38 @@ enum class CheckStatus {
     Vulnerable,
     Safe,
     Skipped,
-    Fixed
+    Fixed,
+    TimedOut,
+    NotApplicable
+};
+
+struct FileEdit {
+    QString file;
+    QString command;
+};
+
+struct ServiceAction {
+    QString name;
+    bool enable;
+    bool restart;
+    QString validate;         // comando executado antes de reiniciar (ex.: "sshd -t")
+    
+    ServiceAction() : enable(false), restart(false) {}
+};
+
+// Correção declarada no campo "remediation": o RemediationPlanner junta as de
+// várias regras em uma única transação de pacotes e um reinício por serviço
+struct Remediation {
+    QStringList packages;
+    bool upgrade;             // atualizar todos os pacotes instalados
+    QVector<FileEdit> edits;
+    QStringList commands;
+    QVector<ServiceAction> services;
+    
+    Remediation() : upgrade(false) {}
+    bool isEmpty() const {
+        return packages.isEmpty() && !upgrade && edits.isEmpty() && commands.isEmpty() && services.isEmpty();
+    }
 };
 
 struct VulnerabilityDefinition {
@@ -25,12 +64,25 @@ struct VulnerabilityDefinition {
     QString impact;
     Severity severity;
     QString fix;
+    Remediation remediation;         // vazio = executar "fix" como está
+    QSharedPointer<const CheckExpression> check;   // nulo = sem verificação declarada
+    QByteArray checkDigest;          // hash do "check" declarado, invalida resultados em cache
+    QStringList dependsOn;           // regras que devem ser avaliadas antes desta
+    QHash<QString, bool> skipIf;     // id -> resultado (vulnerável?) que torna esta regra não aplicável
+    QStringList tags;                // "tags" do catálogo, para filtrar (ex.: "ssh", "cis-5.2")
+    QSharedPointer<const Applicability> applicability;   // nulo = vale para todo o sistema operacional
+    int checkTimeoutMs;   // 0 = usar o limite padrão do SystemChecker
+    int fixTimeoutMs;
+    
+    VulnerabilityDefinition() : severity(Severity::Media), checkTimeoutMs(0), fixTimeoutMs(0) {}
 };
 
 struct CheckResult {
     QString id;
     CheckStatus status;
     bool isVulnerable;
+    QString evidence;     // saída do comando (início e final) ou fatos observados
+    QString fixLog;       // saída dos passos de correção
     
     CheckResult() : status(CheckStatus::Pending), isVulnerable(false) {}
 };
@@ -7,6 +7,11 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include "VulnerabilityDefinition.h"
+#include "RuleCatalog.h"
+
+class QFileSystemWatcher;
+class QThread;
+class QTimer;
 
 class VulnerabilityManager : public QObject
 {
@@ -14,17 +19,44 @@ class VulnerabilityManager : public QObject
 
 public:
     explicit VulnerabilityManager(QObject *parent = nullptr);
+    ~VulnerabilityManager();
     
+    // Lê e publica o catálogo; em caso de erro o catálogo anterior continua ativo
     bool loadDefinitions(const QString &filePath);
-    QVector<VulnerabilityDefinition> getDefinitionsForOS(const QString &os) const;
+    QVector<VulnerabilityDefinition> getDefinitionsForOS(const QString &os, RuleText fields = RuleText::Full) const;
     QStringList getSupportedOS() const;
     QString getCurrentOS() const;
+    
+    RuleCatalogPtr catalog() const;
+    
+    // Observa o arquivo carregado por último. Alterações (inclusive substituição
+    // por rename) são validadas e interpretadas numa thread separada e, se
+    // válidas, publicadas como um novo catálogo
+    void watchDefinitions();
+    void stopWatching();
+    
+    static const int RELOAD_DEBOUNCE_MS;
+
+signals:
+    void definitionsReloaded();
+    void reloadFailed(const QString &error);
+
+private slots:
+    void onWatchedPathChanged();
+    void startReload();
+    void onReloadFinished();
 
 private:
-    QJsonDocument m_definitions;
+    RuleCatalogPtr m_catalog;
+    QString m_path;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_reloadDebounce;
+    QThread *m_reloadThread;
+    bool m_reloadAgain;
     
-    Severity stringToSeverity(const QString &severityStr) const;
-    QString severityToString(Severity severity) const;
+    // Resultado da thread de recarga, lido só depois de "finished"
+    RuleCatalogPtr m_reloadResult;
+    QString m_reloadError;
 };
 
-#endif // VULNERABILITYMANAGER_H
\ No newline at end of file
+#endif // VULNERABILITYMANAGER_H
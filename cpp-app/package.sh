@@ -49,6 +49,9 @@ mkdir -p "$DIST_DIR"
 # Copiar executável
 echo "📋 Copiando executável..."
 cp "$EXECUTABLE" "$DIST_DIR/"
+if [[ -f "$BUILD_DIR/SecurityCheckerScan$EXT" ]]; then
+    cp "$BUILD_DIR/SecurityCheckerScan$EXT" "$DIST_DIR/"
+fi
 
 # Copiar arquivos de dados
 echo "📋 Copiando arquivos de dados..."
@@ -116,6 +119,7 @@ INSTRUÇÕES DE USO:
 ARQUIVOS INCLUSOS:
 ==================
 - SecurityChecker: Executável principal
+- SecurityCheckerScan: Varredura sem interface gráfica (cron, servidores)
 - vulnerabilities.json: Definições de vulnerabilidades
 - run.sh: Script de execução (Linux/macOS)
 - README.md: Documentação completa
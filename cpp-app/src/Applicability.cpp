@@ -0,0 +1,135 @@
+#include "Applicability.h"
+#include "PlatformFingerprint.h"
+#include "PackageInventory.h"
+#include "SystemFacts.h"
+#include <QJsonObject>
+#include <QJsonArray>
+
+// Aceita "x" ou ["x", "y"]
+static bool readList(const QJsonObject &obj, const QString &key, QStringList *list, QString *error)
+{
+    const QJsonValue value = obj.value(key);
+    if (value.isUndefined()) {
+        return true;
+    }
+    if (value.isString()) {
+        list->append(value.toString());
+        return true;
+    }
+    if (!value.isArray()) {
+        *error = QString("\"%1\" deve ser texto ou lista").arg(key);
+        return false;
+    }
+    for (const QJsonValue &item : value.toArray()) {
+        if (!item.isString() || item.toString().isEmpty()) {
+            *error = QString("\"%1\" deve conter apenas textos").arg(key);
+            return false;
+        }
+        list->append(item.toString());
+    }
+    return true;
+}
+
+QSharedPointer<const Applicability> Applicability::fromJson(const QJsonValue &value, QString *error)
+{
+    if (!value.isObject()) {
+        *error = "deve ser um objeto";
+        return QSharedPointer<const Applicability>();
+    }
+    
+    static const QStringList KNOWN_KEYS = {
+        "distro", "version", "package_manager", "init", "container", "binaries"
+    };
+    const QJsonObject obj = value.toObject();
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        if (!KNOWN_KEYS.contains(it.key())) {
+            *error = QString("condição desconhecida: %1").arg(it.key());
+            return QSharedPointer<const Applicability>();
+        }
+    }
+    
+    QSharedPointer<Applicability> applicability(new Applicability);
+    if (!readList(obj, "distro", &applicability->distros, error)
+        || !readList(obj, "package_manager", &applicability->packageManagers, error)
+        || !readList(obj, "init", &applicability->initSystems, error)
+        || !readList(obj, "binaries", &applicability->binaries, error)) {
+        return QSharedPointer<const Applicability>();
+    }
+    
+    // "version": {"min": "11", "max": "12"}, limites inclusivos e opcionais
+    if (obj.contains("version")) {
+        const QJsonObject range = obj["version"].toObject();
+        applicability->minVersion = range["min"].toString();
+        applicability->maxVersion = range["max"].toString();
+        if (applicability->minVersion.isEmpty() && applicability->maxVersion.isEmpty()) {
+            *error = "\"version\" deve ter \"min\" ou \"max\"";
+            return QSharedPointer<const Applicability>();
+        }
+    }
+    
+    if (obj.contains("container")) {
+        if (!obj["container"].isBool()) {
+            *error = "\"container\" deve ser true ou false";
+            return QSharedPointer<const Applicability>();
+        }
+        applicability->container = obj["container"].toBool() ? 1 : 0;
+    }
+    
+    return applicability;
+}
+
+bool Applicability::matches(const PlatformFingerprint &platform, const QString &root, QString *reason) const
+{
+    auto fail = [reason](const QString &why) {
+        if (reason) {
+            *reason = why;
+        }
+        return false;
+    };
+    
+    if (!distros.isEmpty() && !platform.distroId.isEmpty()) {
+        bool found = distros.contains(platform.distroId);
+        for (const QString &like : platform.distroLike) {
+            found = found || distros.contains(like);
+        }
+        if (!found) {
+            return fail(QString("distribuição %1").arg(platform.distroId));
+        }
+    }
+    
+    if (!platform.versionId.isEmpty()) {
+        if (!minVersion.isEmpty() && PackageInventory::compareDebianVersions(platform.versionId, minVersion) < 0) {
+            return fail(QString("versão %1 anterior a %2").arg(platform.versionId, minVersion));
+        }
+        if (!maxVersion.isEmpty() && PackageInventory::compareDebianVersions(platform.versionId, maxVersion) > 0) {
+            return fail(QString("versão %1 posterior a %2").arg(platform.versionId, maxVersion));
+        }
+    }
+    
+    if (!packageManagers.isEmpty() && !platform.packageManager.isEmpty()
+        && !packageManagers.contains(platform.packageManager)) {
+        return fail(QString("gerenciador de pacotes %1").arg(platform.packageManager));
+    }
+    
+    if (!initSystems.isEmpty() && !platform.initSystem.isEmpty()
+        && !initSystems.contains(platform.initSystem)) {
+        return fail(QString("sistema de init %1").arg(platform.initSystem));
+    }
+    
+    // Uma raiz montada não diz se vai rodar em contêiner
+    if (container >= 0 && root.isEmpty()) {
+        const bool inContainer = !platform.container.isEmpty();
+        if (inContainer != (container == 1)) {
+            return fail(inContainer ? QString("em contêiner (%1)").arg(platform.container)
+                                    : QString("fora de contêiner"));
+        }
+    }
+    
+    for (const QString &binary : binaries) {
+        if (!SystemFacts::findBinary(root, binary)) {
+            return fail(QString("%1 não encontrado").arg(binary));
+        }
+    }
+    
+    return true;
+}
@@ -0,0 +1,451 @@
+#include "CheckExpression.h"
+#include "PackageInventory.h"
+#include <QJsonObject>
+#include <QJsonArray>
+
+CheckExpression::CheckExpression()
+    : m_type(Type::Shell)
+    , m_isDirectory(false)
+    , m_exposedOnly(false)
+    , m_port(0)
+    , m_match(Match::Any)
+    , m_mode(-1)
+    , m_modeMask(07777)
+{
+}
+
+QSharedPointer<const CheckExpression> CheckExpression::fromJson(const QJsonValue &value, QString *error)
+{
+    return parse(value, error);
+}
+
+QSharedPointer<CheckExpression> CheckExpression::parse(const QJsonValue &value, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return QSharedPointer<CheckExpression>();
+    };
+    
+    if (!value.isObject()) {
+        return fail("expressão de verificação deve ser um objeto");
+    }
+    
+    const QJsonObject obj = value.toObject();
+    QSharedPointer<CheckExpression> expr(new CheckExpression());
+    
+    // Combinadores
+    if (obj.contains("all") || obj.contains("any")) {
+        expr->m_type = obj.contains("all") ? Type::All : Type::Any;
+        const QJsonArray items = obj.value(obj.contains("all") ? "all" : "any").toArray();
+        if (items.isEmpty()) {
+            return fail("\"all\"/\"any\" exige uma lista não vazia");
+        }
+        for (const QJsonValue &item : items) {
+            QSharedPointer<const CheckExpression> child = parse(item, error);
+            if (!child) {
+                return QSharedPointer<CheckExpression>();
+            }
+            // Shell é uma válvula de escape para a regra inteira, não um operando
+            if (child->m_type == Type::Shell) {
+                return fail("\"shell\" só pode ser usado como verificação completa");
+            }
+            expr->m_children.append(child);
+        }
+        return expr;
+    }
+    
+    if (obj.contains("not")) {
+        expr->m_type = Type::Not;
+        QSharedPointer<const CheckExpression> child = parse(obj.value("not"), error);
+        if (!child) {
+            return QSharedPointer<CheckExpression>();
+        }
+        if (child->m_type == Type::Shell) {
+            return fail("\"shell\" só pode ser usado como verificação completa");
+        }
+        expr->m_children.append(child);
+        return expr;
+    }
+    
+    // Primitivas
+    const QString type = obj.value("type").toString();
+    
+    if (type == "file_exists") {
+        expr->m_type = Type::FileExists;
+        expr->m_path = obj.value("path").toString();
+    }
+    else if (type == "file_matches") {
+        expr->m_type = Type::FileMatches;
+        expr->m_isDirectory = obj.contains("directory");
+        expr->m_path = obj.value(expr->m_isDirectory ? "directory" : "path").toString();
+        
+        // Arquivos de configuração são avaliados linha a linha: ^ e $ casam em cada linha
+        QRegularExpression::PatternOptions options = QRegularExpression::MultilineOption;
+        if (obj.value("ignore_case").toBool()) {
+            options |= QRegularExpression::CaseInsensitiveOption;
+        }
+        expr->m_pattern = QRegularExpression(obj.value("pattern").toString(), options);
+        if (!expr->m_pattern.isValid()) {
+            return fail(QString("expressão regular inválida: %1").arg(expr->m_pattern.errorString()));
+        }
+        expr->m_pattern.optimize();
+        
+        // "capture": o primeiro grupo de alguma ocorrência (ou da primeira, ou
+        // de todas, conforme "match") precisa ser igual ao valor
+        expr->m_value = obj.value("capture").toString();
+        if (!expr->m_value.isEmpty() && expr->m_pattern.captureCount() < 1) {
+            return fail("\"capture\" exige um grupo de captura em \"pattern\"");
+        }
+        const QString match = obj.value("match").toString("any");
+        if (match == "first") {
+            expr->m_match = Match::First;
+        } else if (match == "all") {
+            expr->m_match = Match::All;
+        } else if (match != "any") {
+            return fail(QString("\"match\" desconhecido: %1").arg(match));
+        }
+        if (expr->m_match != Match::Any && expr->m_value.isEmpty()) {
+            return fail("\"match\" exige \"capture\"");
+        }
+    }
+    else if (type == "file_mode") {
+        expr->m_type = Type::FileMode;
+        expr->m_path = obj.value("path").toString();
+        bool ok = false;
+        expr->m_mode = obj.value("mode").toString().toInt(&ok, 8);
+        if (!ok) {
+            return fail("\"mode\" deve ser um valor octal, ex.: \"644\"");
+        }
+        // "mask" compara só alguns bits: {"mode": "0", "mask": "022"} = sem escrita para grupo e outros
+        if (obj.contains("mask")) {
+            expr->m_modeMask = obj.value("mask").toString().toInt(&ok, 8);
+            if (!ok || (expr->m_mode & ~expr->m_modeMask) != 0) {
+                return fail("\"mask\" deve ser octal e conter todos os bits de \"mode\"");
+            }
+        }
+    }
+    else if (type == "binary_exists") {
+        expr->m_type = Type::BinaryExists;
+        expr->m_path = obj.value("name").toString();
+    }
+    else if (type == "service_active") {
+        expr->m_type = Type::ServiceActive;
+        expr->m_path = obj.value("name").toString();
+    }
+    else if (type == "service_enabled") {
+        expr->m_type = Type::ServiceEnabled;
+        expr->m_path = obj.value("name").toString();
+    }
+    else if (type == "package_installed") {
+        expr->m_type = Type::PackageInstalled;
+        expr->m_path = obj.value("name").toString();
+    }
+    else if (type == "package_upgradable") {
+        // "name" é uma expressão regular, ex.: "^linux-image-"
+        expr->m_type = Type::PackageUpgradable;
+        expr->m_path = obj.value("name").toString();
+        if (!QRegularExpression(expr->m_path).isValid()) {
+            return fail("\"name\" de package_upgradable deve ser uma expressão regular válida");
+        }
+    }
+    else if (type == "package_version") {
+        // Instalado com versão anterior a "below" (ordem do dpkg; vale para o evr do rpm)
+        expr->m_type = Type::PackageVersion;
+        expr->m_path = obj.value("name").toString();
+        expr->m_value = obj.value("below").toString();
+        if (expr->m_value.isEmpty()) {
+            return fail("\"package_version\" exige \"below\"");
+        }
+    }
+    else if (type == "port_listening") {
+        // "protocol" opcional (tcp ou udp); "exposed" ignora sockets só em loopback
+        expr->m_type = Type::PortListening;
+        const int port = obj.value("port").toInt();
+        if (port < 1 || port > 65535) {
+            return fail("\"port\" deve estar entre 1 e 65535");
+        }
+        expr->m_port = static_cast<quint16>(port);
+        expr->m_value = obj.value("protocol").toString();
+        if (!expr->m_value.isEmpty() && expr->m_value != "tcp" && expr->m_value != "udp") {
+            return fail("\"protocol\" deve ser \"tcp\" ou \"udp\"");
+        }
+        expr->m_exposedOnly = obj.value("exposed").toBool();
+        expr->m_path = QString::number(port) + (expr->m_value.isEmpty() ? QString() : "/" + expr->m_value);
+    }
+    else if (type == "sysctl") {
+        expr->m_type = Type::Sysctl;
+        expr->m_path = obj.value("key").toString();
+        expr->m_value = obj.value("value").toString();
+    }
+    else if (type == "shell") {
+        expr->m_type = Type::Shell;
+        expr->m_value = obj.value("command").toString();
+        if (expr->m_value.isEmpty()) {
+            return fail("\"shell\" exige \"command\"");
+        }
+        return expr;
+    }
+    else {
+        return fail(QString("tipo de verificação desconhecido: \"%1\"").arg(type));
+    }
+    
+    if (expr->m_path.isEmpty()) {
+        return fail(QString("verificação \"%1\" sem alvo").arg(type));
+    }
+    
+    return expr;
+}
+
+CheckExpression::Type CheckExpression::type() const
+{
+    return m_type;
+}
+
+bool CheckExpression::isShell() const
+{
+    return m_type == Type::Shell;
+}
+
+QString CheckExpression::shellCommand() const
+{
+    return m_type == Type::Shell ? m_value : QString();
+}
+
+FactRequirements CheckExpression::requirements() const
+{
+    FactRequirements req;
+    collectRequirements(req);
+    return req;
+}
+
+void CheckExpression::collectRequirements(FactRequirements &req) const
+{
+    auto add = [](QStringList &list, const QString &item) {
+        if (!list.contains(item)) {
+            list.append(item);
+        }
+    };
+    
+    switch (m_type) {
+        case Type::All:
+        case Type::Any:
+        case Type::Not:
+            for (const auto &child : m_children) {
+                child->collectRequirements(req);
+            }
+            break;
+        case Type::FileExists:
+        case Type::FileMode:
+            add(req.files, m_path);
+            break;
+        case Type::FileMatches:
+            add(m_isDirectory ? req.directories : req.files, m_path);
+            break;
+        case Type::BinaryExists:
+            add(req.binaries, m_path);
+            break;
+        case Type::ServiceActive:
+        case Type::ServiceEnabled:
+            add(req.services, m_path);
+            break;
+        case Type::PackageInstalled:
+        case Type::PackageVersion:
+            add(req.packages, m_path);
+            break;
+        case Type::PackageUpgradable:
+            add(req.upgradable, m_path);
+            break;
+        case Type::PortListening:
+            add(req.ports, m_path);
+            break;
+        case Type::Sysctl:
+            add(req.files, "/proc/sys/" + QString(m_path).replace('.', '/'));
+            break;
+        case Type::Shell:
+            break;
+    }
+}
+
+QString CheckExpression::evidence(const SystemFacts &facts) const
+{
+    QStringList lines;
+    collectEvidence(facts, lines);
+    lines.removeDuplicates();
+    return lines.join('\n');
+}
+
+void CheckExpression::collectEvidence(const SystemFacts &facts, QStringList &lines) const
+{
+    switch (m_type) {
+        case Type::All:
+        case Type::Any:
+        case Type::Not:
+            for (const auto &child : m_children) {
+                child->collectEvidence(facts, lines);
+            }
+            break;
+        case Type::FileExists:
+            lines.append(m_path + (facts.fileExists(m_path) ? ": existe" : ": não existe"));
+            break;
+        case Type::FileMatches: {
+            // A primeira linha que casa em cada arquivo
+            const QStringList files = m_isDirectory ? facts.filesInDirectory(m_path) : QStringList(m_path);
+            bool matched = false;
+            for (const QString &file : files) {
+                const QString content = QString::fromUtf8(facts.fileContent(file));
+                const QRegularExpressionMatch match = m_pattern.match(content);
+                if (!match.hasMatch()) {
+                    continue;
+                }
+                const int start = content.lastIndexOf('\n', match.capturedStart()) + 1;
+                int end = content.indexOf('\n', match.capturedStart());
+                if (end == -1) {
+                    end = content.size();
+                }
+                lines.append(file + ": " + content.mid(start, end - start).trimmed());
+                matched = true;
+            }
+            if (!matched) {
+                const bool missing = m_isDirectory ? files.isEmpty() : !facts.fileExists(m_path);
+                lines.append(m_path + (missing ? ": não existe" : ": nenhuma linha casa com o padrão"));
+            }
+            break;
+        }
+        case Type::FileMode: {
+            const int mode = facts.fileMode(m_path);
+            lines.append(m_path + (mode < 0 ? ": não existe" : ": modo " + QString::number(mode, 8).rightJustified(4, '0')));
+            break;
+        }
+        case Type::BinaryExists:
+            lines.append(m_path + (facts.hasBinary(m_path) ? ": encontrado" : ": não encontrado"));
+            break;
+        case Type::ServiceActive:
+            lines.append(m_path + (facts.isServiceActive(m_path) ? ": ativo" : ": inativo"));
+            break;
+        case Type::ServiceEnabled:
+            lines.append(m_path + (facts.isServiceEnabled(m_path) ? ": habilitado" : ": não habilitado"));
+            break;
+        case Type::PackageInstalled:
+        case Type::PackageVersion: {
+            const QVector<PackageRecord> instances = facts.packages().instances(m_path);
+            if (instances.isEmpty()) {
+                lines.append(m_path + ": não instalado");
+            }
+            for (const PackageRecord &instance : instances) {
+                lines.append(QString("%1 %2 (%3)").arg(m_path, instance.version, instance.architecture));
+            }
+            break;
+        }
+        case Type::PackageUpgradable: {
+            const QStringList packages = facts.packages().upgradable(m_path);
+            lines.append(packages.isEmpty() ? "Nenhuma atualização para " + m_path
+                                            : "Atualizações disponíveis: " + packages.join(", "));
+            break;
+        }
+        case Type::PortListening:
+            lines.append(m_path + (facts.isPortListening(m_port, m_value, m_exposedOnly) ? ": em escuta" : ": fechada"));
+            break;
+        case Type::Sysctl: {
+            const QString path = "/proc/sys/" + QString(m_path).replace('.', '/');
+            lines.append(m_path + (facts.fileExists(path)
+                                   ? " = " + QString::fromUtf8(facts.fileContent(path)).simplified()
+                                   : ": não existe"));
+            break;
+        }
+        case Type::Shell:
+            break;
+    }
+}
+
+bool CheckExpression::evaluate(const SystemFacts &facts) const
+{
+    switch (m_type) {
+        case Type::All:
+            for (const auto &child : m_children) {
+                if (!child->evaluate(facts)) return false;
+            }
+            return true;
+        case Type::Any:
+            for (const auto &child : m_children) {
+                if (child->evaluate(facts)) return true;
+            }
+            return false;
+        case Type::Not:
+            return !m_children.first()->evaluate(facts);
+        case Type::FileExists:
+            return facts.fileExists(m_path);
+        case Type::FileMatches: {
+            QStringList files;
+            if (m_isDirectory) {
+                // "first" depende da ordem: a dos nomes, como nos *.d lidos pelos serviços
+                files = facts.filesInDirectory(m_path);
+                files.sort();
+            } else {
+                files.append(m_path);
+            }
+            bool found = false;
+            for (const QString &file : files) {
+                const QString content = QString::fromUtf8(facts.fileContent(file));
+                if (m_value.isEmpty()) {
+                    if (m_pattern.match(content).hasMatch()) {
+                        return true;
+                    }
+                    continue;
+                }
+                QRegularExpressionMatchIterator it = m_pattern.globalMatch(content);
+                while (it.hasNext()) {
+                    const bool equal = it.next().captured(1) == m_value;
+                    switch (m_match) {
+                        case Match::Any:
+                            if (equal) return true;
+                            break;
+                        case Match::First:
+                            return equal;
+                        case Match::All:
+                            if (!equal) return false;
+                            found = true;
+                            break;
+                    }
+                }
+            }
+            return found;
+        }
+        case Type::FileMode: {
+            const int mode = facts.fileMode(m_path);
+            return mode >= 0 && (mode & m_modeMask) == m_mode;
+        }
+        case Type::BinaryExists:
+            return facts.hasBinary(m_path);
+        case Type::ServiceActive:
+            return facts.isServiceActive(m_path);
+        case Type::ServiceEnabled:
+            return facts.isServiceEnabled(m_path);
+        case Type::PackageInstalled:
+            return facts.isPackageInstalled(m_path);
+        case Type::PackageUpgradable:
+            return facts.hasPackageUpdate(m_path);
+        case Type::PackageVersion: {
+            // Várias instâncias (multiarch, kernels antigos): basta uma abaixo do limite
+            const QVector<PackageRecord> instances = facts.packages().instances(m_path);
+            for (const PackageRecord &instance : instances) {
+                if (PackageInventory::compareDebianVersions(instance.version, m_value) < 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        case Type::PortListening:
+            return facts.isPortListening(m_port, m_value, m_exposedOnly);
+        case Type::Sysctl: {
+            const QString path = "/proc/sys/" + QString(m_path).replace('.', '/');
+            return facts.fileExists(path)
+                   && QString::fromUtf8(facts.fileContent(path)).simplified() == m_value.simplified();
+        }
+        case Type::Shell:
+            break;
+    }
+    
+    return false;
+}
@@ -0,0 +1,521 @@
+#include "HeadlessScanner.h"
+#include "PlatformFingerprint.h"
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QTimer>
+#include <QDebug>
+
+const int HeadlessScanner::DEFAULT_WATCH_INTERVAL_S = 300;
+
+HeadlessScanner::HeadlessScanner(QObject *parent)
+    : QObject(parent)
+    , m_vulnerabilityManager(new VulnerabilityManager(this))
+    , m_systemChecker(new SystemChecker(this))
+    , m_rulesPath(QCoreApplication::applicationDirPath() + "/vulnerabilities.json")
+    , m_format(OutputFormat::Json)
+    , m_exitCode(ExitClean)
+    , m_watch(false)
+    , m_initialScanDone(false)
+    , m_reloadPending(false)
+    , m_watcher(new RuleWatcher(this))
+    , m_pollTimer(new QTimer(this))
+    , m_jobs(0)
+{
+    connect(m_systemChecker, &SystemChecker::checkCompleted,
+            this, &HeadlessScanner::onCheckCompleted);
+    connect(m_systemChecker, &SystemChecker::checkTimedOut,
+            this, &HeadlessScanner::onCheckTimedOut);
+    connect(m_systemChecker, &SystemChecker::checkNotApplicable,
+            this, &HeadlessScanner::onCheckNotApplicable);
+    connect(m_systemChecker, &SystemChecker::allChecksCompleted,
+            this, &HeadlessScanner::onAllChecksCompleted);
+    connect(m_systemChecker, &SystemChecker::errorOccurred,
+            this, &HeadlessScanner::onErrorOccurred);
+    connect(m_watcher, &RuleWatcher::rulesChanged,
+            this, &HeadlessScanner::onRulesChanged);
+    connect(m_pollTimer, &QTimer::timeout,
+            this, &HeadlessScanner::onPollTimeout);
+    connect(m_vulnerabilityManager, &VulnerabilityManager::definitionsReloaded,
+            this, &HeadlessScanner::onDefinitionsReloaded);
+    
+    m_pollTimer->setInterval(DEFAULT_WATCH_INTERVAL_S * 1000);
+}
+
+void HeadlessScanner::setRulesPath(const QString &path)
+{
+    m_rulesPath = path;
+}
+
+void HeadlessScanner::setOutputFormat(OutputFormat format)
+{
+    m_format = format;
+}
+
+void HeadlessScanner::setFullScan(bool fullScan)
+{
+    m_systemChecker->setIncremental(!fullScan);
+}
+
+void HeadlessScanner::setWatchMode(bool enabled, int intervalSeconds)
+{
+    m_watch = enabled;
+    m_pollTimer->setInterval(qMax(1, intervalSeconds) * 1000);
+}
+
+void HeadlessScanner::setRoots(const QStringList &roots)
+{
+    m_roots = roots;
+}
+
+void HeadlessScanner::setJobs(int jobs)
+{
+    m_jobs = jobs;
+}
+
+void HeadlessScanner::setMetricsPath(const QString &path)
+{
+    m_metricsPath = path;
+}
+
+int HeadlessScanner::exitCode() const
+{
+    return m_exitCode;
+}
+
+void HeadlessScanner::start()
+{
+    if (!m_vulnerabilityManager->loadDefinitions(m_rulesPath)) {
+        qCritical().noquote() << "Não foi possível carregar as definições de vulnerabilidades:" << m_rulesPath;
+        finish(ExitError);
+        return;
+    }
+    
+    // Raízes montadas são sempre Linux, independente do sistema que as varre
+    m_currentOS = m_roots.isEmpty() ? m_vulnerabilityManager->getCurrentOS() : QString("linux");
+    // O relatório só usa id e nome: descrição, impacto e correção ficam no catálogo
+    m_catalog = m_vulnerabilityManager->catalog();
+    m_rules = m_catalog->rules(m_currentOS, RuleText::Summary);
+    if (m_rules.isEmpty()) {
+        qCritical().noquote() << "Nenhuma regra para o sistema" << m_currentOS;
+        finish(ExitError);
+        return;
+    }
+    
+    if (!m_roots.isEmpty()) {
+        if (!m_metricsPath.isEmpty()) {
+            qWarning() << "--metrics não se aplica a --root; nenhuma métrica será gravada";
+        }
+        scanRoots();
+        return;
+    }
+    
+    if (!m_systemChecker->isRunningAsAdmin()) {
+        qWarning() << "Executando sem privilégios de administrador; algumas verificações podem falhar";
+    }
+    
+    m_results.clear();
+    for (const VulnerabilityDefinition &rule : m_rules) {
+        CheckResult result;
+        result.id = rule.id;
+        result.status = CheckStatus::Checking;
+        m_results.insert(rule.id, result);
+    }
+    
+    m_metrics.setRules(m_rules);
+    m_scanTimer.start();
+    m_systemChecker->beginScan(m_rules);
+    m_systemChecker->checkAll(m_rules);
+}
+
+void HeadlessScanner::onCheckCompleted(const QString &id, bool isVulnerable, const QString &evidence)
+{
+    updateResult(id, isVulnerable ? CheckStatus::Vulnerable : CheckStatus::Safe, evidence);
+}
+
+void HeadlessScanner::onCheckTimedOut(const QString &id, const QString &evidence)
+{
+    updateResult(id, CheckStatus::TimedOut, evidence);
+}
+
+void HeadlessScanner::onCheckNotApplicable(const QString &id)
+{
+    updateResult(id, CheckStatus::NotApplicable, QString());
+}
+
+void HeadlessScanner::updateResult(const QString &id, CheckStatus status, const QString &evidence)
+{
+    if (!m_results.contains(id)) {
+        return;
+    }
+    
+    CheckResult &result = m_results[id];
+    const CheckStatus previous = result.status;
+    result.status = status;
+    result.isVulnerable = (status == CheckStatus::Vulnerable);
+    result.evidence = evidence;
+    
+    m_metrics.setResult(id, status);
+    m_metrics.observeRuleDuration(id, m_systemChecker->checkDuration(id));
+    
+    if (m_initialScanDone && previous != status) {
+        const int index = m_catalog->indexOf(m_currentOS, id);
+        if (index >= 0) {
+            printTransition(m_rules[index], previous, result);
+        }
+    }
+}
+
+void HeadlessScanner::onErrorOccurred(const QString &error)
+{
+    qWarning().noquote() << error;
+}
+
+void HeadlessScanner::onAllChecksCompleted()
+{
+    // Reavaliações do modo de observação já foram reportadas uma a uma
+    if (m_initialScanDone) {
+        writeMetrics();
+        if (m_reloadPending) {
+            applyCatalog();
+        }
+        return;
+    }
+    
+    // Verificações que falharam não chegaram a um resultado
+    for (CheckResult &result : m_results) {
+        if (result.status == CheckStatus::Checking) {
+            result.status = CheckStatus::Pending;
+            m_metrics.setResult(result.id, CheckStatus::Pending);
+        }
+    }
+    writeMetrics();
+    
+    if (m_watch) {
+        m_exitCode = severityExitCode(m_results);
+        printReport();
+        startWatching();
+        m_vulnerabilityManager->watchDefinitions();
+        return;
+    }
+    
+    finish(severityExitCode(m_results));
+}
+
+void HeadlessScanner::scanRoots()
+{
+    OfflineScanner offline(m_rules);
+    offline.setMaxThreads(m_jobs);
+    
+    qDebug() << "Varrendo" << m_roots.size() << "raízes com até"
+             << qMin(offline.maxThreads(), m_roots.size()) << "em paralelo";
+    const QVector<RootScanResult> scans = offline.scan(m_roots);
+    
+    // O processo reflete a pior raiz; raiz inexistente conta como erro
+    QVector<int> exitCodes;
+    int worst = ExitClean;
+    for (const RootScanResult &scan : scans) {
+        const int code = scan.results.isEmpty() ? int(ExitError) : severityExitCode(scan.results);
+        exitCodes.append(code);
+        worst = qMax(worst, code);
+    }
+    m_exitCode = worst;
+    
+    if (m_format == OutputFormat::Json) {
+        printRootsJson(scans, exitCodes);
+    } else {
+        printRootsText(scans);
+    }
+    
+    QTimer::singleShot(0, this, [worst]() {
+        QCoreApplication::exit(worst);
+    });
+}
+
+void HeadlessScanner::startWatching()
+{
+    m_initialScanDone = true;
+    
+    // Sem inotify todas as regras ficam na reavaliação periódica
+    m_watcher->watch(m_rules);
+    if (!m_watcher->unwatchedRules().isEmpty()) {
+        qDebug() << m_watcher->unwatchedRules().size() << "regras reavaliadas a cada"
+                 << m_pollTimer->interval() / 1000 << "s";
+        m_pollTimer->start();
+    }
+}
+
+void HeadlessScanner::onRulesChanged(const QStringList &ids)
+{
+    m_scanTimer.start();
+    m_systemChecker->recheck(ids);
+}
+
+void HeadlessScanner::onPollTimeout()
+{
+    m_scanTimer.start();
+    m_systemChecker->recheck(m_watcher->unwatchedRules());
+}
+
+void HeadlessScanner::onDefinitionsReloaded()
+{
+    // Reavaliações em andamento terminam com as regras com que começaram
+    if (m_systemChecker->pendingCheckCount() > 0) {
+        m_reloadPending = true;
+        return;
+    }
+    applyCatalog();
+}
+
+void HeadlessScanner::applyCatalog()
+{
+    m_reloadPending = false;
+    
+    const RuleCatalogPtr catalog = m_vulnerabilityManager->catalog();
+    const QVector<VulnerabilityDefinition> rules = catalog->rules(m_currentOS, RuleText::Summary);
+    if (rules.isEmpty()) {
+        qWarning().noquote() << "Catálogo novo sem regras para" << m_currentOS << "; mantendo as regras atuais";
+        return;
+    }
+    
+    // Regras removidas saem do relatório; as novas entram como pendentes e
+    // aparecem como transição quando chegarem a um resultado
+    QHash<QString, CheckResult> results;
+    for (const VulnerabilityDefinition &rule : rules) {
+        CheckResult result = m_results.value(rule.id);
+        result.id = rule.id;
+        results.insert(rule.id, result);
+    }
+    qDebug() << "Catálogo recarregado:" << rules.size() << "regras; reavaliando";
+    
+    m_results = results;
+    m_catalog = catalog;
+    m_rules = rules;
+    m_metrics.setRules(m_rules);
+    m_pollTimer->stop();
+    startWatching();
+    
+    // Qualquer regra pode ter mudado; o cache de resultados poupa as nativas inalteradas
+    m_scanTimer.start();
+    m_systemChecker->beginScan(m_rules);
+    m_systemChecker->checkAll(m_rules);
+}
+
+void HeadlessScanner::writeMetrics()
+{
+    if (m_metricsPath.isEmpty()) {
+        return;
+    }
+    
+    m_metrics.observeScanDuration(m_scanTimer.nsecsElapsed() / 1e9);
+    m_metrics.setCounters(m_systemChecker->counters());
+    m_metrics.write(m_metricsPath);
+}
+
+void HeadlessScanner::printReport() const
+{
+    if (m_rules.isEmpty()) {
+        return;
+    }
+    
+    if (m_format == OutputFormat::Json) {
+        printJson();
+    } else {
+        printText();
+    }
+}
+
+void HeadlessScanner::printTransition(const VulnerabilityDefinition &rule, CheckStatus from,
+                                      const CheckResult &result) const
+{
+    const QString timestamp = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    QTextStream out(stdout);
+    
+    if (m_format == OutputFormat::Text) {
+        out << QString("%1\t%2\t%3 -> %4\t%5")
+                   .arg(timestamp, rule.id, statusName(from), statusName(result.status), rule.name)
+            << Qt::endl;
+        return;
+    }
+    
+    QJsonObject entry;
+    entry["timestamp"] = timestamp;
+    entry["id"] = rule.id;
+    entry["severity"] = severityName(rule.severity);
+    entry["from"] = statusName(from);
+    entry["to"] = statusName(result.status);
+    if (!result.evidence.isEmpty()) {
+        entry["evidence"] = result.evidence;
+    }
+    out << QJsonDocument(entry).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+void HeadlessScanner::finish(int exitCode)
+{
+    m_exitCode = exitCode;
+    printReport();
+    
+    // Sair pelo laço de eventos: start() pode ser chamado antes de exec()
+    QTimer::singleShot(0, this, [exitCode]() {
+        QCoreApplication::exit(exitCode);
+    });
+}
+
+int HeadlessScanner::severityExitCode(const QHash<QString, CheckResult> &results) const
+{
+    // Uma regra sem veredito torna a varredura inconclusiva: "nada encontrado"
+    // não pode sair de verificações que estouraram o tempo ou nem rodaram
+    int code = ExitClean;
+    for (const VulnerabilityDefinition &rule : m_rules) {
+        const CheckStatus status = results.value(rule.id).status;
+        if (status == CheckStatus::Pending || status == CheckStatus::Checking
+            || status == CheckStatus::TimedOut) {
+            return ExitError;
+        }
+    }
+    
+    for (const VulnerabilityDefinition &rule : m_rules) {
+        if (results.value(rule.id).status != CheckStatus::Vulnerable) {
+            continue;
+        }
+        
+        switch (rule.severity) {
+            case Severity::Alta:
+                return ExitHigh;
+            case Severity::Media:
+                code = qMax<int>(code, ExitMedium);
+                break;
+            case Severity::Baixa:
+                code = qMax<int>(code, ExitLow);
+                break;
+        }
+    }
+    return code;
+}
+
+QJsonArray HeadlessScanner::resultsJson(const QHash<QString, CheckResult> &checkResults, QJsonObject *summary) const
+{
+    QJsonArray results;
+    for (const VulnerabilityDefinition &rule : m_rules) {
+        const CheckResult result = checkResults.value(rule.id);
+        const QString status = statusName(result.status);
+        (*summary)[status] = (*summary)[status].toInt() + 1;
+        
+        QJsonObject entry;
+        entry["id"] = rule.id;
+        entry["name"] = rule.name;
+        entry["severity"] = severityName(rule.severity);
+        entry["status"] = status;
+        if (!result.evidence.isEmpty()) {
+            entry["evidence"] = result.evidence;
+        }
+        results.append(entry);
+    }
+    return results;
+}
+
+void HeadlessScanner::printJson() const
+{
+    QJsonObject summary;
+    const QJsonArray results = resultsJson(m_results, &summary);
+    
+    QJsonObject root;
+    root["host"] = QSysInfo::machineHostName();
+    root["os"] = m_currentOS;
+    root["platform"] = PlatformFingerprint::current().toJson();
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["exit_code"] = m_exitCode;
+    root["summary"] = summary;
+    root["results"] = results;
+    
+    // No modo de observação a saída é um fluxo de objetos JSON, um por linha
+    QTextStream out(stdout);
+    if (m_watch) {
+        out << QJsonDocument(root).toJson(QJsonDocument::Compact) << Qt::endl;
+    } else {
+        out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+    }
+}
+
+void HeadlessScanner::printRootsJson(const QVector<RootScanResult> &scans, const QVector<int> &exitCodes) const
+{
+    QJsonArray roots;
+    for (int i = 0; i < scans.size(); i++) {
+        QJsonObject summary;
+        QJsonObject entry;
+        entry["root"] = scans[i].root;
+        entry["platform"] = scans[i].platform.toJson();
+        entry["exit_code"] = exitCodes[i];
+        entry["results"] = resultsJson(scans[i].results, &summary);
+        entry["summary"] = summary;
+        roots.append(entry);
+    }
+    
+    QJsonObject report;
+    report["host"] = QSysInfo::machineHostName();
+    report["os"] = m_currentOS;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["exit_code"] = m_exitCode;
+    report["roots"] = roots;
+    
+    QTextStream out(stdout);
+    out << QJsonDocument(report).toJson(QJsonDocument::Indented);
+}
+
+void HeadlessScanner::printRootsText(const QVector<RootScanResult> &scans) const
+{
+    QTextStream out(stdout);
+    for (const RootScanResult &scan : scans) {
+        if (scan.results.isEmpty()) {
+            out << QString("%1	error").arg(scan.root) << Qt::endl;
+            continue;
+        }
+        for (const VulnerabilityDefinition &rule : m_rules) {
+            const CheckResult result = scan.results.value(rule.id);
+            out << QString("%1	%2	%3	%4	%5")
+                       .arg(scan.root, statusName(result.status), severityName(rule.severity), rule.id, rule.name)
+                << Qt::endl;
+        }
+    }
+}
+
+void HeadlessScanner::printText() const
+{
+    QTextStream out(stdout);
+    for (const VulnerabilityDefinition &rule : m_rules) {
+        const CheckResult result = m_results.value(rule.id);
+        out << QString("%1\t%2\t%3\t%4")
+                   .arg(statusName(result.status), severityName(rule.severity), rule.id, rule.name)
+            << Qt::endl;
+    }
+}
+
+QString HeadlessScanner::statusName(CheckStatus status)
+{
+    switch (status) {
+        case CheckStatus::Vulnerable: return "vulnerable";
+        case CheckStatus::Safe: return "safe";
+        case CheckStatus::Skipped: return "skipped";
+        case CheckStatus::Fixed: return "fixed";
+        case CheckStatus::TimedOut: return "timed_out";
+        case CheckStatus::NotApplicable: return "not_applicable";
+        case CheckStatus::Pending:
+        case CheckStatus::Checking:
+            break;
+    }
+    return "error";
+}
+
+QString HeadlessScanner::severityName(Severity severity)
+{
+    switch (severity) {
+        case Severity::Alta: return "high";
+        case Severity::Media: return "medium";
+        case Severity::Baixa: return "low";
+    }
+    return "medium";
+}
@@ -33,6 +33,16 @@ MainWindow::~MainWindow()
 {
 }
 
+void MainWindow::setFullScan(bool fullScan)
+{
+    m_securityChecker->setFullScan(fullScan);
+}
+
+void MainWindow::setMetricsPath(const QString &path)
+{
+    m_securityChecker->setMetricsPath(path);
+}
+
 void MainWindow::setupUI()
 {
     setWindowTitle("Security Checker - Verificador de Vulnerabilidades");
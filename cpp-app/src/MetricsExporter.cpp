@@ -0,0 +1,247 @@
+#include "MetricsExporter.h"
+#include "SystemChecker.h"
+#include "OllamaClient.h"
+#include <QSaveFile>
+#include <QDateTime>
+#include <QTextStream>
+#include <QDebug>
+
+// Limites dos histogramas, em segundos
+static const QVector<double> RULE_BUCKETS = { 0.001, 0.01, 0.1, 0.5, 1, 5, 30, 120 };
+static const QVector<double> SCAN_BUCKETS = { 1, 5, 15, 30, 60, 120, 300, 900 };
+static const QVector<double> OLLAMA_BUCKETS = { 1, 5, 15, 30, 60, 120, 300, 600 };
+
+// Valor de rótulo: barra invertida, aspas e quebra de linha escapadas
+static QString labelValue(const QString &value)
+{
+    QString escaped = value;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return '"' + escaped + '"';
+}
+
+static QString number(double value)
+{
+    return QString::number(value, 'g', 10);
+}
+
+static void writeHeader(QTextStream &out, const char *name, const char *type, const char *help)
+{
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+}
+
+MetricsExporter::Histogram::Histogram()
+    : count(0)
+    , sum(0)
+{
+}
+
+void MetricsExporter::Histogram::observe(double value, const QVector<double> &bounds)
+{
+    if (buckets.size() != bounds.size()) {
+        buckets.fill(0, bounds.size());
+    }
+    for (int i = 0; i < bounds.size(); i++) {
+        if (value <= bounds[i]) {
+            buckets[i]++;
+        }
+    }
+    count++;
+    sum += value;
+}
+
+// Série _bucket/_sum/_count; labels já formatados ("id=\"X\"") ou vazio
+static void writeHistogram(QTextStream &out, const char *name, const QString &labels,
+                           const QVector<quint64> &buckets, quint64 count, double sum,
+                           const QVector<double> &bounds)
+{
+    const QString prefix = labels.isEmpty() ? QString() : labels + ',';
+    for (int i = 0; i < bounds.size(); i++) {
+        out << name << "_bucket{" << prefix << "le=\"" << number(bounds[i]) << "\"} "
+            << (i < buckets.size() ? buckets[i] : 0) << '\n';
+    }
+    out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << count << '\n';
+    const QString suffix = labels.isEmpty() ? QString() : '{' + labels + '}';
+    out << name << "_sum" << suffix << ' ' << number(sum) << '\n';
+    out << name << "_count" << suffix << ' ' << count << '\n';
+}
+
+MetricsExporter::MetricsExporter()
+    : m_commands(0)
+    , m_timeouts(0)
+    , m_failures(0)
+    , m_ollamaRequests(0)
+    , m_promptTokens(0)
+    , m_responseTokens(0)
+    , m_lastScanTimestamp(0)
+{
+}
+
+void MetricsExporter::setRules(const QVector<VulnerabilityDefinition> &rules)
+{
+    m_order.clear();
+    QHash<QString, RuleState> previous = m_rules;
+    m_rules.clear();
+    
+    for (const VulnerabilityDefinition &rule : rules) {
+        // Histogramas de regras que continuam no catálogo são mantidos
+        RuleState state = previous.value(rule.id);
+        if (!previous.contains(rule.id)) {
+            state.status = CheckStatus::Pending;
+        }
+        state.severity = rule.severity;
+        m_rules.insert(rule.id, state);
+        m_order.append(rule.id);
+    }
+}
+
+void MetricsExporter::setResult(const QString &id, CheckStatus status)
+{
+    auto it = m_rules.find(id);
+    if (it != m_rules.end()) {
+        it->status = status;
+    }
+}
+
+void MetricsExporter::observeRuleDuration(const QString &id, double seconds)
+{
+    auto it = m_rules.find(id);
+    if (it != m_rules.end() && seconds >= 0) {
+        it->duration.observe(seconds, RULE_BUCKETS);
+    }
+}
+
+void MetricsExporter::observeScanDuration(double seconds)
+{
+    m_scanDuration.observe(seconds, SCAN_BUCKETS);
+    m_lastScanTimestamp = QDateTime::currentSecsSinceEpoch();
+}
+
+void MetricsExporter::setCounters(const ScanCounters &counters)
+{
+    m_commands = counters.commands;
+    m_timeouts = counters.timeouts;
+    m_failures = counters.failures;
+}
+
+void MetricsExporter::observeOllamaRequest(const OllamaUsage &usage)
+{
+    m_ollamaDuration.observe(usage.seconds, OLLAMA_BUCKETS);
+    m_ollamaRequests++;
+    m_promptTokens += quint64(qMax<qint64>(0, usage.promptTokens));
+    m_responseTokens += quint64(qMax<qint64>(0, usage.responseTokens));
+}
+
+QByteArray MetricsExporter::render() const
+{
+    QString text;
+    QTextStream out(&text);
+    
+    writeHeader(out, "securitychecker_rule_status", "gauge",
+                "Resultado da última verificação da regra (1 no estado atual)");
+    for (const QString &id : m_order) {
+        const RuleState &rule = m_rules[id];
+        out << "securitychecker_rule_status{id=" << labelValue(id)
+            << ",severity=" << labelValue(severityName(rule.severity))
+            << ",status=" << labelValue(statusName(rule.status)) << "} 1\n";
+    }
+    
+    writeHeader(out, "securitychecker_rule_vulnerable", "gauge",
+                "1 se a última verificação encontrou a vulnerabilidade");
+    for (const QString &id : m_order) {
+        const RuleState &rule = m_rules[id];
+        out << "securitychecker_rule_vulnerable{id=" << labelValue(id)
+            << ",severity=" << labelValue(severityName(rule.severity)) << "} "
+            << (rule.status == CheckStatus::Vulnerable ? 1 : 0) << '\n';
+    }
+    
+    writeHeader(out, "securitychecker_rule_duration_seconds", "histogram",
+                "Tempo de cada avaliação da regra, da saída da fila ao resultado");
+    for (const QString &id : m_order) {
+        const RuleState &rule = m_rules[id];
+        if (rule.duration.count == 0) {
+            continue;
+        }
+        writeHistogram(out, "securitychecker_rule_duration_seconds", "id=" + labelValue(id),
+                       rule.duration.buckets, rule.duration.count, rule.duration.sum, RULE_BUCKETS);
+    }
+    
+    writeHeader(out, "securitychecker_scan_duration_seconds", "histogram",
+                "Tempo de cada varredura ou reavaliação completa");
+    writeHistogram(out, "securitychecker_scan_duration_seconds", QString(), m_scanDuration.buckets,
+                   m_scanDuration.count, m_scanDuration.sum, SCAN_BUCKETS);
+    
+    writeHeader(out, "securitychecker_last_scan_timestamp_seconds", "gauge",
+                "Fim da última varredura, em segundos desde a época Unix");
+    out << "securitychecker_last_scan_timestamp_seconds " << m_lastScanTimestamp << '\n';
+    
+    writeHeader(out, "securitychecker_commands_total", "counter",
+                "Comandos de verificação e correção executados");
+    out << "securitychecker_commands_total " << m_commands << '\n';
+    writeHeader(out, "securitychecker_command_timeouts_total", "counter",
+                "Comandos encerrados por tempo limite");
+    out << "securitychecker_command_timeouts_total " << m_timeouts << '\n';
+    writeHeader(out, "securitychecker_command_failures_total", "counter",
+                "Comandos que não iniciaram ou terminaram de forma anormal");
+    out << "securitychecker_command_failures_total " << m_failures << '\n';
+    
+    if (m_ollamaRequests > 0) {
+        writeHeader(out, "securitychecker_ollama_request_duration_seconds", "histogram",
+                    "Latência das análises enviadas ao Ollama");
+        writeHistogram(out, "securitychecker_ollama_request_duration_seconds", QString(),
+                       m_ollamaDuration.buckets, m_ollamaDuration.count, m_ollamaDuration.sum, OLLAMA_BUCKETS);
+        writeHeader(out, "securitychecker_ollama_prompt_tokens_total", "counter",
+                    "Tokens de prompt avaliados pelo Ollama");
+        out << "securitychecker_ollama_prompt_tokens_total " << m_promptTokens << '\n';
+        writeHeader(out, "securitychecker_ollama_response_tokens_total", "counter",
+                    "Tokens gerados pelo Ollama");
+        out << "securitychecker_ollama_response_tokens_total " << m_responseTokens << '\n';
+    }
+    
+    out.flush();
+    return text.toUtf8();
+}
+
+bool MetricsExporter::write(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning().noquote() << "Não foi possível gravar as métricas:" << path;
+        return false;
+    }
+    file.write(render());
+    
+    // O node_exporter costuma rodar com outro usuário
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner
+                        | QFileDevice::ReadGroup | QFileDevice::ReadOther);
+    if (!file.commit()) {
+        qWarning().noquote() << "Não foi possível gravar as métricas:" << path;
+        return false;
+    }
+    return true;
+}
+
+QString MetricsExporter::statusName(CheckStatus status)
+{
+    switch (status) {
+        case CheckStatus::Vulnerable: return "vulnerable";
+        case CheckStatus::Safe: return "safe";
+        case CheckStatus::Skipped: return "skipped";
+        case CheckStatus::Fixed: return "fixed";
+        case CheckStatus::TimedOut: return "timed_out";
+        case CheckStatus::NotApplicable: return "not_applicable";
+        case CheckStatus::Pending: return "pending";
+        case CheckStatus::Checking: return "checking";
+    }
+    return "error";
+}
+
+QString MetricsExporter::severityName(Severity severity)
+{
+    switch (severity) {
+        case Severity::Alta: return "high";
+        case Severity::Media: return "medium";
+        case Severity::Baixa: return "low";
+    }
+    return "medium";
+}
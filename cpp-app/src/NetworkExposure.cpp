@@ -0,0 +1,349 @@
+#include "NetworkExposure.h"
+#include <QFile>
+#include <QHostAddress>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+// Estados do kernel: TCP_LISTEN para TCP; UDP sem conexão fica em TCP_CLOSE
+static const int STATE_TCP_LISTEN = 10;
+static const int STATE_UDP_UNCONNECTED = 7;
+#endif
+
+bool ListeningSocket::isLoopback() const
+{
+    return QHostAddress(address).isLoopback();
+}
+
+QString ListeningSocket::toString() const
+{
+    QString text = QString("%1 %2:%3").arg(protocol, address).arg(port);
+    if (pid > 0) {
+        text += QString(" %1[%2]").arg(process).arg(pid);
+    }
+    if (!unit.isEmpty()) {
+        text += " (" + unit + ")";
+    }
+    return text;
+}
+
+NetworkExposure::NetworkExposure()
+    : m_loaded(false)
+{
+}
+
+bool NetworkExposure::collect()
+{
+    clear();
+
+#ifdef Q_OS_LINUX
+    if (!collectNetlink()) {
+        qDebug() << "sock_diag indisponível, lendo /proc/net";
+        m_sockets.clear();
+        collectProcNet();
+    }
+    attributeProcesses();
+    m_loaded = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void NetworkExposure::clear()
+{
+    m_sockets.clear();
+    m_loaded = false;
+}
+
+bool NetworkExposure::isLoaded() const
+{
+    return m_loaded;
+}
+
+QVector<ListeningSocket> NetworkExposure::sockets() const
+{
+    return m_sockets;
+}
+
+bool NetworkExposure::isListening(quint16 port, const QString &protocol, bool exposedOnly) const
+{
+    for (const ListeningSocket &socket : m_sockets) {
+        if (socket.port != port) {
+            continue;
+        }
+        // "tcp" também casa com "tcp6"
+        if (!protocol.isEmpty() && !socket.protocol.startsWith(protocol)) {
+            continue;
+        }
+        if (exposedOnly && socket.isLoopback()) {
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+#ifdef Q_OS_LINUX
+static QString formatAddress(int family, const quint32 *words)
+{
+    if (family == AF_INET) {
+        return QHostAddress(ntohl(words[0])).toString();
+    }
+    
+    quint8 bytes[16];
+    memcpy(bytes, words, sizeof(bytes));
+    return QHostAddress(bytes).toString();
+}
+
+// Uma requisição SOCK_DIAG_BY_FAMILY por família/protocolo, já filtrada pelo
+// estado no kernel: o custo não cresce com as conexões estabelecidas
+static bool dumpInetSockets(int fd, int family, int protocol, QVector<ListeningSocket> &out)
+{
+    struct {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message;
+    memset(&message, 0, sizeof(message));
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request.sdiag_family = family;
+    message.request.sdiag_protocol = protocol;
+    message.request.idiag_states = 1u << (protocol == IPPROTO_TCP ? STATE_TCP_LISTEN : STATE_UDP_UNCONNECTED);
+    
+    sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(fd, &message, sizeof(message), 0, reinterpret_cast<sockaddr *>(&kernel), sizeof(kernel)) < 0) {
+        return false;
+    }
+    
+    const QString name = QString(protocol == IPPROTO_TCP ? "tcp" : "udp") + (family == AF_INET6 ? "6" : "");
+    alignas(nlmsghdr) char buffer[32768];
+    
+    while (true) {
+        ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        // Sem NLMSG_DONE, fim do fluxo (0) ou erro encerram o despejo como falha,
+        // e a coleta cai para /proc/net
+        if (length <= 0) {
+            return false;
+        }
+        
+        int remaining = static_cast<int>(length);
+        for (nlmsghdr *header = reinterpret_cast<nlmsghdr *>(buffer);
+             NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_type == NLMSG_DONE) {
+                return true;
+            }
+            if (header->nlmsg_type == NLMSG_ERROR) {
+                return false;
+            }
+            
+            const inet_diag_msg *diag = static_cast<const inet_diag_msg *>(NLMSG_DATA(header));
+            // UDP conectado também fica em TCP_CLOSE; em escuta é só quem não tem destino
+            if (protocol == IPPROTO_UDP && diag->id.idiag_dport != 0) {
+                continue;
+            }
+            
+            ListeningSocket socket;
+            socket.protocol = name;
+            socket.address = formatAddress(family, diag->id.idiag_src);
+            socket.port = ntohs(diag->id.idiag_sport);
+            socket.inode = diag->idiag_inode;
+            out.append(socket);
+        }
+    }
+}
+#endif
+
+bool NetworkExposure::collectNetlink()
+{
+#ifdef Q_OS_LINUX
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (fd < 0) {
+        return false;
+    }
+    
+    bool ok = dumpInetSockets(fd, AF_INET, IPPROTO_TCP, m_sockets)
+              && dumpInetSockets(fd, AF_INET6, IPPROTO_TCP, m_sockets)
+              && dumpInetSockets(fd, AF_INET, IPPROTO_UDP, m_sockets)
+              && dumpInetSockets(fd, AF_INET6, IPPROTO_UDP, m_sockets);
+    
+    close(fd);
+    return ok;
+#else
+    return false;
+#endif
+}
+
+void NetworkExposure::collectProcNet()
+{
+#ifdef Q_OS_LINUX
+    // Colunas: sl local_address rem_address st ... uid timeout inode
+    static const struct {
+        const char *path;
+        const char *protocol;
+        int family;
+        int listenState;
+    } tables[] = {
+        { "/proc/net/tcp", "tcp", AF_INET, STATE_TCP_LISTEN },
+        { "/proc/net/tcp6", "tcp6", AF_INET6, STATE_TCP_LISTEN },
+        { "/proc/net/udp", "udp", AF_INET, STATE_UDP_UNCONNECTED },
+        { "/proc/net/udp6", "udp6", AF_INET6, STATE_UDP_UNCONNECTED },
+    };
+    
+    for (const auto &table : tables) {
+        QFile file(table.path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        
+        file.readLine(); // cabeçalho
+        while (!file.atEnd()) {
+            const QList<QByteArray> fields = file.readLine().simplified().split(' ');
+            if (fields.size() < 10 || fields[3].toInt(nullptr, 16) != table.listenState) {
+                continue;
+            }
+            
+            const QList<QByteArray> local = fields[1].split(':');
+            const QList<QByteArray> remote = fields[2].split(':');
+            if (local.size() != 2 || remote.size() != 2) {
+                continue;
+            }
+            if (table.listenState == STATE_UDP_UNCONNECTED && remote[1].toUInt(nullptr, 16) != 0) {
+                continue;
+            }
+            
+            // O kernel imprime cada palavra de 32 bits na ordem do host: lida de
+            // volta como inteiro, a memória fica na ordem da rede, como no netlink
+            quint32 words[4] = { 0, 0, 0, 0 };
+            const QByteArray &hex = local[0];
+            for (int i = 0; i < 4 && (i + 1) * 8 <= hex.size(); i++) {
+                words[i] = hex.mid(i * 8, 8).toUInt(nullptr, 16);
+            }
+            
+            ListeningSocket socket;
+            socket.protocol = table.protocol;
+            socket.address = formatAddress(table.family, words);
+            socket.port = static_cast<quint16>(local[1].toUInt(nullptr, 16));
+            socket.inode = fields[9].toULongLong();
+            m_sockets.append(socket);
+        }
+    }
+#endif
+}
+
+void NetworkExposure::attributeProcesses()
+{
+#ifdef Q_OS_LINUX
+    QHash<quint64, int> byInode;
+    for (int i = 0; i < m_sockets.size(); i++) {
+        if (m_sockets[i].inode != 0) {
+            byInode.insert(m_sockets[i].inode, i);
+        }
+    }
+    if (byInode.isEmpty()) {
+        return;
+    }
+    
+    // Uma passada por /proc/*/fd: cada descritor de socket aponta para "socket:[inode]"
+    DIR *proc = opendir("/proc");
+    if (!proc) {
+        return;
+    }
+    
+    int remaining = byInode.size();
+    while (remaining > 0) {
+        dirent *entry = readdir(proc);
+        if (!entry) {
+            break;
+        }
+        char *end = nullptr;
+        long pid = strtol(entry->d_name, &end, 10);
+        if (pid <= 0 || *end != '\0') {
+            continue;
+        }
+        
+        const QByteArray fdPath = "/proc/" + QByteArray(entry->d_name) + "/fd";
+        DIR *fds = opendir(fdPath.constData());
+        if (!fds) {
+            continue; // processo terminou ou sem permissão
+        }
+        
+        // Sockets deste processo, preenchidos com os detalhes abaixo sem
+        // percorrer a lista inteira de novo
+        QVector<int> owned;
+        while (dirent *fdEntry = readdir(fds)) {
+            char target[64];
+            const QByteArray linkPath = fdPath + '/' + fdEntry->d_name;
+            ssize_t length = readlink(linkPath.constData(), target, sizeof(target) - 1);
+            if (length <= 8 || strncmp(target, "socket:[", 8) != 0) {
+                continue;
+            }
+            target[length] = '\0';
+            
+            const quint64 inode = strtoull(target + 8, nullptr, 10);
+            auto it = byInode.find(inode);
+            if (it == byInode.end()) {
+                continue;
+            }
+            
+            m_sockets[it.value()].pid = pid;
+            owned.append(it.value());
+            byInode.erase(it);
+            remaining--;
+        }
+        closedir(fds);
+        
+        if (owned.isEmpty()) {
+            continue;
+        }
+        
+        // Detalhes do processo só para quem possui algum socket em escuta
+        const QString base = "/proc/" + QString::number(pid);
+        QString process;
+        QFile comm(base + "/comm");
+        if (comm.open(QIODevice::ReadOnly)) {
+            process = QString::fromUtf8(comm.readAll()).trimmed();
+        }
+        const QString executable = QFile::symLinkTarget(base + "/exe");
+        
+        QString unit;
+        QFile cgroup(base + "/cgroup");
+        if (cgroup.open(QIODevice::ReadOnly)) {
+            const QList<QByteArray> segments = cgroup.readAll().split('/');
+            for (const QByteArray &segment : segments) {
+                const QByteArray name = segment.trimmed();
+                if (name.endsWith(".service")) {
+                    unit = QString::fromUtf8(name);
+                }
+            }
+        }
+        
+        for (int index : owned) {
+            ListeningSocket &socket = m_sockets[index];
+            socket.process = process;
+            socket.executable = executable;
+            socket.unit = unit;
+        }
+    }
+    
+    closedir(proc);
+#endif
+}
@@ -0,0 +1,140 @@
+#include "OfflineScanner.h"
+#include "CheckExpression.h"
+#include "Applicability.h"
+#include "SystemFacts.h"
+#include "TraceRecorder.h"
+#include <QThreadPool>
+#include <QThread>
+#include <QFileInfo>
+#include <QSet>
+#include <QDebug>
+
+OfflineScanner::OfflineScanner(const QVector<VulnerabilityDefinition> &rules)
+    : m_rules(rules)
+    , m_maxThreads(0)
+{
+}
+
+void OfflineScanner::setMaxThreads(int count)
+{
+    m_maxThreads = qMax(0, count);
+}
+
+int OfflineScanner::maxThreads() const
+{
+    return m_maxThreads > 0 ? m_maxThreads : QThread::idealThreadCount();
+}
+
+bool OfflineScanner::isOfflineCapable(const VulnerabilityDefinition &rule)
+{
+    return rule.check && !rule.check->isShell() && !rule.check->requirements().needsLiveSystem();
+}
+
+QVector<RootScanResult> OfflineScanner::scan(const QStringList &roots) const
+{
+    QVector<RootScanResult> results(roots.size());
+    
+    // Pool próprio: a fila compartilhada entrega a próxima raiz à primeira
+    // thread livre, então raízes grandes não seguram as pequenas
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMin(maxThreads(), qMax(1, roots.size())));
+    
+    for (int i = 0; i < roots.size(); i++) {
+        // Cada tarefa escreve só na sua posição do vetor
+        RootScanResult *slot = &results[i];
+        const QString root = roots.at(i);
+        pool.start([this, slot, root]() {
+            *slot = scanRoot(root);
+        });
+    }
+    pool.waitForDone();
+    
+    return results;
+}
+
+RootScanResult OfflineScanner::scanRoot(const QString &root) const
+{
+    TraceSpan span("offline", "scanRoot");
+    span.setArg("root", root);
+    
+    RootScanResult scan;
+    scan.root = root;
+    
+    if (!QFileInfo(root).isDir()) {
+        qWarning().noquote() << "Raiz inexistente:" << root;
+        return scan;
+    }
+    
+    // Fatos próprios por raiz: nada é compartilhado entre threads além das
+    // expressões, que são imutáveis
+    SystemFacts facts;
+    facts.setRoot(root);
+    scan.platform = PlatformFingerprint::detect(root);
+    
+    FactRequirements requirements;
+    QSet<QString> pending;
+    for (const VulnerabilityDefinition &rule : m_rules) {
+        CheckResult result;
+        result.id = rule.id;
+        const bool applies = !rule.applicability || rule.applicability->matches(scan.platform, root);
+        if (applies && isOfflineCapable(rule)) {
+            requirements.merge(rule.check->requirements());
+            pending.insert(rule.id);
+        } else {
+            result.status = CheckStatus::NotApplicable;
+        }
+        scan.results.insert(rule.id, result);
+    }
+    facts.collect(requirements);
+    
+    // Avaliar em ordem de dependência; "skip_if" só vale para dependências
+    // que chegaram a um resultado
+    QHash<QString, bool> outcomes;
+    QSet<QString> unblocked;
+    while (!pending.isEmpty()) {
+        bool progressed = false;
+        for (const VulnerabilityDefinition &rule : m_rules) {
+            if (!pending.contains(rule.id)) {
+                continue;
+            }
+            
+            bool ready = true;
+            for (const QString &dep : rule.dependsOn) {
+                ready = ready && !pending.contains(dep);
+            }
+            if (!ready && !unblocked.contains(rule.id)) {
+                continue;
+            }
+            
+            CheckResult &result = scan.results[rule.id];
+            bool skipped = false;
+            for (auto it = rule.skipIf.begin(); it != rule.skipIf.end(); ++it) {
+                skipped = skipped || (outcomes.contains(it.key()) && outcomes.value(it.key()) == it.value());
+            }
+            
+            if (skipped) {
+                result.status = CheckStatus::NotApplicable;
+            } else {
+                result.isVulnerable = rule.check->evaluate(facts);
+                result.evidence = rule.check->evidence(facts);
+                result.status = result.isVulnerable ? CheckStatus::Vulnerable : CheckStatus::Safe;
+                outcomes.insert(rule.id, result.isVulnerable);
+            }
+            pending.remove(rule.id);
+            progressed = true;
+        }
+        
+        if (!progressed) {
+            // Ciclo de dependências: libera a primeira regra restante
+            for (const VulnerabilityDefinition &rule : m_rules) {
+                if (pending.contains(rule.id)) {
+                    qWarning() << "Dependência circular envolvendo" << rule.id;
+                    unblocked.insert(rule.id);
+                    break;
+                }
+            }
+        }
+    }
+    
+    return scan;
+}
@@ -1,4 +1,5 @@
 #include "OllamaClient.h"
+#include "TraceRecorder.h"
 #include <QNetworkRequest>
 #include <QJsonParseError>
 #include <QDebug>
@@ -13,6 +14,7 @@ OllamaClient::OllamaClient(QObject *parent)
     , m_networkManager(new QNetworkAccessManager(this))
     , m_timeoutTimer(new QTimer(this))
     , m_currentReply(nullptr)
+    , m_requestStartUs(0)
 {
     // Configurar timeout de 600 segundos para análises de IA (10 minutos)
     m_timeoutTimer->setSingleShot(true);
@@ -105,6 +107,9 @@ void OllamaClient::analyzeSystemSecurity(const SystemInfo &systemInfo, const QSt
     qDebug() << prettyDoc.toJson(QJsonDocument::Indented);
     qDebug() << "=== FIM REQUEST JSON ===";
     
+    m_requestModel = modelName;
+    m_requestStartUs = TraceRecorder::now();
+    m_requestTimer.start();
     m_currentReply = m_networkManager->post(request, data);
     connect(m_currentReply, &QNetworkReply::finished, this, &OllamaClient::onAnalysisReplyFinished);
     connect(m_currentReply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
@@ -205,6 +210,34 @@ void OllamaClient::onAnalysisReplyFinished()
     QString httpReason = m_currentReply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString();
     qDebug() << "HTTP Status:" << httpStatus << httpReason;
     
+    QByteArray data = m_currentReply->readAll();
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    
+    // Tempo até a resposta completa; no sucesso o Ollama também informa os
+    // tokens e quanto foi carga do modelo, avaliação do prompt e geração
+    const QJsonObject body = doc.object();
+    OllamaUsage usage;
+    usage.seconds = m_requestTimer.elapsed() / 1000.0;
+    usage.promptTokens = body.value("prompt_eval_count").toInteger();
+    usage.responseTokens = body.value("eval_count").toInteger();
+    emit usageReported(usage);
+    
+    if (TraceRecorder::isEnabled()) {
+        QJsonObject args;
+        args["model"] = m_requestModel;
+        args["http_status"] = httpStatus;
+        args["bytes"] = data.size();
+        args["prompt_tokens"] = usage.promptTokens;
+        args["response_tokens"] = usage.responseTokens;
+        for (const char *key : { "load_duration", "prompt_eval_duration", "eval_duration", "total_duration" }) {
+            if (body.contains(key)) {
+                args[QString(key) + "_ms"] = body.value(key).toDouble() / 1e6;
+            }
+        }
+        TraceRecorder::completeAsync("ollama", "generate", m_requestStartUs, args);
+    }
+    
     // Tratamento específico para erros de servidor
     if (httpStatus == 504) {
         emit errorOccurred("Servidor Ollama demorou para responder (Gateway Timeout). Modelos grandes podem levar 5-10 minutos para carregar. Aguarde um pouco e tente novamente, ou use a verificação local.");
@@ -243,10 +276,7 @@ void OllamaClient::onAnalysisReplyFinished()
         return;
     }
     
-    QByteArray data = m_currentReply->readAll();
     qDebug() << "Raw Ollama API response data:" << data; // Adicionado para depuração
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
     
     if (parseError.error != QJsonParseError::NoError) {
         emit errorOccurred(QString("Erro ao parsear resposta da análise: %1").arg(parseError.errorString()));
@@ -394,8 +424,11 @@ IMPORTANTE: Retorne APENAS o JSON, sem texto adicional antes ou depois.
     return prompt;
 }
 
-QVector<VulnerabilityDefinition> OllamaClient::parseVulnerabilitiesFromResponse(const QString &response) const
+QVector<VulnerabilityDefinition> OllamaClient::parseVulnerabilitiesFromResponse(const QString &response)
 {
+    TraceSpan span("ollama", "parse");
+    span.setArg("chars", response.size());
+    
     QVector<VulnerabilityDefinition> vulnerabilities;
     
     // Tentar encontrar JSON na resposta
@@ -0,0 +1,142 @@
+#include "OutputCapture.h"
+#include <cstring>
+
+const int OutputCapture::DEFAULT_HEAD_BYTES = 4096;
+const int OutputCapture::DEFAULT_TAIL_BYTES = 12288;
+
+OutputCapture::OutputCapture(int headBytes, int tailBytes)
+    : m_headLimit(0)
+    , m_tailLimit(0)
+    , m_tailStart(0)
+    , m_tailSize(0)
+    , m_total(0)
+{
+    setLimits(headBytes, tailBytes);
+}
+
+void OutputCapture::setLimits(int headBytes, int tailBytes)
+{
+    m_headLimit = qMax(0, headBytes);
+    m_tailLimit = qMax(0, tailBytes);
+    m_tail = QByteArray();
+    clear();
+}
+
+void OutputCapture::append(const QByteArray &data)
+{
+    const char *bytes = data.constData();
+    qint64 length = data.size();
+    m_total += length;
+    
+    const int headRoom = m_headLimit - m_head.size();
+    if (headRoom > 0) {
+        const int taken = static_cast<int>(qMin<qint64>(headRoom, length));
+        m_head.append(bytes, taken);
+        bytes += taken;
+        length -= taken;
+    }
+    
+    if (length == 0 || m_tailLimit == 0) {
+        return;
+    }
+    if (m_tail.size() != m_tailLimit) {
+        m_tail.resize(m_tailLimit);
+    }
+    
+    // Só os últimos m_tailLimit bytes do bloco podem sobreviver
+    if (length >= m_tailLimit) {
+        memcpy(m_tail.data(), bytes + (length - m_tailLimit), m_tailLimit);
+        m_tailStart = 0;
+        m_tailSize = m_tailLimit;
+        return;
+    }
+    
+    const int count = static_cast<int>(length);
+    const int end = (m_tailStart + m_tailSize) % m_tailLimit;
+    const int first = qMin(count, m_tailLimit - end);
+    memcpy(m_tail.data() + end, bytes, first);
+    memcpy(m_tail.data(), bytes + first, count - first);
+    
+    const int overflow = m_tailSize + count - m_tailLimit;
+    if (overflow > 0) {
+        m_tailStart = (m_tailStart + overflow) % m_tailLimit;
+        m_tailSize = m_tailLimit;
+    } else {
+        m_tailSize += count;
+    }
+}
+
+void OutputCapture::clear()
+{
+    m_head.clear();
+    m_tailStart = 0;
+    m_tailSize = 0;
+    m_total = 0;
+}
+
+qint64 OutputCapture::totalBytes() const
+{
+    return m_total;
+}
+
+qint64 OutputCapture::droppedBytes() const
+{
+    return m_total - m_head.size() - m_tailSize;
+}
+
+bool OutputCapture::isEmpty() const
+{
+    return m_total == 0;
+}
+
+bool OutputCapture::isTruncated() const
+{
+    return droppedBytes() > 0;
+}
+
+// Bytes de continuação do UTF-8 (10xxxxxx) no começo: restos de um caractere
+// cortado pelo descarte, que virariam U+FFFD
+static int continuationPrefix(const QByteArray &data)
+{
+    int count = 0;
+    while (count < data.size() && count < 3 && (uchar(data[count]) & 0xC0) == 0x80) {
+        count++;
+    }
+    return count;
+}
+
+// Tamanho sem o caractere incompleto do final, se houver
+static int completePrefix(const QByteArray &data)
+{
+    for (int i = data.size() - 1; i >= 0 && i >= data.size() - 4; i--) {
+        const uchar byte = uchar(data[i]);
+        if ((byte & 0xC0) == 0x80) {
+            continue;
+        }
+        // Byte inicial: quantos bytes a sequência precisa
+        const int needed = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+        return data.size() - i >= needed ? data.size() : i;
+    }
+    return data.size();
+}
+
+QString OutputCapture::text() const
+{
+    QByteArray tail;
+    if (m_tailSize > 0) {
+        const int first = qMin(m_tailSize, m_tailLimit - m_tailStart);
+        tail = m_tail.mid(m_tailStart, first) + m_tail.left(m_tailSize - first);
+    }
+    
+    // Sem descarte o início e o final são contíguos e são decodificados juntos
+    if (!isTruncated()) {
+        return QString::fromLocal8Bit(m_head + tail);
+    }
+    
+    // Com descarte, os dois cortes caem em qualquer byte: o início perde um
+    // caractere incompleto no fim e o final começa no próximo caractere inteiro
+    QString text = QString::fromLocal8Bit(m_head.left(completePrefix(m_head)));
+    text += QString("\n[... %1 bytes omitidos ...]\n").arg(droppedBytes());
+    text += QString::fromLocal8Bit(tail.mid(continuationPrefix(tail)));
+    return text;
+}
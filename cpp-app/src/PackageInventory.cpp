@@ -0,0 +1,889 @@
+#include "PackageInventory.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <algorithm>
+
+#ifdef SECURITYCHECKER_HAS_SQL
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#endif
+
+static const char *DPKG_STATUS = "/var/lib/dpkg/status";
+static const char *APK_INSTALLED = "/lib/apk/db/installed";
+static const char *APT_LISTS_DIR = "/var/lib/apt/lists";
+static const char *APT_PREFERENCES = "/etc/apt/preferences";
+static const char *APT_PREFERENCES_DIR = "/etc/apt/preferences.d";
+static const char *APT_HELPER = "/usr/lib/apt/apt-helper";
+
+// Local do banco sqlite do rpm: /usr/lib/sysimage nas distribuições mais novas
+static const QStringList RPM_DATABASES = {
+    "/usr/lib/sysimage/rpm/rpmdb.sqlite",
+    "/var/lib/rpm/rpmdb.sqlite"
+};
+
+// Formatos anteriores ao sqlite: Berkeley DB (RHEL 8 e anteriores) e ndb (SUSE)
+static const QStringList RPM_LEGACY_DATABASES = {
+    "/usr/lib/sysimage/rpm/Packages.db",
+    "/var/lib/rpm/Packages.db",
+    "/var/lib/rpm/Packages"
+};
+
+// Listas do apt podem ficar comprimidas (Acquire::GzipIndexes)
+static const QStringList APT_LIST_PATTERNS = {
+    "*_Packages", "*_Packages.gz", "*_Packages.xz", "*_Packages.lz4", "*_Packages.zst", "*_Packages.bz2"
+};
+
+// Percorre blocos "Chave: valor" separados por linha em branco direto sobre o
+// buffer. As chaves e valores entregues só valem durante a chamada.
+template<typename FieldFn, typename EndFn>
+static void parseStanzas(const char *data, qint64 size, FieldFn onField, EndFn onEnd)
+{
+    const char *p = data;
+    const char *end = data + size;
+    bool inStanza = false;
+    
+    while (p < end) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (!eol) {
+            eol = end;
+        }
+        
+        if (eol == p || (eol == p + 1 && *p == '\r')) {
+            if (inStanza) {
+                onEnd();
+                inStanza = false;
+            }
+        } else if (*p != ' ' && *p != '\t') {
+            // Linhas iniciadas por espaço continuam o campo anterior e não interessam aqui
+            const char *colon = static_cast<const char *>(memchr(p, ':', eol - p));
+            if (colon) {
+                const char *value = colon + 1;
+                const char *valueEnd = eol;
+                while (value < valueEnd && *value == ' ') {
+                    value++;
+                }
+                while (valueEnd > value && (valueEnd[-1] == '\r' || valueEnd[-1] == ' ')) {
+                    valueEnd--;
+                }
+                onField(QByteArray::fromRawData(p, colon - p),
+                        QByteArray::fromRawData(value, valueEnd - value));
+                inStanza = true;
+            }
+        }
+        
+        p = eol + 1;
+    }
+    
+    if (inStanza) {
+        onEnd();
+    }
+}
+
+// Mapeia o arquivo em memória em vez de copiá-lo; recorre a readAll se o mmap falhar
+template<typename FieldFn, typename EndFn>
+static bool parseStanzaFile(const QString &path, FieldFn onField, EndFn onEnd)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    const qint64 size = file.size();
+    if (size <= 0) {
+        return true;
+    }
+    
+    uchar *mapped = file.map(0, size);
+    if (mapped) {
+        parseStanzas(reinterpret_cast<const char *>(mapped), size, onField, onEnd);
+        file.unmap(mapped);
+    } else {
+        const QByteArray content = file.readAll();
+        parseStanzas(content.constData(), content.size(), onField, onEnd);
+    }
+    
+    return true;
+}
+
+PackageInventory::PackageInventory()
+    : m_backend(Backend::None)
+{
+}
+
+PackageInventory::Backend PackageInventory::detectBackend(const QString &root)
+{
+    if (QFile::exists(root + DPKG_STATUS)) {
+        return Backend::Dpkg;
+    }
+    for (const QString &path : RPM_DATABASES + RPM_LEGACY_DATABASES) {
+        if (QFile::exists(root + path)) {
+            return Backend::Rpm;
+        }
+    }
+    if (QFile::exists(root + APK_INSTALLED)) {
+        return Backend::Apk;
+    }
+    return Backend::None;
+}
+
+void PackageInventory::setRoot(const QString &root)
+{
+    m_root = root;
+}
+
+bool PackageInventory::load()
+{
+    clear();
+    
+    switch (detectBackend(m_root)) {
+        case Backend::Dpkg:
+            m_backend = Backend::Dpkg;
+            return loadDpkg(m_root + DPKG_STATUS);
+        case Backend::Rpm:
+            m_backend = Backend::Rpm;
+            for (const QString &path : RPM_DATABASES) {
+                if (QFile::exists(m_root + path) && loadRpm(m_root + path)) {
+                    return true;
+                }
+            }
+            return loadRpmCommand();
+        case Backend::Apk:
+            m_backend = Backend::Apk;
+            return loadApk(m_root + APK_INSTALLED);
+        case Backend::None:
+            break;
+    }
+    
+    qWarning() << "Nenhum banco de pacotes suportado encontrado";
+    return false;
+}
+
+void PackageInventory::clear()
+{
+    m_packages.clear();
+    m_candidates.clear();
+    m_backend = Backend::None;
+}
+
+bool PackageInventory::isLoaded() const
+{
+    return m_backend != Backend::None;
+}
+
+PackageInventory::Backend PackageInventory::backend() const
+{
+    return m_backend;
+}
+
+bool PackageInventory::contains(const QString &name) const
+{
+    return m_packages.contains(name);
+}
+
+PackageRecord PackageInventory::package(const QString &name) const
+{
+    PackageRecord newest;
+    const QVector<PackageRecord> records = m_packages.value(name);
+    for (const PackageRecord &record : records) {
+        if (newest.name.isEmpty() || compareDebianVersions(record.version, newest.version) > 0) {
+            newest = record;
+        }
+    }
+    return newest;
+}
+
+QVector<PackageRecord> PackageInventory::instances(const QString &name) const
+{
+    return m_packages.value(name);
+}
+
+QVector<PackageRecord> PackageInventory::packages() const
+{
+    QVector<PackageRecord> records;
+    records.reserve(size());
+    for (const QVector<PackageRecord> &instances : m_packages) {
+        records += instances;
+    }
+    std::sort(records.begin(), records.end(), [](const PackageRecord &a, const PackageRecord &b) {
+        if (a.name != b.name) {
+            return a.name < b.name;
+        }
+        if (a.architecture != b.architecture) {
+            return a.architecture < b.architecture;
+        }
+        return compareDebianVersions(a.version, b.version) < 0;
+    });
+    return records;
+}
+
+int PackageInventory::size() const
+{
+    int count = 0;
+    for (const QVector<PackageRecord> &instances : m_packages) {
+        count += instances.size();
+    }
+    return count;
+}
+
+void PackageInventory::insert(const PackageRecord &record)
+{
+    m_packages[record.name].append(record);
+}
+
+bool PackageInventory::loadDpkg(const QString &path)
+{
+    PackageRecord record;
+    bool installed = false;
+    
+    auto onField = [&](const QByteArray &key, const QByteArray &value) {
+        if (key == "Package") {
+            record.name = QString::fromUtf8(value);
+        } else if (key == "Status") {
+            // "install ok installed"; "deinstall ok config-files" não conta
+            installed = value.endsWith(" installed");
+        } else if (key == "Version") {
+            record.version = QString::fromUtf8(value);
+        } else if (key == "Architecture") {
+            record.architecture = QString::fromUtf8(value);
+        } else if (key == "Source") {
+            // "Source: openssl (3.0.2-0ubuntu1)": ficar só com o nome
+            int space = value.indexOf(' ');
+            record.source = QString::fromUtf8(space == -1 ? value : value.left(space));
+        }
+    };
+    
+    auto onEnd = [&]() {
+        if (installed && !record.name.isEmpty()) {
+            if (record.source.isEmpty()) {
+                record.source = record.name;
+            }
+            insert(record);
+        }
+        record = PackageRecord();
+        installed = false;
+    };
+    
+    if (!parseStanzaFile(path, onField, onEnd)) {
+        qWarning() << "Não foi possível ler" << path;
+        return false;
+    }
+    
+    qDebug() << "Pacotes dpkg instalados:" << size();
+    return true;
+}
+
+bool PackageInventory::loadApk(const QString &path)
+{
+    PackageRecord record;
+    
+    auto onField = [&](const QByteArray &key, const QByteArray &value) {
+        if (key == "P") {
+            record.name = QString::fromUtf8(value);
+        } else if (key == "V") {
+            record.version = QString::fromUtf8(value);
+        } else if (key == "A") {
+            record.architecture = QString::fromUtf8(value);
+        } else if (key == "o") {
+            record.source = QString::fromUtf8(value);
+        }
+    };
+    
+    auto onEnd = [&]() {
+        if (!record.name.isEmpty()) {
+            if (record.source.isEmpty()) {
+                record.source = record.name;
+            }
+            insert(record);
+        }
+        record = PackageRecord();
+    };
+    
+    if (!parseStanzaFile(path, onField, onEnd)) {
+        qWarning() << "Não foi possível ler" << path;
+        return false;
+    }
+    
+    qDebug() << "Pacotes apk instalados:" << size();
+    return true;
+}
+
+#ifdef SECURITYCHECKER_HAS_SQL
+// Cabeçalho rpm armazenado no sqlite: contagem de entradas e tamanho dos dados
+// (big-endian), seguidos das entradas {tag, tipo, offset, contagem} e dos dados
+static bool parseRpmHeader(const QByteArray &blob, PackageRecord &record)
+{
+    enum {
+        RPMTAG_NAME = 1000,
+        RPMTAG_VERSION = 1001,
+        RPMTAG_RELEASE = 1002,
+        RPMTAG_EPOCH = 1003,
+        RPMTAG_ARCH = 1022,
+        RPMTAG_SOURCERPM = 1044
+    };
+    enum {
+        RPM_INT32_TYPE = 4,
+        RPM_STRING_TYPE = 6
+    };
+    
+    if (blob.size() < 8) {
+        return false;
+    }
+    
+    const uchar *data = reinterpret_cast<const uchar *>(blob.constData());
+    const quint32 indexCount = qFromBigEndian<quint32>(data);
+    const quint32 dataLength = qFromBigEndian<quint32>(data + 4);
+    const qint64 storeOffset = 8 + qint64(indexCount) * 16;
+    if (storeOffset + dataLength > blob.size()) {
+        return false;
+    }
+    
+    QString version;
+    QString release;
+    quint32 epoch = 0;
+    bool hasEpoch = false;
+    
+    for (quint32 i = 0; i < indexCount; i++) {
+        const uchar *entry = data + 8 + i * 16;
+        const quint32 tag = qFromBigEndian<quint32>(entry);
+        const quint32 type = qFromBigEndian<quint32>(entry + 4);
+        const quint32 offset = qFromBigEndian<quint32>(entry + 8);
+        if (offset >= dataLength) {
+            continue;
+        }
+        
+        const char *value = blob.constData() + storeOffset + offset;
+        if (type == RPM_STRING_TYPE) {
+            const qint64 maxLength = dataLength - offset;
+            const QString text = QString::fromUtf8(value, qstrnlen(value, maxLength));
+            switch (tag) {
+                case RPMTAG_NAME: record.name = text; break;
+                case RPMTAG_VERSION: version = text; break;
+                case RPMTAG_RELEASE: release = text; break;
+                case RPMTAG_ARCH: record.architecture = text; break;
+                case RPMTAG_SOURCERPM: record.source = text; break;
+                default: break;
+            }
+        } else if (type == RPM_INT32_TYPE && tag == RPMTAG_EPOCH && offset + 4 <= dataLength) {
+            epoch = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(value));
+            hasEpoch = true;
+        }
+    }
+    
+    record.version = (hasEpoch ? QString::number(epoch) + ":" : QString()) + version
+                     + (release.isEmpty() ? QString() : "-" + release);
+    return !record.name.isEmpty();
+}
+#endif
+
+bool PackageInventory::loadRpm(const QString &path)
+{
+#ifdef SECURITYCHECKER_HAS_SQL
+    // Um nome por inventário: raízes diferentes podem ser lidas em paralelo
+    const QString connection = QString("securitychecker-rpmdb-%1").arg(reinterpret_cast<quintptr>(this), 0, 16);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(path);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (!db.open()) {
+            qWarning() << "Não foi possível abrir o banco do rpm:" << path;
+        } else {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            if (query.exec("SELECT blob FROM Packages")) {
+                while (query.next()) {
+                    PackageRecord record;
+                    if (parseRpmHeader(query.value(0).toByteArray(), record)) {
+                        insert(record);
+                    }
+                }
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection);
+    
+    qDebug() << "Pacotes rpm instalados:" << size();
+    return !m_packages.isEmpty();
+#else
+    Q_UNUSED(path);
+    return false;
+#endif
+}
+
+bool PackageInventory::loadRpmCommand()
+{
+    // Berkeley DB e ndb não têm leitor aqui: o rpm do sistema lê o banco da raiz
+    const QString format = "%{NAME}\t%|EPOCH?{%{EPOCH}:}:{}|%{VERSION}-%{RELEASE}\t%{ARCH}\t%{SOURCERPM}\n";
+    QProcess process;
+    process.start("rpm", QStringList() << "--root" << (m_root.isEmpty() ? QString("/") : m_root)
+                  << "-qa" << "--qf" << format);
+    if (!process.waitForFinished(60000) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        qWarning() << "Não foi possível ler o banco do rpm com \"rpm -qa\"";
+        return false;
+    }
+    
+    const QList<QByteArray> lines = process.readAllStandardOutput().split('\n');
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.split('\t');
+        if (fields.size() < 4 || fields[0].isEmpty()) {
+            continue;
+        }
+        PackageRecord record;
+        record.name = QString::fromUtf8(fields[0]);
+        record.version = QString::fromUtf8(fields[1]);
+        record.architecture = QString::fromUtf8(fields[2]);
+        record.source = QString::fromUtf8(fields[3]);
+        insert(record);
+    }
+    
+    qDebug() << "Pacotes rpm instalados (rpm -qa):" << size();
+    return !m_packages.isEmpty();
+}
+
+// Entrada de /etc/apt/preferences
+struct AptPin {
+    QStringList packages;                // nomes, globs ou /regex/
+    bool specific;                       // algum nome exato: vale antes dos genéricos
+    QString type;                        // release, origin ou version
+    QHash<QString, QString> release;     // a, n, o, l, v, c
+    QString value;                       // host (origin) ou versão (version)
+    int priority;
+    
+    AptPin() : specific(false), priority(0) {}
+};
+
+// Repositório de uma lista do apt, descrito pelo Release/InRelease dele
+struct AptRelease {
+    QHash<QString, QString> fields;      // a, n, o, l, v, c
+    QString host;
+    int defaultPriority;
+    
+    AptRelease() : defaultPriority(500) {}
+};
+
+// Nome exato, glob ou /regex/, como no campo Package do apt_preferences
+static bool aptPatternMatches(const QString &pattern, const QString &value)
+{
+    if (pattern.size() > 2 && pattern.startsWith('/') && pattern.endsWith('/')) {
+        return QRegularExpression(pattern.mid(1, pattern.size() - 2)).match(value).hasMatch();
+    }
+    if (pattern.contains('*') || pattern.contains('?') || pattern.contains('[')) {
+        return QRegularExpression(QRegularExpression::wildcardToRegularExpression(pattern)).match(value).hasMatch();
+    }
+    return pattern == value;
+}
+
+static QVector<AptPin> loadAptPins(const QString &root)
+{
+    QVector<AptPin> pins;
+    AptPin pin;
+    bool hasPriority = false;
+    
+    auto onField = [&](const QByteArray &key, const QByteArray &value) {
+        const QString text = QString::fromUtf8(value).trimmed();
+        if (key == "Package") {
+            pin.packages = text.split(' ', Qt::SkipEmptyParts);
+            for (const QString &pattern : pin.packages) {
+                pin.specific = pin.specific || !(pattern.contains('*') || pattern.contains('?')
+                                                 || pattern.contains('[') || pattern.startsWith('/'));
+            }
+        } else if (key == "Pin") {
+            const int space = text.indexOf(' ');
+            pin.type = text.left(space);
+            const QString rest = space == -1 ? QString() : text.mid(space + 1).trimmed();
+            if (pin.type == "release" && rest.contains('=')) {
+                const QStringList conditions = rest.split(',', Qt::SkipEmptyParts);
+                for (const QString &condition : conditions) {
+                    const int equals = condition.indexOf('=');
+                    pin.release.insert(condition.left(equals).trimmed(), condition.mid(equals + 1).trimmed());
+                }
+            } else if (pin.type == "release") {
+                pin.release.insert("v", rest);
+            } else {
+                pin.value = rest;
+                pin.value.remove('"');
+            }
+        } else if (key == "Pin-Priority") {
+            pin.priority = text.toInt(&hasPriority);
+        }
+    };
+    
+    auto onEnd = [&]() {
+        if (!pin.packages.isEmpty() && !pin.type.isEmpty() && hasPriority) {
+            pins.append(pin);
+        }
+        pin = AptPin();
+        hasPriority = false;
+    };
+    
+    const QStringList files = PackageInventory::aptPreferenceFiles(root);
+    for (const QString &path : files) {
+        parseStanzaFile(path, onField, onEnd);
+    }
+    return pins;
+}
+
+static bool aptPinMatches(const AptPin &pin, const QString &version, const AptRelease &release)
+{
+    if (pin.type == "version") {
+        return aptPatternMatches(pin.value, version);
+    }
+    if (pin.type == "origin") {
+        return pin.value == release.host;
+    }
+    if (pin.type != "release") {
+        return false;
+    }
+    for (auto it = pin.release.begin(); it != pin.release.end(); ++it) {
+        const QString actual = release.fields.value(it.key());
+        if (actual.isEmpty() || !aptPatternMatches(it.value(), actual)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Prioridade de uma versão num repositório: pins com o nome exato do pacote
+// antes dos genéricos e, em cada grupo, o primeiro que casa
+static int aptPriority(const QVector<AptPin> &pins, const QString &name, const QString &version,
+                       const AptRelease &release)
+{
+    for (int pass = 0; pass < 2; pass++) {
+        for (const AptPin &pin : pins) {
+            if (pin.specific != (pass == 0)) {
+                continue;
+            }
+            bool nameMatches = false;
+            for (const QString &pattern : pin.packages) {
+                nameMatches = nameMatches || aptPatternMatches(pattern, name);
+            }
+            if (nameMatches && aptPinMatches(pin, version, release)) {
+                return pin.priority;
+            }
+        }
+    }
+    return release.defaultPriority;
+}
+
+// A lista "host_caminho_dists_suite_componente_binary-arq_Packages" pertence ao
+// Release/InRelease de prefixo mais longo no mesmo diretório
+static AptRelease aptRelease(const QString &listPath, const QStringList &releaseFiles)
+{
+    const QFileInfo list(listPath);
+    const QString listName = list.fileName();
+    QString best;
+    for (const QString &releaseName : releaseFiles) {
+        const QString prefix = releaseName.left(releaseName.lastIndexOf('_') + 1);
+        if (listName.startsWith(prefix) && prefix.size() > best.size()) {
+            best = prefix;
+        }
+    }
+    
+    AptRelease release;
+    release.host = listName.section('_', 0, 0);
+    if (best.isEmpty()) {
+        return release;
+    }
+    release.fields.insert("c", listName.mid(best.size()).section('_', 0, 0));
+    
+    // O InRelease é assinado em linha; os campos do repositório vêm antes dos hashes
+    static const QHash<QByteArray, QString> keys = {
+        { "Origin", "o" }, { "Label", "l" }, { "Suite", "a" }, { "Codename", "n" }, { "Version", "v" }
+    };
+    bool notAutomatic = false;
+    bool butAutomaticUpgrades = false;
+    auto onField = [&](const QByteArray &key, const QByteArray &value) {
+        if (keys.contains(key) && !release.fields.contains(keys.value(key))) {
+            release.fields.insert(keys.value(key), QString::fromUtf8(value));
+        } else if (key == "NotAutomatic") {
+            notAutomatic = value == "yes";
+        } else if (key == "ButAutomaticUpgrades") {
+            butAutomaticUpgrades = value == "yes";
+        }
+    };
+    const QString inRelease = list.dir().filePath(best + "InRelease");
+    parseStanzaFile(QFile::exists(inRelease) ? inRelease : list.dir().filePath(best + "Release"), onField, [] {});
+    
+    if (notAutomatic) {
+        release.defaultPriority = butAutomaticUpgrades ? 100 : 1;
+    }
+    return release;
+}
+
+// Listas comprimidas passam pelo apt-helper do sistema, que conhece todos os
+// formatos do apt; as demais são mapeadas em memória
+template<typename FieldFn, typename EndFn>
+static bool parseAptList(const QString &path, FieldFn onField, EndFn onEnd)
+{
+    if (path.endsWith("_Packages")) {
+        return parseStanzaFile(path, onField, onEnd);
+    }
+    
+    QProcess process;
+    process.start(APT_HELPER, QStringList() << "cat-file" << path);
+    if (!process.waitForFinished(60000) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        qWarning() << "Não foi possível descomprimir" << path;
+        return false;
+    }
+    const QByteArray content = process.readAllStandardOutput();
+    parseStanzas(content.constData(), content.size(), onField, onEnd);
+    return true;
+}
+
+bool PackageInventory::loadAptCandidates()
+{
+    m_candidates.clear();
+    if (m_backend != Backend::Dpkg) {
+        return false;
+    }
+    
+    const QVector<AptPin> pins = loadAptPins(m_root);
+    const QStringList lists = aptListFiles(m_root);
+    const QStringList releaseFiles = QDir(m_root + APT_LISTS_DIR).entryList(
+        QStringList() << "*_InRelease" << "*_Release", QDir::Files);
+    
+    // Versões disponíveis de cada instância instalada, com a prioridade de cada uma
+    QHash<QString, QVector<QPair<QString, int>>> available;   // "nome:arquitetura"
+    AptRelease release;
+    QString name;
+    QString version;
+    QString architecture;
+    
+    auto onField = [&](const QByteArray &key, const QByteArray &value) {
+        if (key == "Package") {
+            name = QString::fromUtf8(value);
+        } else if (key == "Version") {
+            version = QString::fromUtf8(value);
+        } else if (key == "Architecture") {
+            architecture = QString::fromUtf8(value);
+        }
+    };
+    
+    auto onEnd = [&]() {
+        auto installed = m_packages.constFind(name);
+        if (installed != m_packages.constEnd()) {
+            int priority = 0;
+            bool prioritized = false;
+            for (const PackageRecord &instance : *installed) {
+                if (architecture != instance.architecture && architecture != "all") {
+                    continue;
+                }
+                if (!prioritized) {
+                    priority = aptPriority(pins, name, version, release);
+                    prioritized = true;
+                }
+                available[name + ':' + instance.architecture].append(qMakePair(version, priority));
+            }
+        }
+        name.clear();
+        version.clear();
+        architecture.clear();
+    };
+    
+    for (const QString &path : lists) {
+        release = aptRelease(path, releaseFiles);
+        parseAptList(path, onField, onEnd);
+    }
+    
+    // Candidata como no apt: maior prioridade e, no empate, a versão mais alta.
+    // A instalada vale 100 (ou a do repositório que a oferece, se maior), versões
+    // mais antigas só ganham com prioridade 1000 e prioridade negativa nunca ganha.
+    for (auto it = available.begin(); it != available.end(); ++it) {
+        const QString packageName = it.key().section(':', 0, 0);
+        const QString packageArchitecture = it.key().section(':', 1);
+        QString installedVersion;
+        for (const PackageRecord &instance : m_packages.value(packageName)) {
+            if (instance.architecture == packageArchitecture) {
+                installedVersion = instance.version;
+            }
+        }
+        
+        int installedPriority = 100;
+        for (const auto &entry : *it) {
+            if (entry.first == installedVersion) {
+                installedPriority = qMax(installedPriority, entry.second);
+            }
+        }
+        
+        QString candidate = installedVersion;
+        int candidatePriority = installedPriority;
+        for (const auto &entry : *it) {
+            const int order = compareDebianVersions(entry.first, installedVersion);
+            if (entry.second < 0 || order == 0 || (order < 0 && entry.second < 1000)) {
+                continue;
+            }
+            if (entry.second > candidatePriority
+                || (entry.second == candidatePriority && compareDebianVersions(entry.first, candidate) > 0)) {
+                candidate = entry.first;
+                candidatePriority = entry.second;
+            }
+        }
+        m_candidates.insert(it.key(), candidate);
+    }
+    
+    return !lists.isEmpty();
+}
+
+QStringList PackageInventory::upgradable(const QString &namePattern) const
+{
+    QStringList result;
+    const QRegularExpression pattern(namePattern);
+    
+    for (auto it = m_candidates.begin(); it != m_candidates.end(); ++it) {
+        const QString name = it.key().section(':', 0, 0);
+        if (result.contains(name) || !pattern.match(name).hasMatch()) {
+            continue;
+        }
+        const QString architecture = it.key().section(':', 1);
+        for (const PackageRecord &installed : m_packages.value(name)) {
+            if (installed.architecture == architecture && compareDebianVersions(it.value(), installed.version) > 0) {
+                result.append(name);
+                break;
+            }
+        }
+    }
+    
+    return result;
+}
+
+// Peso de cada caractere na comparação do dpkg: "~" antes de tudo, até do fim
+static int versionCharOrder(const QString &s, int i)
+{
+    if (i >= s.size()) {
+        return 0;
+    }
+    const QChar c = s[i];
+    if (c.isDigit()) {
+        return 0;
+    }
+    if (c.isLetter()) {
+        return c.unicode();
+    }
+    if (c == '~') {
+        return -1;
+    }
+    return c.unicode() + 256;
+}
+
+static int compareVersionPart(const QString &a, const QString &b)
+{
+    int i = 0;
+    int j = 0;
+    
+    while (i < a.size() || j < b.size()) {
+        // Trecho não numérico
+        while ((i < a.size() && !a[i].isDigit()) || (j < b.size() && !b[j].isDigit())) {
+            int ac = versionCharOrder(a, i);
+            int bc = versionCharOrder(b, j);
+            if (ac != bc) {
+                return ac - bc;
+            }
+            i++;
+            j++;
+        }
+        
+        // Trecho numérico, ignorando zeros à esquerda
+        while (i < a.size() && a[i] == '0') {
+            i++;
+        }
+        while (j < b.size() && b[j] == '0') {
+            j++;
+        }
+        
+        int firstDiff = 0;
+        while (i < a.size() && a[i].isDigit() && j < b.size() && b[j].isDigit()) {
+            if (!firstDiff) {
+                firstDiff = a[i].unicode() - b[j].unicode();
+            }
+            i++;
+            j++;
+        }
+        
+        if (i < a.size() && a[i].isDigit()) {
+            return 1;
+        }
+        if (j < b.size() && b[j].isDigit()) {
+            return -1;
+        }
+        if (firstDiff) {
+            return firstDiff;
+        }
+    }
+    
+    return 0;
+}
+
+int PackageInventory::compareDebianVersions(const QString &a, const QString &b)
+{
+    auto split = [](const QString &version, int &epoch, QString &upstream, QString &revision) {
+        int colon = version.indexOf(':');
+        epoch = colon == -1 ? 0 : version.left(colon).toInt();
+        QString rest = colon == -1 ? version : version.mid(colon + 1);
+        int dash = rest.lastIndexOf('-');
+        upstream = dash == -1 ? rest : rest.left(dash);
+        revision = dash == -1 ? QString() : rest.mid(dash + 1);
+    };
+    
+    int epochA, epochB;
+    QString upstreamA, upstreamB, revisionA, revisionB;
+    split(a, epochA, upstreamA, revisionA);
+    split(b, epochB, upstreamB, revisionB);
+    
+    if (epochA != epochB) {
+        return epochA < epochB ? -1 : 1;
+    }
+    
+    int result = compareVersionPart(upstreamA, upstreamB);
+    if (result != 0) {
+        return result < 0 ? -1 : 1;
+    }
+    
+    result = compareVersionPart(revisionA, revisionB);
+    return result < 0 ? -1 : (result > 0 ? 1 : 0);
+}
+
+QStringList PackageInventory::databaseFiles()
+{
+    QStringList files;
+    files << DPKG_STATUS << APK_INSTALLED << RPM_DATABASES << RPM_LEGACY_DATABASES;
+    return files;
+}
+
+QString PackageInventory::aptListsDirectory()
+{
+    return APT_LISTS_DIR;
+}
+
+QStringList PackageInventory::aptPreferenceFiles(const QString &root)
+{
+    QStringList files;
+    if (QFile::exists(root + APT_PREFERENCES)) {
+        files.append(root + APT_PREFERENCES);
+    }
+    // Como o apt: só arquivos sem extensão ou terminados em .pref
+    QDir dir(root + APT_PREFERENCES_DIR);
+    const QStringList names = dir.entryList(QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        if (!name.contains('.') || name.endsWith(".pref")) {
+            files.append(dir.filePath(name));
+        }
+    }
+    return files;
+}
+
+QStringList PackageInventory::aptListFiles(const QString &root)
+{
+    QStringList files;
+    QDir dir(root + APT_LISTS_DIR);
+    const QStringList names = dir.entryList(APT_LIST_PATTERNS, QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        files.append(dir.filePath(name));
+    }
+    return files;
+}
@@ -0,0 +1,266 @@
+#include "PlatformFingerprint.h"
+#include "PackageInventory.h"
+#include "SystemFacts.h"
+#include "TraceRecorder.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QSysInfo>
+#include <QDebug>
+
+#ifndef _WIN32
+#include <sys/utsname.h>
+#endif
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+// Caminho dentro da raiz, com links resolvidos como num chroot
+static QString inRoot(const QString &root, const QString &path)
+{
+    return root.isEmpty() ? path : SystemFacts::resolveInRoot(root, path);
+}
+
+static QByteArray readSmallFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    // Arquivos de /proc e /sys informam tamanho 0; nenhum dos lidos aqui passa disso
+    return file.read(64 * 1024);
+}
+
+// os-release: CHAVE=valor, com ou sem aspas
+static void readOsRelease(const QString &root, PlatformFingerprint *fp)
+{
+    QByteArray data = readSmallFile(inRoot(root, "/etc/os-release"));
+    if (data.isEmpty()) {
+        data = readSmallFile(inRoot(root, "/usr/lib/os-release"));
+    }
+    
+    for (const QByteArray &rawLine : data.split('\n')) {
+        const int equals = rawLine.indexOf('=');
+        if (equals <= 0) {
+            continue;
+        }
+        const QByteArray key = rawLine.left(equals).trimmed();
+        QString value = QString::fromUtf8(rawLine.mid(equals + 1).trimmed());
+        if (value.size() >= 2 && (value.startsWith('"') || value.startsWith('\'')) && value.endsWith(value[0])) {
+            value = value.mid(1, value.size() - 2);
+        }
+        
+        if (key == "ID") {
+            fp->distroId = value.toLower();
+        } else if (key == "ID_LIKE") {
+            fp->distroLike = value.toLower().split(' ', Qt::SkipEmptyParts);
+        } else if (key == "VERSION_ID") {
+            fp->versionId = value;
+        } else if (key == "PRETTY_NAME") {
+            fp->prettyName = value;
+        }
+    }
+}
+
+static QString detectInitSystem(const QString &root)
+{
+    // Mesmo critério do sd_booted(): o diretório só existe com o systemd como PID 1
+    if (root.isEmpty() && QFileInfo(QStringLiteral("/run/systemd/system")).isDir()) {
+        return "systemd";
+    }
+    
+    if (root.isEmpty()) {
+        const QString comm = QString::fromUtf8(readSmallFile("/proc/1/comm")).trimmed();
+        if (comm == "systemd" || comm == "openrc-init" || comm == "runit" || comm == "s6-svscan") {
+            return comm == "openrc-init" ? "openrc" : comm == "s6-svscan" ? "s6" : comm;
+        }
+    }
+    
+    // Raiz montada, ou PID 1 genérico ("init"): pelo que está instalado
+    if (QFileInfo::exists(inRoot(root, "/lib/systemd/systemd")) || QFileInfo::exists(inRoot(root, "/usr/lib/systemd/systemd"))) {
+        return "systemd";
+    }
+    if (QFileInfo::exists(inRoot(root, "/sbin/openrc")) || QFileInfo::exists(inRoot(root, "/sbin/openrc-run"))) {
+        return "openrc";
+    }
+    if (QFileInfo::exists(inRoot(root, "/etc/runit"))) {
+        return "runit";
+    }
+    if (QFileInfo::exists(inRoot(root, "/etc/inittab"))) {
+        return "sysvinit";
+    }
+    return QString();
+}
+
+#ifdef Q_OS_LINUX
+static QString detectContainer()
+{
+    if (QFileInfo::exists("/.dockerenv")) {
+        return "docker";
+    }
+    if (QFileInfo::exists("/run/.containerenv")) {
+        return "podman";
+    }
+    
+    // systemd-nspawn, LXC e outros exportam "container=" para o PID 1
+    for (const QByteArray &entry : readSmallFile("/proc/1/environ").split('\0')) {
+        if (entry.startsWith("container=")) {
+            return QString::fromUtf8(entry.mid(10));
+        }
+    }
+    
+    const QByteArray cgroup = readSmallFile("/proc/1/cgroup");
+    if (cgroup.contains("kubepods")) {
+        return "kubernetes";
+    }
+    if (cgroup.contains("/docker/") || cgroup.contains("docker-")) {
+        return "docker";
+    }
+    if (cgroup.contains("/lxc/") || cgroup.contains("lxc.payload")) {
+        return "lxc";
+    }
+    
+    const QByteArray osrelease = readSmallFile("/proc/sys/kernel/osrelease").toLower();
+    if (osrelease.contains("microsoft")) {
+        return "wsl";
+    }
+    return QString();
+}
+
+static QString detectVirtualization()
+{
+    // DMI identifica o hipervisor; a flag "hypervisor" da CPU só diz que há um
+    const QString dmi = QString::fromUtf8(readSmallFile("/sys/class/dmi/id/sys_vendor")
+                                          + ' ' + readSmallFile("/sys/class/dmi/id/product_name")).toLower();
+    if (dmi.contains("qemu") || dmi.contains("kvm")) {
+        return "kvm";
+    }
+    if (dmi.contains("vmware")) {
+        return "vmware";
+    }
+    if (dmi.contains("virtualbox") || dmi.contains("innotek")) {
+        return "virtualbox";
+    }
+    if (dmi.contains("microsoft corporation") && dmi.contains("virtual")) {
+        return "hyper-v";
+    }
+    if (dmi.contains("xen") || QFileInfo::exists("/proc/xen")) {
+        return "xen";
+    }
+    if (dmi.contains("amazon ec2") || dmi.contains("google compute engine")) {
+        return "kvm";
+    }
+    
+    const QByteArray cpuinfo = readSmallFile("/proc/cpuinfo");
+    if (cpuinfo.contains(" hypervisor")) {
+        return "vm";
+    }
+    return QString();
+}
+
+#endif // Q_OS_LINUX
+
+static QString detectPackageManager(const QString &root)
+{
+    switch (PackageInventory::detectBackend(root)) {
+        case PackageInventory::Backend::Dpkg:
+            return "apt";
+        case PackageInventory::Backend::Apk:
+            return "apk";
+        case PackageInventory::Backend::Rpm:
+            for (const char *binary : { "dnf", "yum", "zypper" }) {
+                if (QFileInfo::exists(inRoot(root, QString("/usr/bin/") + binary))) {
+                    return binary;
+                }
+            }
+            return "rpm";
+        case PackageInventory::Backend::None:
+            break;
+    }
+    if (QFileInfo(inRoot(root, "/var/lib/pacman/local")).isDir()) {
+        return "pacman";
+    }
+    return QString();
+}
+
+#endif
+
+PlatformFingerprint PlatformFingerprint::detect(const QString &root)
+{
+    TraceSpan span("os", "fingerprint");
+    PlatformFingerprint fp;
+
+#if defined(Q_OS_WIN)
+    Q_UNUSED(root);
+    fp.family = "windows";
+    fp.distroId = "windows";
+    fp.versionId = QSysInfo::productVersion();
+    fp.prettyName = QSysInfo::prettyProductName();
+    fp.kernelRelease = QSysInfo::kernelVersion();
+    fp.architecture = QSysInfo::currentCpuArchitecture();
+    fp.initSystem = "scm";
+#elif defined(Q_OS_MACOS)
+    fp.family = "macos";
+    fp.distroId = "macos";
+    fp.versionId = QSysInfo::productVersion();
+    fp.prettyName = QSysInfo::prettyProductName();
+    fp.initSystem = "launchd";
+#elif defined(Q_OS_UNIX)
+    // Unix que não é macOS: tratado como Linux, como o catálogo sempre fez
+    fp.family = "linux";
+    readOsRelease(root, &fp);
+    fp.initSystem = detectInitSystem(root);
+    fp.packageManager = detectPackageManager(root);
+#else
+    fp.family = "unknown";
+#endif
+
+#ifndef _WIN32
+    // Kernel e ambiente de execução só fazem sentido para o sistema em execução
+    if (root.isEmpty()) {
+        struct utsname name;
+        if (uname(&name) == 0) {
+            fp.kernelRelease = QString::fromUtf8(name.release);
+            fp.architecture = QString::fromUtf8(name.machine);
+        }
+#ifdef Q_OS_LINUX
+        fp.container = detectContainer();
+        fp.virtualization = detectVirtualization();
+#endif
+    }
+#endif
+
+    span.setArg("distro", fp.distroId);
+    return fp;
+}
+
+const PlatformFingerprint &PlatformFingerprint::current()
+{
+    // Inicialização de estático local: uma vez por processo, segura entre threads
+    static const PlatformFingerprint fingerprint = []() {
+        const PlatformFingerprint fp = detect();
+        qDebug().noquote() << "Plataforma:" << fp.family << fp.distroId << fp.versionId
+                           << fp.kernelRelease << fp.architecture
+                           << "init:" << (fp.initSystem.isEmpty() ? "?" : fp.initSystem)
+                           << "pacotes:" << (fp.packageManager.isEmpty() ? "?" : fp.packageManager)
+                           << (fp.container.isEmpty() ? QString() : "contêiner: " + fp.container)
+                           << (fp.virtualization.isEmpty() ? QString() : "vm: " + fp.virtualization);
+        return fp;
+    }();
+    return fingerprint;
+}
+
+QJsonObject PlatformFingerprint::toJson() const
+{
+    QJsonObject object;
+    object["family"] = family;
+    object["distro"] = distroId;
+    object["distro_like"] = QJsonArray::fromStringList(distroLike);
+    object["version"] = versionId;
+    object["pretty_name"] = prettyName;
+    object["kernel"] = kernelRelease;
+    object["architecture"] = architecture;
+    object["init"] = initSystem;
+    object["container"] = container;
+    object["virtualization"] = virtualization;
+    object["package_manager"] = packageManager;
+    return object;
+}
@@ -0,0 +1,247 @@
+#include "RemediationPlanner.h"
+#include <QMap>
+
+// Aspas simples para o shell
+static QString shellQuote(const QString &value)
+{
+    return "'" + QString(value).replace("'", "'\\''") + "'";
+}
+
+static void appendUnique(QStringList &list, const QString &item)
+{
+    if (!list.contains(item)) {
+        list.append(item);
+    }
+}
+
+bool RemediationPlan::isEmpty() const
+{
+    return phases.isEmpty();
+}
+
+int RemediationPlan::stepCount() const
+{
+    int count = 0;
+    for (const auto &phase : phases) {
+        count += phase.size();
+    }
+    return count;
+}
+
+QString RemediationPlan::toScript() const
+{
+    QStringList lines;
+    for (int i = 0; i < phases.size(); i++) {
+        lines.append(QString("# Fase %1").arg(i + 1));
+        for (const RemediationStep &step : phases[i]) {
+            lines.append("# " + step.description);
+            lines.append(step.command);
+        }
+    }
+    return lines.join('\n');
+}
+
+RemediationPlanner::RemediationPlanner(PackageInventory::Backend backend)
+    : m_backend(backend)
+{
+}
+
+QString RemediationPlanner::packageTransaction(const QStringList &packages, bool upgrade) const
+{
+    QStringList quoted;
+    for (const QString &package : packages) {
+        quoted.append(shellQuote(package));
+    }
+    const QString names = quoted.join(' ');
+    
+    QStringList commands;
+    switch (m_backend) {
+        case PackageInventory::Backend::Dpkg:
+            commands << "export DEBIAN_FRONTEND=noninteractive" << "apt-get update";
+            if (upgrade) {
+                commands << "apt-get upgrade -y";
+            }
+            if (!packages.isEmpty()) {
+                commands << "apt-get install -y " + names;
+            }
+            break;
+        case PackageInventory::Backend::Rpm:
+            if (upgrade) {
+                commands << "dnf upgrade -y";
+            }
+            if (!packages.isEmpty()) {
+                commands << "dnf install -y " + names;
+            }
+            break;
+        case PackageInventory::Backend::Apk:
+            commands << "apk update";
+            if (upgrade) {
+                commands << "apk upgrade";
+            }
+            if (!packages.isEmpty()) {
+                commands << "apk add " + names;
+            }
+            break;
+        case PackageInventory::Backend::None:
+            return QString();
+    }
+    
+    return commands.join(" && ");
+}
+
+RemediationPlan RemediationPlanner::plan(const QVector<VulnerabilityDefinition> &rules) const
+{
+    RemediationPlan plan;
+    
+    // Fase 1: pacotes
+    QStringList packages;
+    QStringList packageRules;
+    bool upgrade = false;
+    int packageTimeoutMs = 0;
+    
+    // Fase 2: edições por arquivo (ordem estável), um passo por regra
+    QMap<QString, QVector<RemediationStep>> fileSteps;
+    
+    // Fase 3: comandos avulsos, um passo por regra
+    QVector<RemediationStep> commandSteps;
+    
+    // Fase 4: um passo por serviço
+    QMap<QString, ServiceAction> services;
+    QMap<QString, QStringList> serviceRules;
+    
+    for (const VulnerabilityDefinition &rule : rules) {
+        appendUnique(plan.ruleIds, rule.id);
+        const Remediation &remediation = rule.remediation;
+        
+        if (remediation.isEmpty()) {
+            // Regra sem correção estruturada: o comando "fix" roda inteiro, num passo próprio
+            if (!rule.fix.isEmpty()) {
+                RemediationStep step;
+                step.description = "Corrigir " + rule.id;
+                step.command = rule.fix;
+                step.ruleIds << rule.id;
+                step.timeoutMs = rule.fixTimeoutMs;
+                commandSteps.append(step);
+            }
+            continue;
+        }
+        
+        if (!remediation.packages.isEmpty() || remediation.upgrade) {
+            for (const QString &package : remediation.packages) {
+                appendUnique(packages, package);
+            }
+            upgrade = upgrade || remediation.upgrade;
+            appendUnique(packageRules, rule.id);
+            packageTimeoutMs = qMax(packageTimeoutMs, rule.fixTimeoutMs);
+        }
+        
+        for (const FileEdit &edit : remediation.edits) {
+            QVector<RemediationStep> &steps = fileSteps[edit.file];
+            if (steps.isEmpty() || steps.last().ruleIds.first() != rule.id) {
+                const QString file = shellQuote(edit.file);
+                RemediationStep step;
+                step.description = QString("Editar %1 (%2)").arg(edit.file, rule.id);
+                if (steps.isEmpty()) {
+                    // Uma cópia de segurança por arquivo, antes da primeira edição
+                    step.command = QString("if [ -e %1 ]; then cp -a %1 %1.securitychecker.bak; fi").arg(file);
+                } else {
+                    // As regras seguintes não editam um arquivo que ficou sem cópia
+                    step.command = QString("{ [ ! -e %1 ] || [ -e %1.securitychecker.bak ]; }").arg(file);
+                }
+                step.ruleIds << rule.id;
+                step.timeoutMs = rule.fixTimeoutMs;
+                steps.append(step);
+            }
+            steps.last().command += " && ( " + edit.command + " )";
+        }
+        
+        if (!remediation.commands.isEmpty()) {
+            QStringList commands;
+            for (const QString &command : remediation.commands) {
+                commands.append("( " + command + " )");
+            }
+            RemediationStep step;
+            step.description = "Comandos de " + rule.id;
+            step.command = commands.join(" && ");
+            step.ruleIds << rule.id;
+            step.timeoutMs = rule.fixTimeoutMs;
+            commandSteps.append(step);
+        }
+        
+        for (const ServiceAction &action : remediation.services) {
+            ServiceAction &merged = services[action.name];
+            merged.name = action.name;
+            merged.enable = merged.enable || action.enable;
+            merged.restart = merged.restart || action.restart;
+            if (merged.validate.isEmpty()) {
+                merged.validate = action.validate;
+            }
+            appendUnique(serviceRules[action.name], rule.id);
+        }
+    }
+    
+    if (!packages.isEmpty() || upgrade) {
+        RemediationStep step;
+        step.command = packageTransaction(packages, upgrade);
+        if (step.command.isEmpty()) {
+            // Gerenciador desconhecido: as regras de pacote não têm como ser corrigidas
+            step.command = "echo 'Gerenciador de pacotes não suportado' >&2; false";
+        }
+        step.description = packages.isEmpty()
+            ? QString("Atualizar pacotes")
+            : QString("Instalar %1").arg(packages.join(", "));
+        step.ruleIds = packageRules;
+        step.timeoutMs = packageTimeoutMs;
+        plan.phases.append(QVector<RemediationStep>() << step);
+    }
+    
+    // Arquivos diferentes em paralelo; no mesmo arquivo, uma regra por fase,
+    // para a falha da edição de uma regra não desfazer nem marcar as outras
+    for (int round = 0; ; round++) {
+        QVector<RemediationStep> editPhase;
+        for (const QVector<RemediationStep> &steps : fileSteps) {
+            if (round < steps.size()) {
+                editPhase.append(steps[round]);
+            }
+        }
+        if (editPhase.isEmpty()) {
+            break;
+        }
+        plan.phases.append(editPhase);
+    }
+    
+    // Comandos livres podem disputar o mesmo recurso (lock do apt, mesmo
+    // arquivo): cada um é uma fase, mas o resultado de um não afeta os outros
+    for (const RemediationStep &step : commandSteps) {
+        plan.phases.append(QVector<RemediationStep>() << step);
+    }
+    
+    QVector<RemediationStep> servicePhase;
+    for (const ServiceAction &action : services) {
+        const QString unit = shellQuote(action.name);
+        QStringList parts;
+        if (!action.validate.isEmpty()) {
+            parts << action.validate;
+        }
+        if (action.enable) {
+            parts << "systemctl enable " + unit;
+        }
+        if (action.restart || action.enable) {
+            parts << "systemctl restart " + unit;
+        }
+        
+        RemediationStep step;
+        step.description = (action.validate.isEmpty() ? "Reiniciar " : "Validar e reiniciar ") + action.name;
+        step.command = parts.join(" && ");
+        step.ruleIds = serviceRules.value(action.name);
+        // Reiniciar sobre um pacote ou uma configuração que não foi aplicada
+        // pode derrubar o serviço
+        step.requiresRules = true;
+        servicePhase.append(step);
+    }
+    if (!servicePhase.isEmpty()) {
+        plan.phases.append(servicePhase);
+    }
+    
+    return plan;
+}
@@ -0,0 +1,227 @@
+#include "ResultCache.h"
+#include "PackageInventory.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QDebug>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const int CACHE_FORMAT_VERSION = 3;
+
+// Identidade de um arquivo sem ler seu conteúdo
+static QByteArray fileIdentity(const QString &path)
+{
+#ifndef _WIN32
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0) {
+        return "-";
+    }
+
+#ifdef Q_OS_LINUX
+    qint64 mtime = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    qint64 ctime = qint64(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+#else
+    qint64 mtime = st.st_mtime;
+    qint64 ctime = st.st_ctime;
+#endif
+
+    return QByteArray::number(quint64(st.st_ino)) + ':'
+           + QByteArray::number(qint64(st.st_size)) + ':'
+           + QByteArray::number(mtime) + ':'
+           + QByteArray::number(ctime) + ':'
+           + QByteArray::number(uint(st.st_mode), 8);
+#else
+    QFileInfo info(path);
+    if (!info.exists()) {
+        return "-";
+    }
+    return QByteArray::number(info.size()) + ':'
+           + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+#endif
+}
+
+ResultCache::ResultCache(const QString &filePath)
+    : m_filePath(filePath)
+    , m_dirty(false)
+{
+}
+
+QString ResultCache::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/scan-cache.json";
+}
+
+bool ResultCache::load()
+{
+    m_entries.clear();
+    m_dirty = false;
+    
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root["version"].toInt() != CACHE_FORMAT_VERSION) {
+        return false;
+    }
+    
+    const QJsonObject rules = root["rules"].toObject();
+    for (auto it = rules.begin(); it != rules.end(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        Entry entry;
+        entry.checkDigest = obj["check"].toString().toLatin1();
+        entry.inputStamp = obj["inputs"].toString().toLatin1();
+        entry.isVulnerable = obj["vulnerable"].toBool();
+        entry.evidence = obj["evidence"].toString();
+        m_entries.insert(it.key(), entry);
+    }
+    
+    qDebug() << "Cache de resultados carregado:" << m_entries.size() << "regras";
+    return true;
+}
+
+bool ResultCache::save()
+{
+    if (!m_dirty) {
+        return true;
+    }
+    
+    QJsonObject rules;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        QJsonObject obj;
+        obj["check"] = QString::fromLatin1(it->checkDigest);
+        obj["inputs"] = QString::fromLatin1(it->inputStamp);
+        obj["vulnerable"] = it->isVulnerable;
+        if (!it->evidence.isEmpty()) {
+            obj["evidence"] = it->evidence;
+        }
+        rules[it.key()] = obj;
+    }
+    
+    QJsonObject root;
+    root["version"] = CACHE_FORMAT_VERSION;
+    root["rules"] = rules;
+    
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+    
+    // Escrita atômica: uma varredura interrompida não deixa o cache pela metade
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Não foi possível gravar o cache de resultados:" << m_filePath;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        return false;
+    }
+    
+    m_dirty = false;
+    return true;
+}
+
+void ResultCache::clear()
+{
+    m_entries.clear();
+    m_dirty = true;
+}
+
+QByteArray ResultCache::inputStamp(const FactRequirements &requirements)
+{
+    // Estado de serviços e sockets não tem arquivo que o identifique e /proc muda a cada leitura
+    if (requirements.needsLiveSystem()) {
+        return QByteArray();
+    }
+    
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    
+#ifndef _WIN32
+    // Sem root, arquivos ilegíveis aparecem vazios e mudam o resultado: uma
+    // varredura como root não pode reaproveitar o de outro usuário, e vice-versa
+    hash.addData("e " + QByteArray::number(uint(::geteuid())) + '\n');
+#endif
+    
+    for (const QString &path : requirements.files) {
+        hash.addData("f " + QFile::encodeName(path) + ' ' + fileIdentity(path) + '\n');
+    }
+    
+    for (const QString &dirPath : requirements.directories) {
+        // O diretório muda quando arquivos entram ou saem; cada arquivo muda sozinho
+        hash.addData("d " + QFile::encodeName(dirPath) + ' ' + fileIdentity(dirPath) + '\n');
+        QDir dir(dirPath);
+        const QStringList names = dir.entryList(QDir::Files | QDir::Hidden, QDir::Name);
+        for (const QString &name : names) {
+            const QString path = dir.filePath(name);
+            hash.addData("  " + QFile::encodeName(path) + ' ' + fileIdentity(path) + '\n');
+        }
+    }
+    
+    for (const QString &binary : requirements.binaries) {
+        const QString resolved = QStandardPaths::findExecutable(binary);
+        hash.addData("b " + binary.toUtf8() + ' ' + QFile::encodeName(resolved) + ' '
+                     + (resolved.isEmpty() ? QByteArray("-") : fileIdentity(resolved)) + '\n');
+    }
+    
+    if (!requirements.packages.isEmpty() || !requirements.upgradable.isEmpty()) {
+        // Qualquer instalação ou remoção reescreve o banco de pacotes
+        const QStringList databases = PackageInventory::databaseFiles();
+        for (const QString &path : databases) {
+            hash.addData("p " + QFile::encodeName(path) + ' ' + fileIdentity(path) + '\n');
+        }
+    }
+    
+    if (!requirements.upgradable.isEmpty()) {
+        // "apt update" reescreve as listas de pacotes disponíveis; os pins mudam a candidata
+        const QStringList lists = PackageInventory::aptListFiles() + PackageInventory::aptPreferenceFiles();
+        for (const QString &path : lists) {
+            hash.addData("u " + QFile::encodeName(path) + ' ' + fileIdentity(path) + '\n');
+        }
+    }
+    
+    return hash.result().toHex();
+}
+
+bool ResultCache::lookup(const VulnerabilityDefinition &vuln, const QByteArray &stamp, bool *isVulnerable,
+                         QString *evidence) const
+{
+    if (stamp.isEmpty() || vuln.checkDigest.isEmpty()) {
+        return false;
+    }
+    
+    auto it = m_entries.constFind(vuln.id);
+    if (it == m_entries.constEnd() || it->checkDigest != vuln.checkDigest || it->inputStamp != stamp) {
+        return false;
+    }
+    
+    *isVulnerable = it->isVulnerable;
+    if (evidence) {
+        *evidence = it->evidence;
+    }
+    return true;
+}
+
+void ResultCache::store(const VulnerabilityDefinition &vuln, const QByteArray &stamp, bool isVulnerable,
+                        const QString &evidence)
+{
+    if (stamp.isEmpty() || vuln.checkDigest.isEmpty()) {
+        return;
+    }
+    
+    Entry entry;
+    entry.checkDigest = vuln.checkDigest;
+    entry.inputStamp = stamp;
+    entry.isVulnerable = isVulnerable;
+    entry.evidence = evidence;
+    m_entries.insert(vuln.id, entry);
+    m_dirty = true;
+}
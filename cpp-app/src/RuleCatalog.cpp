@@ -0,0 +1,446 @@
+#include "RuleCatalog.h"
+#include "CheckExpression.h"
+#include "Applicability.h"
+#include "TraceRecorder.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+
+RuleCatalog::RuleCatalog()
+{
+}
+
+QSharedPointer<RuleCatalog> RuleCatalog::fromJson(const QString &path, const QByteArray &data,
+                                                  bool strict, QString *error)
+{
+    TraceSpan span("catalog", "parseCatalog");
+    
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        *error = QString("Erro ao parsear JSON: %1").arg(parseError.errorString());
+        return QSharedPointer<RuleCatalog>();
+    }
+    if (!document.isObject()) {
+        *error = "Catálogo inválido: a raiz deve ser um objeto com uma lista de regras por sistema";
+        return QSharedPointer<RuleCatalog>();
+    }
+    
+    QSharedPointer<RuleCatalog> catalog(new RuleCatalog);
+    catalog->m_path = path;
+    catalog->m_digest = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    
+    const QJsonObject root = document.object();
+    for (auto it = root.begin(); it != root.end(); ++it) {
+        Partition &partition = catalog->m_partitions[it.key()];
+        partition.source = it.value().toArray();
+        catalog->m_systems.append(it.key());
+        
+        if (strict && !materialize(it.key(), partition, true, error)) {
+            return QSharedPointer<RuleCatalog>();
+        }
+    }
+    
+    return catalog;
+}
+
+QString RuleCatalog::path() const
+{
+    return m_path;
+}
+
+QByteArray RuleCatalog::digest() const
+{
+    return m_digest;
+}
+
+QStringList RuleCatalog::systems() const
+{
+    return m_systems;
+}
+
+bool RuleCatalog::isEmpty() const
+{
+    return m_systems.isEmpty();
+}
+
+const RuleCatalog::Partition *RuleCatalog::partition(const QString &os) const
+{
+    auto it = m_partitions.find(os);
+    if (it == m_partitions.end()) {
+        return nullptr;
+    }
+    if (!it->materialized) {
+        QString error;
+        materialize(os, *it, false, &error);
+    }
+    return &*it;
+}
+
+QVector<VulnerabilityDefinition> RuleCatalog::rules(const QString &os, RuleText fields) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Partition *p = partition(os);
+    if (!p) {
+        return QVector<VulnerabilityDefinition>();
+    }
+    if (fields == RuleText::Full) {
+        return definitions(*p, fields);
+    }
+    
+    // O catálogo é imutável: o resumo montado vale enquanto ele existir
+    if (!p->summaryBuilt) {
+        p->summary = definitions(*p, fields);
+        p->summaryBuilt = true;
+    }
+    return p->summary;
+}
+
+QVector<VulnerabilityDefinition> RuleCatalog::definitions(const Partition &partition, RuleText fields)
+{
+    QVector<VulnerabilityDefinition> result;
+    result.reserve(partition.records.size());
+    for (int i = 0; i < partition.records.size(); i++) {
+        result.append(definition(partition, i, fields));
+    }
+    return result;
+}
+
+VulnerabilityDefinition RuleCatalog::rule(const QString &os, int index, RuleText fields) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Partition *p = partition(os);
+    if (!p || index < 0 || index >= p->records.size()) {
+        return VulnerabilityDefinition();
+    }
+    if (fields == RuleText::Summary && p->summaryBuilt) {
+        return p->summary.at(index);
+    }
+    return definition(*p, index, fields);
+}
+
+int RuleCatalog::ruleCount(const QString &os) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Partition *p = partition(os);
+    return p ? p->records.size() : 0;
+}
+
+int RuleCatalog::indexOf(const QString &os, const QString &id) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Partition *p = partition(os);
+    if (!p) {
+        return -1;
+    }
+    
+    const QByteArray key = id.toUtf8();
+    auto it = std::lower_bound(p->byId.begin(), p->byId.end(), key, [p](int index, const QByteArray &wanted) {
+        return qstrcmp(p->text.utf8(p->records[index].id), wanted.constData()) < 0;
+    });
+    if (it == p->byId.end() || qstrcmp(p->text.utf8(p->records[*it].id), key.constData()) != 0) {
+        return -1;
+    }
+    return *it;
+}
+
+QVector<int> RuleCatalog::withSeverity(const QString &os, Severity severity) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Partition *p = partition(os);
+    return p ? p->bySeverity.value(int(severity)) : QVector<int>();
+}
+
+QVector<int> RuleCatalog::withTag(const QString &os, const QString &tag) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Partition *p = partition(os);
+    return p ? p->byTag.value(tag) : QVector<int>();
+}
+
+// Conteúdo de uma QString ou QStringList, sem o cabeçalho compartilhado
+static qint64 textBytes(const QString &text)
+{
+    return qint64(text.size()) * sizeof(QChar);
+}
+
+static qint64 textBytes(const QStringList &list)
+{
+    qint64 bytes = qint64(list.size()) * sizeof(QString);
+    for (const QString &text : list) {
+        bytes += textBytes(text);
+    }
+    return bytes;
+}
+
+qint64 RuleCatalog::storageBytes(const QString &os) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Partition *p = partition(os);
+    if (!p) {
+        return 0;
+    }
+    
+    qint64 bytes = p->text.size() + qint64(p->records.size()) * sizeof(RuleRecord)
+                   + qint64(p->tags.size()) * sizeof(StringArena::Ref) + qint64(p->byId.size()) * sizeof(int);
+    
+    for (auto it = p->byTag.constBegin(); it != p->byTag.constEnd(); ++it) {
+        bytes += sizeof(QString) + textBytes(it.key()) + sizeof(QVector<int>) + qint64(it->size()) * sizeof(int);
+    }
+    for (auto it = p->bySeverity.constBegin(); it != p->bySeverity.constEnd(); ++it) {
+        bytes += sizeof(int) + sizeof(QVector<int>) + qint64(it->size()) * sizeof(int);
+    }
+    
+    for (const RuleExtras &extras : p->extras) {
+        bytes += sizeof(RuleExtras) + extras.checkDigest.size() + textBytes(extras.dependsOn);
+        for (auto it = extras.skipIf.constBegin(); it != extras.skipIf.constEnd(); ++it) {
+            bytes += sizeof(QString) + textBytes(it.key()) + sizeof(bool);
+        }
+    }
+    
+    // O resumo só tem id e nome; o resto de cada regra aponta para o catálogo
+    if (p->summaryBuilt) {
+        for (const VulnerabilityDefinition &def : p->summary) {
+            bytes += sizeof(VulnerabilityDefinition) + textBytes(def.id) + textBytes(def.name);
+        }
+    }
+    return bytes;
+}
+
+bool RuleCatalog::materialize(const QString &os, Partition &partition, bool strict, QString *error)
+{
+    TraceSpan span("catalog", "materialize");
+    span.setArg("os", os);
+    
+    // Só durante a construção; a partição guarda apenas o índice ordenado
+    QSet<QString> ids;
+    partition.records.reserve(partition.source.size());
+    for (const QJsonValue &value : partition.source) {
+        if (!value.isObject()) continue;
+        
+        QString checkError;
+        VulnerabilityDefinition def = parseRule(value.toObject(), &checkError);
+        
+        // Ids repetidos confundiriam dependências, cache e relatórios
+        QString problem;
+        if (def.id.isEmpty()) {
+            problem = QString("regra sem \"id\" em \"%1\"").arg(os);
+        } else if (ids.contains(def.id)) {
+            problem = QString("\"id\" repetido em \"%1\": %2").arg(os, def.id);
+        }
+        if (!problem.isEmpty()) {
+            if (strict) {
+                *error = "Catálogo inválido: " + problem;
+                return false;
+            }
+            qWarning().noquote() << "Regra ignorada:" << problem;
+            continue;
+        }
+        ids.insert(def.id);
+        
+        if (!checkError.isEmpty()) {
+            if (strict) {
+                *error = QString("Verificação inválida em %1: %2").arg(def.id, checkError);
+                return false;
+            }
+            qWarning() << "Verificação inválida em" << def.id << ":" << checkError;
+        }
+        
+        store(partition, def);
+    }
+    
+    partition.byId.reserve(partition.records.size());
+    for (int i = 0; i < partition.records.size(); i++) {
+        partition.byId.append(i);
+    }
+    const Partition &built = partition;
+    std::sort(partition.byId.begin(), partition.byId.end(), [&built](int a, int b) {
+        return qstrcmp(built.text.utf8(built.records[a].id), built.text.utf8(built.records[b].id)) < 0;
+    });
+    
+    partition.text.squeeze();
+    partition.records.squeeze();
+    partition.extras.squeeze();
+    partition.tags.squeeze();
+    partition.source = QJsonArray();
+    partition.materialized = true;
+    span.setArg("rules", partition.records.size());
+    span.setArg("text_bytes", partition.text.size());
+    return true;
+}
+
+void RuleCatalog::store(Partition &partition, const VulnerabilityDefinition &def)
+{
+    const int index = partition.records.size();
+    
+    RuleRecord record;
+    record.id = partition.text.intern(def.id);
+    record.name = partition.text.intern(def.name);
+    record.description = partition.text.intern(def.description);
+    record.impact = partition.text.intern(def.impact);
+    record.fix = partition.text.intern(def.fix);
+    record.firstTag = partition.tags.size();
+    record.tagCount = quint16(qMin(def.tags.size(), 0xffff));
+    record.severity = quint8(def.severity);
+    record.checkTimeoutMs = def.checkTimeoutMs;
+    record.fixTimeoutMs = def.fixTimeoutMs;
+    record.extras = -1;
+    
+    for (int i = 0; i < record.tagCount; i++) {
+        partition.tags.append(partition.text.intern(def.tags[i]));
+        partition.byTag[def.tags[i]].append(index);
+    }
+    partition.bySeverity[int(def.severity)].append(index);
+    
+    if (def.check || !def.remediation.isEmpty() || !def.dependsOn.isEmpty() || !def.skipIf.isEmpty()
+        || def.applicability) {
+        RuleExtras extras;
+        extras.check = def.check;
+        extras.checkDigest = def.checkDigest;
+        extras.remediation = def.remediation;
+        extras.dependsOn = def.dependsOn;
+        extras.skipIf = def.skipIf;
+        extras.applicability = def.applicability;
+        record.extras = partition.extras.size();
+        partition.extras.append(extras);
+    }
+    
+    partition.records.append(record);
+}
+
+VulnerabilityDefinition RuleCatalog::definition(const Partition &partition, int index, RuleText fields)
+{
+    const RuleRecord &record = partition.records[index];
+    VulnerabilityDefinition def;
+    
+    def.id = partition.text.text(record.id);
+    def.name = partition.text.text(record.name);
+    def.severity = Severity(record.severity);
+    def.checkTimeoutMs = record.checkTimeoutMs;
+    def.fixTimeoutMs = record.fixTimeoutMs;
+    
+    if (fields == RuleText::Full) {
+        def.description = partition.text.text(record.description);
+        def.impact = partition.text.text(record.impact);
+        def.fix = partition.text.text(record.fix);
+        for (int i = 0; i < record.tagCount; i++) {
+            def.tags.append(partition.text.text(partition.tags[record.firstTag + i]));
+        }
+    }
+    
+    if (record.extras >= 0) {
+        const RuleExtras &extras = partition.extras[record.extras];
+        def.check = extras.check;
+        def.checkDigest = extras.checkDigest;
+        def.remediation = extras.remediation;
+        def.dependsOn = extras.dependsOn;
+        def.skipIf = extras.skipIf;
+        def.applicability = extras.applicability;
+    }
+    
+    return def;
+}
+
+VulnerabilityDefinition RuleCatalog::parseRule(const QJsonObject &obj, QString *checkError)
+{
+    VulnerabilityDefinition def;
+    
+    def.id = obj["id"].toString();
+    def.name = obj["name"].toString();
+    def.description = obj["description"].toString();
+    def.impact = obj["impact"].toString();
+    def.severity = stringToSeverity(obj["severity"].toString());
+    def.fix = obj["fix"].toString();
+    def.checkTimeoutMs = obj["timeout"].toInt() * 1000;
+    def.fixTimeoutMs = obj["fix_timeout"].toInt() * 1000;
+    for (const QJsonValue &tag : obj["tags"].toArray()) {
+        def.tags.append(tag.toString());
+    }
+    
+    const QJsonObject remediation = obj["remediation"].toObject();
+    for (const QJsonValue &package : remediation["packages"].toArray()) {
+        def.remediation.packages.append(package.toString());
+    }
+    def.remediation.upgrade = remediation["upgrade"].toBool();
+    for (const QJsonValue &value : remediation["edits"].toArray()) {
+        const QJsonObject editObj = value.toObject();
+        FileEdit edit;
+        edit.file = editObj["file"].toString();
+        edit.command = editObj["command"].toString();
+        def.remediation.edits.append(edit);
+    }
+    for (const QJsonValue &command : remediation["commands"].toArray()) {
+        def.remediation.commands.append(command.toString());
+    }
+    for (const QJsonValue &value : remediation["services"].toArray()) {
+        const QJsonObject serviceObj = value.toObject();
+        ServiceAction action;
+        action.name = serviceObj["name"].toString();
+        action.enable = serviceObj["enable"].toBool();
+        action.restart = serviceObj["restart"].toBool();
+        action.validate = serviceObj["validate"].toString();
+        def.remediation.services.append(action);
+    }
+    
+    for (const QJsonValue &dep : obj["depends_on"].toArray()) {
+        def.dependsOn.append(dep.toString());
+    }
+    
+    // "skip_if": {"ID": "vulnerable" | "safe"} também cria a dependência
+    const QJsonObject skipIf = obj["skip_if"].toObject();
+    for (auto it = skipIf.begin(); it != skipIf.end(); ++it) {
+        const QString outcome = it.value().toString();
+        if (outcome != "vulnerable" && outcome != "safe") {
+            if (checkError->isEmpty()) {
+                *checkError = QString("\"skip_if\": resultado inválido para %1 (use \"vulnerable\" ou \"safe\")").arg(it.key());
+            }
+            continue;
+        }
+        def.skipIf.insert(it.key(), outcome == "vulnerable");
+        if (!def.dependsOn.contains(it.key())) {
+            def.dependsOn.append(it.key());
+        }
+    }
+    
+    if (obj.contains("applies_to")) {
+        QString applicabilityError;
+        def.applicability = Applicability::fromJson(obj["applies_to"], &applicabilityError);
+        if (!def.applicability && checkError->isEmpty()) {
+            *checkError = "\"applies_to\": " + applicabilityError;
+        }
+    }
+    
+    if (obj.contains("check")) {
+        def.check = CheckExpression::fromJson(obj["check"], checkError);
+        if (def.check) {
+            def.checkDigest = QCryptographicHash::hash(
+                QJsonDocument(obj["check"].toObject()).toJson(QJsonDocument::Compact),
+                QCryptographicHash::Sha1).toHex();
+        }
+    }
+    
+    return def;
+}
+
+Severity RuleCatalog::stringToSeverity(const QString &severityStr)
+{
+    if (severityStr == "Alta") return Severity::Alta;
+    if (severityStr == "Média") return Severity::Media;
+    if (severityStr == "Baixa") return Severity::Baixa;
+    return Severity::Media;
+}
+
+QString RuleCatalog::severityToString(Severity severity)
+{
+    switch (severity) {
+        case Severity::Alta: return "Alta";
+        case Severity::Media: return "Média";
+        case Severity::Baixa: return "Baixa";
+        default: return "Média";
+    }
+}
@@ -0,0 +1,291 @@
+#include "RuleWatcher.h"
+#include "CheckExpression.h"
+#include "PackageInventory.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+// Edições no lugar, substituições por rename, criação, remoção e chmod/chown
+static const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE
+                                   | IN_DELETE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+const int RuleWatcher::DEFAULT_QUIET_MS = 250;
+const int RuleWatcher::DEFAULT_MAX_DELAY_MS = 2000;
+
+RuleWatcher::RuleWatcher(QObject *parent)
+    : QObject(parent)
+    , m_fd(-1)
+    , m_notifier(nullptr)
+    , m_debounce(new QTimer(this))
+    , m_maxDelayMs(DEFAULT_MAX_DELAY_MS)
+    , m_rebuildPending(false)
+{
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(DEFAULT_QUIET_MS);
+    connect(m_debounce, &QTimer::timeout, this, &RuleWatcher::onDebounceTimeout);
+}
+
+RuleWatcher::~RuleWatcher()
+{
+    stop();
+}
+
+void RuleWatcher::setDebounce(int quietMs, int maxDelayMs)
+{
+    m_debounce->setInterval(qMax(0, quietMs));
+    m_maxDelayMs = qMax(quietMs, maxDelayMs);
+}
+
+bool RuleWatcher::isWatching() const
+{
+    return m_fd >= 0;
+}
+
+QStringList RuleWatcher::unwatchedRules() const
+{
+    return m_unwatched;
+}
+
+void RuleWatcher::addTarget(QHash<QString, QStringList> &targets, const QString &path, const QString &id)
+{
+    QStringList &ids = targets[QDir::cleanPath(path)];
+    if (!ids.contains(id)) {
+        ids.append(id);
+    }
+}
+
+bool RuleWatcher::watch(const QVector<VulnerabilityDefinition> &rules)
+{
+    stop();
+
+#ifdef Q_OS_LINUX
+    const QStringList pathDirs = qEnvironmentVariable("PATH").split(':', Qt::SkipEmptyParts);
+    
+    for (const VulnerabilityDefinition &rule : rules) {
+        if (!rule.check || rule.check->isShell()) {
+            m_unwatched.append(rule.id);
+            continue;
+        }
+        
+        const FactRequirements req = rule.check->requirements();
+        if (req.needsLiveSystem()) {
+            m_unwatched.append(rule.id);
+            continue;
+        }
+        
+        for (const QString &path : req.files) {
+            addTarget(m_fileRules, path, rule.id);
+        }
+        for (const QString &dir : req.directories) {
+            addTarget(m_dirRules, dir, rule.id);
+        }
+        // Um binário pode aparecer em qualquer diretório do PATH
+        for (const QString &binary : req.binaries) {
+            for (const QString &dir : pathDirs) {
+                addTarget(m_fileRules, dir + '/' + binary, rule.id);
+            }
+        }
+        if (!req.packages.isEmpty() || !req.upgradable.isEmpty()) {
+            const QStringList databases = PackageInventory::databaseFiles();
+            for (const QString &path : databases) {
+                addTarget(m_fileRules, path, rule.id);
+            }
+        }
+        if (!req.upgradable.isEmpty()) {
+            addTarget(m_dirRules, PackageInventory::aptListsDirectory(), rule.id);
+        }
+    }
+    
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning() << "inotify indisponível:" << strerror(errno);
+        return false;
+    }
+    
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &RuleWatcher::onEvents);
+    
+    rebuildWatches();
+    qDebug() << "Observando" << m_watches.size() << "diretórios para"
+             << rules.size() - m_unwatched.size() << "regras";
+    return true;
+#else
+    for (const VulnerabilityDefinition &rule : rules) {
+        m_unwatched.append(rule.id);
+    }
+    qWarning() << "Modo de observação disponível apenas no Linux";
+    return false;
+#endif
+}
+
+void RuleWatcher::stop()
+{
+    m_debounce->stop();
+    delete m_notifier;
+    m_notifier = nullptr;
+
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+#endif
+
+    m_fd = -1;
+    m_watches.clear();
+    m_fileRules.clear();
+    m_dirRules.clear();
+    m_dirtyRules.clear();
+    m_unwatched.clear();
+    m_rebuildPending = false;
+}
+
+void RuleWatcher::rebuildWatches()
+{
+#ifdef Q_OS_LINUX
+    m_rebuildPending = false;
+    
+    for (auto it = m_watches.begin(); it != m_watches.end(); ++it) {
+        inotify_rm_watch(m_fd, it.key());
+    }
+    m_watches.clear();
+    
+    // Arquivos pelo diretório pai; diretórios por eles mesmos. O que ainda não
+    // existe é observado pelo ancestral mais próximo até ser criado.
+    QSet<QString> dirs;
+    auto nearestExisting = [](QString dir) {
+        while (!QFileInfo(dir).isDir() && dir != "/") {
+            dir = QFileInfo(dir).path();
+        }
+        return dir;
+    };
+    for (auto it = m_fileRules.begin(); it != m_fileRules.end(); ++it) {
+        dirs.insert(nearestExisting(QFileInfo(it.key()).path()));
+    }
+    for (auto it = m_dirRules.begin(); it != m_dirRules.end(); ++it) {
+        dirs.insert(nearestExisting(it.key()));
+    }
+    
+    for (const QString &dir : dirs) {
+        int wd = inotify_add_watch(m_fd, QFile::encodeName(dir).constData(), WATCH_MASK);
+        if (wd < 0) {
+            qWarning() << "Não foi possível observar" << dir << strerror(errno);
+            continue;
+        }
+        m_watches.insert(wd, dir);
+    }
+#endif
+}
+
+void RuleWatcher::markDirty(const QString &path, const QString &watchedDir)
+{
+    auto mark = [this](const QStringList &ids) {
+        for (const QString &id : ids) {
+            m_dirtyRules.insert(id);
+        }
+    };
+    
+    mark(m_fileRules.value(path));
+    mark(m_dirRules.value(path));
+    mark(m_dirRules.value(watchedDir));
+    
+    // Um ancestral de algum alvo foi criado, removido ou renomeado
+    const QString prefix = path + '/';
+    for (const QHash<QString, QStringList> *targets : { &m_fileRules, &m_dirRules }) {
+        for (auto it = targets->begin(); it != targets->end(); ++it) {
+            if (it.key().startsWith(prefix)) {
+                mark(it.value());
+                m_rebuildPending = true;
+            }
+        }
+    }
+}
+
+void RuleWatcher::onEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buffer[8192];
+    
+    while (true) {
+        ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break; // EAGAIN: fila esvaziada
+        }
+        
+        for (char *p = buffer; p < buffer + length; ) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(p);
+            p += sizeof(inotify_event) + event->len;
+            
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Eventos perdidos: reavaliar tudo que é observado
+                qWarning() << "Fila do inotify transbordou; reavaliando todas as regras observadas";
+                for (const QHash<QString, QStringList> *targets : { &m_fileRules, &m_dirRules }) {
+                    for (const QStringList &ids : *targets) {
+                        for (const QString &id : ids) {
+                            m_dirtyRules.insert(id);
+                        }
+                    }
+                }
+                m_rebuildPending = true;
+                continue;
+            }
+            
+            const QString dir = m_watches.value(event->wd);
+            if (dir.isEmpty()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                m_watches.remove(event->wd);
+                m_rebuildPending = true;
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                m_rebuildPending = true;
+            }
+            
+            QString path = dir;
+            if (event->len > 0) {
+                path = (dir.endsWith('/') ? dir : dir + '/') + QFile::decodeName(event->name);
+            }
+            markDirty(path, dir);
+        }
+    }
+    
+    if (m_dirtyRules.isEmpty() && !m_rebuildPending) {
+        return;
+    }
+    
+    // Reinicia a espera a cada evento, mas uma rajada longa não adia além do limite
+    if (!m_debounce->isActive()) {
+        m_burst.start();
+    }
+    if (m_burst.elapsed() < m_maxDelayMs) {
+        m_debounce->start();
+    }
+#endif
+}
+
+void RuleWatcher::onDebounceTimeout()
+{
+    if (m_rebuildPending) {
+        rebuildWatches();
+    }
+    
+    if (m_dirtyRules.isEmpty()) {
+        return;
+    }
+    
+    QStringList ids = m_dirtyRules.values();
+    ids.sort();
+    m_dirtyRules.clear();
+    
+    qDebug() << "Entradas alteradas; reavaliando" << ids;
+    emit rulesChanged(ids);
+}
@@ -0,0 +1,1005 @@
+#include "ScapImporter.h"
+#include "TraceRecorder.h"
+#include <QFile>
+#include <QDir>
+#include <QSet>
+#include <QRegularExpression>
+#include <QXmlStreamReader>
+
+const int ScapImporter::MAX_TEXT_LENGTH = 2000;
+const int ScapImporter::MAX_TAGS = 16;
+
+// Profundidade máxima de extend_definition; conteúdo malformado pode ter ciclos
+static const int MAX_DEFINITION_DEPTH = 32;
+
+static const QString XSI_NAMESPACE = QStringLiteral("http://www.w3.org/2001/XMLSchema-instance");
+
+// Tipos OVAL com primitiva nativa, como "namespace:tipo"
+static const QString TEXTFILECONTENT = QStringLiteral("independent:textfilecontent54");
+static const QString FILE_KIND = QStringLiteral("unix:file");
+static const QString RPMINFO = QStringLiteral("linux:rpminfo");
+static const QString DPKGINFO = QStringLiteral("linux:dpkginfo");
+static const QString SYSCTL = QStringLiteral("unix:sysctl");
+static const QStringList SUPPORTED_KINDS = { TEXTFILECONTENT, FILE_KIND, RPMINFO, DPKGINFO, SYSCTL };
+
+// Distribuições conhecidas: produto do CPE, nome no "affected" do OVAL e ID do os-release
+struct DistroName {
+    const char *cpe;
+    const char *label;
+    const char *id;
+};
+
+static const DistroName DISTROS[] = {
+    { "redhat:enterprise_linux", "Red Hat Enterprise Linux", "rhel" },
+    { "centos:centos", "CentOS", "centos" },
+    { "fedoraproject:fedora", "Fedora", "fedora" },
+    { "oracle:linux", "Oracle Linux", "ol" },
+    { "rocky:rocky", "Rocky Linux", "rocky" },
+    { "almalinux:almalinux", "AlmaLinux", "almalinux" },
+    { "amazon:linux", "Amazon Linux", "amzn" },
+    { "canonical:ubuntu_linux", "Ubuntu", "ubuntu" },
+    { "debian:debian_linux", "Debian", "debian" },
+    { "suse:linux_enterprise_server", "SUSE Linux Enterprise Server", "sles" },
+    { "opensuse:leap", "openSUSE Leap", "opensuse-leap" },
+};
+
+static bool is(const QXmlStreamReader &xml, const char *name)
+{
+    return xml.name() == QLatin1String(name);
+}
+
+static QString attribute(const QXmlStreamReader &xml, const char *name)
+{
+    return xml.attributes().value(QLatin1String(name)).toString();
+}
+
+// "independent:textfilecontent54" a partir do namespace e do nome sem o sufixo
+static QString ovalKind(const QXmlStreamReader &xml, const QString &suffix)
+{
+    const QString ns = xml.namespaceUri().toString();
+    QString name = xml.name().toString();
+    if (name.endsWith(suffix)) {
+        name.chop(suffix.size());
+    }
+    return ns.mid(ns.lastIndexOf('#') + 1) + ':' + name;
+}
+
+static QString severityName(const QString &scapSeverity)
+{
+    // XCCDF usa high/medium/low; avisos OVAL, Critical/Important/Moderate/Low
+    const QString severity = scapSeverity.toLower();
+    if (severity == "high" || severity == "critical" || severity == "important") {
+        return "Alta";
+    }
+    if (severity == "low" || severity == "info") {
+        return "Baixa";
+    }
+    return "Média";
+}
+
+// CPE 2.2 (cpe:/o:redhat:enterprise_linux:8), CPE 2.3 ou o texto de "affected"
+// ("Ubuntu 22.04 LTS") para o ID e a versão do os-release
+static bool platformDistro(const QString &platform, QString *distro, QString *version)
+{
+    QString candidate;
+    bool found = false;
+    
+    if (platform.startsWith("cpe:")) {
+        const QStringList fields = platform.split(':');
+        const int vendor = platform.startsWith("cpe:2.3:") ? 3 : 2;
+        const QString product = fields.value(vendor) + ':' + fields.value(vendor + 1);
+        for (const DistroName &name : DISTROS) {
+            if (product == QLatin1String(name.cpe)) {
+                *distro = QLatin1String(name.id);
+                candidate = fields.value(vendor + 2);
+                found = true;
+                break;
+            }
+        }
+    } else {
+        for (const DistroName &name : DISTROS) {
+            const QString label = QLatin1String(name.label);
+            if (platform.startsWith(label)) {
+                *distro = QLatin1String(name.id);
+                candidate = platform.mid(label.size()).trimmed().section(' ', 0, 0);
+                found = true;
+                break;
+            }
+        }
+    }
+    
+    static const QRegularExpression VERSION("^[0-9]+(\\.[0-9]+)*$");
+    *version = VERSION.match(candidate).hasMatch() ? candidate : QString();
+    return found;
+}
+
+// Plataformas locais do benchmark (#package_openssh-server, #grub2...) são
+// condições sobre o sistema que o "applies_to" não expressa; só #machine tem
+// equivalente. Retorna a primeira sem tradução
+static QString unsupportedPlatform(const QStringList &platforms)
+{
+    for (const QString &platform : platforms) {
+        if (platform.startsWith('#') && platform != "#machine") {
+            return platform;
+        }
+    }
+    return QString();
+}
+
+static QJsonValue combine(const char *op, const QJsonArray &items)
+{
+    if (items.size() == 1) {
+        return items.first();
+    }
+    QJsonObject obj;
+    obj[QLatin1String(op)] = items;
+    return obj;
+}
+
+static QJsonObject negated(const QJsonValue &expr)
+{
+    QJsonObject obj;
+    obj["not"] = expr;
+    return obj;
+}
+
+ScapImporter::ScapImporter()
+{
+}
+
+bool ScapImporter::addFile(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("Não foi possível abrir %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return addDevice(&file, path, error);
+}
+
+bool ScapImporter::addDevice(QIODevice *device, const QString &name, QString *error)
+{
+    TraceSpan span("scap", "import");
+    span.setArg("file", name);
+    
+    // Só os elementos de interesse são descidos; o resto do documento (data
+    // stream, dicionário CPE, OCIL) passa pelo leitor sem ficar em memória
+    QXmlStreamReader xml(device);
+    bool found = false;
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (is(xml, "Benchmark")) {
+            parseXccdfContainer(xml, QStringList());
+            found = true;
+        } else if (is(xml, "oval_definitions")) {
+            parseOval(xml);
+            found = true;
+        }
+    }
+    
+    if (xml.hasError()) {
+        *error = QString("%1:%2: %3").arg(name).arg(xml.lineNumber()).arg(xml.errorString());
+        return false;
+    }
+    if (!found) {
+        *error = QString("%1: nenhum benchmark XCCDF ou definição OVAL").arg(name);
+        return false;
+    }
+    span.setArg("rules", m_rules.size());
+    span.setArg("definitions", m_definitions.size());
+    return true;
+}
+
+const QVector<ScapSkip> &ScapImporter::skipped() const
+{
+    return m_skipped;
+}
+
+void ScapImporter::parseXccdfContainer(QXmlStreamReader &xml, QStringList platforms)
+{
+    // Plataformas do benchmark e dos grupos valem para tudo abaixo deles; no
+    // XCCDF elas vêm antes dos grupos e regras filhos
+    while (xml.readNextStartElement()) {
+        if (is(xml, "platform")) {
+            platforms.append(attribute(xml, "idref"));
+            xml.skipCurrentElement();
+        } else if (is(xml, "Group")) {
+            parseXccdfContainer(xml, platforms);
+        } else if (is(xml, "Rule")) {
+            parseXccdfRule(xml, platforms);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+void ScapImporter::parseXccdfRule(QXmlStreamReader &xml, const QStringList &platforms)
+{
+    XccdfRule rule;
+    rule.id = attribute(xml, "id");
+    rule.severity = attribute(xml, "severity");
+    rule.platforms = platforms;
+    
+    while (xml.readNextStartElement()) {
+        if (is(xml, "title")) {
+            rule.title = readText(xml);
+        } else if (is(xml, "description")) {
+            rule.description = readText(xml);
+        } else if (is(xml, "rationale")) {
+            rule.rationale = readText(xml);
+        } else if (is(xml, "platform")) {
+            rule.platforms.append(attribute(xml, "idref"));
+            xml.skipCurrentElement();
+        } else if (is(xml, "ident")) {
+            rule.idents.append(readText(xml));
+        } else if (is(xml, "check") && attribute(xml, "system").contains("oval") && rule.ovalRef.isEmpty()) {
+            while (xml.readNextStartElement()) {
+                if (is(xml, "check-content-ref") && rule.ovalRef.isEmpty()) {
+                    rule.ovalRef = attribute(xml, "name");
+                }
+                xml.skipCurrentElement();
+            }
+            if (rule.ovalRef.isEmpty()) {
+                rule.problem = "verificação OVAL sem definição indicada";
+            }
+        } else if (is(xml, "complex-check")) {
+            rule.problem = "complex-check";
+            xml.skipCurrentElement();
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    
+    if (!rule.ovalRef.isEmpty()) {
+        rule.problem.clear();
+    }
+    m_rules.append(rule);
+}
+
+void ScapImporter::parseOval(QXmlStreamReader &xml)
+{
+    while (xml.readNextStartElement()) {
+        const bool definitions = is(xml, "definitions");
+        const bool tests = is(xml, "tests");
+        const bool objects = is(xml, "objects");
+        const bool states = is(xml, "states");
+        const bool variables = is(xml, "variables");
+        if (!definitions && !tests && !objects && !states && !variables) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        
+        while (xml.readNextStartElement()) {
+            if (definitions) {
+                if (is(xml, "definition")) {
+                    parseDefinition(xml);
+                } else {
+                    xml.skipCurrentElement();
+                }
+            } else if (tests) {
+                parseTest(xml);
+            } else if (objects) {
+                parseObject(xml);
+            } else if (states) {
+                parseState(xml);
+            } else {
+                parseVariable(xml);
+            }
+        }
+    }
+}
+
+void ScapImporter::parseDefinition(QXmlStreamReader &xml)
+{
+    const QString id = attribute(xml, "id");
+    OvalDefinition def;
+    def.cls = attribute(xml, "class");
+    def.deprecated = attribute(xml, "deprecated") == "true";
+    
+    while (xml.readNextStartElement()) {
+        if (is(xml, "metadata")) {
+            while (xml.readNextStartElement()) {
+                if (is(xml, "title")) {
+                    def.title = readText(xml);
+                } else if (is(xml, "description")) {
+                    def.description = readText(xml);
+                } else if (is(xml, "affected")) {
+                    while (xml.readNextStartElement()) {
+                        if (is(xml, "platform")) {
+                            def.platforms.append(readText(xml));
+                        } else {
+                            xml.skipCurrentElement();
+                        }
+                    }
+                } else if (is(xml, "reference")) {
+                    if (attribute(xml, "source") == "CVE" && def.references.size() < MAX_TAGS) {
+                        def.references.append(attribute(xml, "ref_id"));
+                    }
+                    xml.skipCurrentElement();
+                } else if (is(xml, "advisory")) {
+                    while (xml.readNextStartElement()) {
+                        if (is(xml, "severity")) {
+                            def.severity = readText(xml);
+                        } else {
+                            xml.skipCurrentElement();
+                        }
+                    }
+                } else {
+                    xml.skipCurrentElement();
+                }
+            }
+        } else if (is(xml, "criteria")) {
+            def.criteria = parseCriteria(xml, &def.problem);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    
+    if (!m_definitions.contains(id)) {
+        m_definitionOrder.append(id);
+    }
+    m_definitions.insert(id, def);
+}
+
+ScapImporter::Criteria ScapImporter::parseCriteria(QXmlStreamReader &xml, QString *problem)
+{
+    Criteria criteria;
+    const QString op = attribute(xml, "operator");
+    criteria.kind = op == "OR" ? Criteria::Kind::Any : Criteria::Kind::All;
+    criteria.negate = attribute(xml, "negate") == "true";
+    if (!op.isEmpty() && op != "AND" && op != "OR") {
+        *problem = QString("operador %1 em criteria").arg(op);
+    }
+    
+    while (xml.readNextStartElement()) {
+        if (is(xml, "criteria")) {
+            criteria.children.append(parseCriteria(xml, problem));
+            continue;
+        }
+        
+        Criteria leaf;
+        leaf.negate = attribute(xml, "negate") == "true";
+        if (is(xml, "criterion")) {
+            leaf.kind = Criteria::Kind::Test;
+            leaf.ref = attribute(xml, "test_ref");
+            criteria.children.append(leaf);
+        } else if (is(xml, "extend_definition")) {
+            leaf.kind = Criteria::Kind::Definition;
+            leaf.ref = attribute(xml, "definition_ref");
+            criteria.children.append(leaf);
+        }
+        xml.skipCurrentElement();
+    }
+    
+    return criteria;
+}
+
+void ScapImporter::parseTest(QXmlStreamReader &xml)
+{
+    const QString id = attribute(xml, "id");
+    const QString kind = ovalKind(xml, "_test");
+    if (!SUPPORTED_KINDS.contains(kind)) {
+        m_unsupported.insert(id, "teste " + xml.name().toString());
+        xml.skipCurrentElement();
+        return;
+    }
+    
+    OvalTest test;
+    test.kind = kind;
+    test.existence = attribute(xml, "check_existence");
+    if (test.existence.isEmpty()) {
+        test.existence = "at_least_one_exists";
+    }
+    test.check = attribute(xml, "check");
+    
+    QString problem;
+    while (xml.readNextStartElement()) {
+        if (is(xml, "object")) {
+            test.objectRef = attribute(xml, "object_ref");
+        } else if (is(xml, "state")) {
+            if (!test.stateRef.isEmpty()) {
+                problem = "teste com mais de um estado";
+            }
+            test.stateRef = attribute(xml, "state_ref");
+        }
+        xml.skipCurrentElement();
+    }
+    
+    if (!problem.isEmpty()) {
+        m_unsupported.insert(id, problem);
+        return;
+    }
+    m_tests.insert(id, test);
+}
+
+void ScapImporter::parseObject(QXmlStreamReader &xml)
+{
+    const QString id = attribute(xml, "id");
+    const QString kind = ovalKind(xml, "_object");
+    const QString element = xml.name().toString();
+    if (!SUPPORTED_KINDS.contains(kind)) {
+        // O teste que o usa já ficou como não suportado
+        xml.skipCurrentElement();
+        return;
+    }
+    
+    OvalObject object;
+    object.kind = kind;
+    QString directory;
+    QString filename;
+    bool hasFilename = false;
+    QString problem;
+    
+    while (xml.readNextStartElement()) {
+        const QString field = xml.name().toString();
+        if (field == "behaviors" || field == "notes") {
+            xml.skipCurrentElement();
+            continue;
+        }
+        if (field == "set" || field == "filter") {
+            problem = QString("%1 em %2").arg(field, element);
+            xml.skipCurrentElement();
+            continue;
+        }
+        
+        const QString operation = attribute(xml, "operation");
+        const QString varRef = attribute(xml, "var_ref");
+        const bool nil = xml.attributes().value(XSI_NAMESPACE, QLatin1String("nil")) == QLatin1String("true");
+        const QString text = xml.readElementText();
+        const bool equals = operation.isEmpty() || operation == "equals";
+        
+        if (field == "pattern") {
+            if (operation != "pattern match" || !varRef.isEmpty()) {
+                problem = QString("pattern de %1 sem \"pattern match\" literal").arg(element);
+            }
+            object.pattern = text;
+        } else if (field == "instance") {
+            // instance = 1: só a primeira ocorrência; >= 1: cada ocorrência é um item
+            if (text.trimmed() != "1" || (!equals && operation != "greater than or equal")) {
+                problem = QString("instance de %1 diferente de 1").arg(element);
+            }
+            object.firstInstance = equals;
+        } else if (field == "filepath" || field == "path" || field == "filename" || field == "name") {
+            if (!equals) {
+                problem = QString("%1.%2 com operação \"%3\"").arg(element, field, operation);
+            } else if (!varRef.isEmpty() && (field == "path" || field == "filename")) {
+                problem = QString("variável em %1.%2").arg(element, field);
+            } else if (!varRef.isEmpty()) {
+                object.varRef = varRef;
+            } else if (field == "path") {
+                directory = text;
+            } else if (field == "filename") {
+                // xsi:nil: o próprio diretório
+                hasFilename = !nil;
+                filename = text;
+            } else {
+                object.targets.append(text);
+            }
+        } else {
+            problem = QString("%1.%2").arg(element, field);
+        }
+    }
+    
+    if (!directory.isEmpty()) {
+        object.targets.append(QDir::cleanPath(hasFilename ? directory + '/' + filename : directory));
+    }
+    if (problem.isEmpty() && kind == TEXTFILECONTENT) {
+        if (object.pattern.isEmpty()) {
+            problem = QString("%1 sem pattern").arg(element);
+        } else if (!QRegularExpression(object.pattern, QRegularExpression::MultilineOption).isValid()) {
+            problem = "expressão regular incompatível";
+        }
+    }
+    
+    if (!problem.isEmpty()) {
+        m_unsupported.insert(id, problem);
+        return;
+    }
+    m_objects.insert(id, object);
+}
+
+void ScapImporter::parseState(QXmlStreamReader &xml)
+{
+    const QString id = attribute(xml, "id");
+    const QString kind = ovalKind(xml, "_state");
+    const QString element = xml.name().toString();
+    if (!SUPPORTED_KINDS.contains(kind)) {
+        xml.skipCurrentElement();
+        return;
+    }
+    
+    static const QHash<QString, int> PERMISSION_BITS = {
+        { "suid", 04000 }, { "sgid", 02000 }, { "sticky", 01000 },
+        { "uread", 0400 }, { "uwrite", 0200 }, { "uexec", 0100 },
+        { "gread", 040 }, { "gwrite", 020 }, { "gexec", 010 },
+        { "oread", 04 }, { "owrite", 02 }, { "oexec", 01 }
+    };
+    
+    // Único campo traduzível de cada tipo, com a operação esperada
+    QString valueField;
+    QString valueOperation = "equals";
+    if (kind == TEXTFILECONTENT) {
+        valueField = "subexpression";
+    } else if (kind == RPMINFO || kind == DPKGINFO) {
+        valueField = "evr";
+        valueOperation = "less than";
+    } else if (kind == SYSCTL) {
+        valueField = "value";
+    }
+    
+    OvalState state;
+    state.kind = kind;
+    QString problem;
+    
+    while (xml.readNextStartElement()) {
+        const QString field = xml.name().toString();
+        QString operation = attribute(xml, "operation");
+        if (operation.isEmpty()) {
+            operation = "equals";
+        }
+        const QString varRef = attribute(xml, "var_ref");
+        const QString text = xml.readElementText().trimmed();
+        
+        if (kind == FILE_KIND && PERMISSION_BITS.contains(field) && operation == "equals" && varRef.isEmpty()) {
+            const int bit = PERMISSION_BITS.value(field);
+            state.mask |= bit;
+            if (text == "true" || text == "1") {
+                state.mode |= bit;
+            }
+        } else if (field == valueField && operation == valueOperation) {
+            state.value = text;
+            state.varRef = varRef;
+        } else {
+            problem = QString("%1.%2 (%3)").arg(element, field, operation);
+        }
+    }
+    
+    if (!problem.isEmpty()) {
+        m_unsupported.insert(id, problem);
+        return;
+    }
+    m_states.insert(id, state);
+}
+
+void ScapImporter::parseVariable(QXmlStreamReader &xml)
+{
+    const QString id = attribute(xml, "id");
+    if (!is(xml, "constant_variable")) {
+        // Valores de local_variable e external_variable só existem na avaliação
+        m_unsupported.insert(id, xml.name().toString());
+        xml.skipCurrentElement();
+        return;
+    }
+    
+    QStringList values;
+    while (xml.readNextStartElement()) {
+        if (is(xml, "value")) {
+            values.append(xml.readElementText());
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    m_variables.insert(id, values);
+}
+
+QJsonArray ScapImporter::rules()
+{
+    TraceSpan span("scap", "translate");
+    m_skipped.clear();
+    
+    QJsonArray result;
+    QSet<QString> ids;
+    auto add = [this, &result, &ids](const QString &scapId, const QJsonObject &converted) {
+        const QString id = converted["id"].toString();
+        if (ids.contains(id)) {
+            ScapSkip skip;
+            skip.id = scapId;
+            skip.reason = "id repetido após a conversão";
+            skip.detail = id;
+            m_skipped.append(skip);
+            return;
+        }
+        ids.insert(id);
+        result.append(converted);
+    };
+    
+    // Com benchmark, as regras são as do XCCDF e o OVAL só responde às verificações
+    if (!m_rules.isEmpty()) {
+        for (const XccdfRule &xccdf : m_rules) {
+            ScapSkip skip;
+            skip.id = xccdf.id;
+            if (xccdf.ovalRef.isEmpty()) {
+                skip.reason = xccdf.problem.isEmpty() ? QString("sem verificação OVAL") : xccdf.problem;
+                m_skipped.append(skip);
+                continue;
+            }
+            // Sem a condição da plataforma a regra valeria onde o benchmark a dá
+            // como não aplicável (ex.: sshd_config sem o openssh-server instalado)
+            skip.detail = unsupportedPlatform(xccdf.platforms);
+            if (!skip.detail.isEmpty()) {
+                skip.reason = "plataforma não suportada";
+                m_skipped.append(skip);
+                continue;
+            }
+            
+            QStringList formats;
+            const QJsonValue expr = translateDefinition(xccdf.ovalRef, &formats, &skip, 0);
+            if (expr.isNull()) {
+                m_skipped.append(skip);
+                continue;
+            }
+            
+            // No XCCDF o OVAL verdadeiro é a regra atendida; no catálogo, verdadeiro = vulnerável
+            add(xccdf.id, rule(ruleId(xccdf.id), xccdf.title, xccdf.description, xccdf.rationale,
+                               xccdf.severity, xccdf.platforms, xccdf.idents, formats, negated(expr)));
+        }
+        span.setArg("rules", result.size());
+        span.setArg("skipped", m_skipped.size());
+        return result;
+    }
+    
+    for (const QString &id : m_definitionOrder) {
+        const OvalDefinition &def = *m_definitions.constFind(id);
+        ScapSkip skip;
+        skip.id = id;
+        if (def.deprecated) {
+            skip.reason = "definição obsoleta";
+        } else if (def.cls != "vulnerability" && def.cls != "patch" && def.cls != "compliance") {
+            skip.reason = QString("definição de classe %1").arg(def.cls);
+        }
+        if (!skip.reason.isEmpty()) {
+            m_skipped.append(skip);
+            continue;
+        }
+        
+        QStringList formats;
+        QJsonValue expr = translateDefinition(id, &formats, &skip, 0);
+        if (expr.isNull()) {
+            m_skipped.append(skip);
+            continue;
+        }
+        
+        // Vulnerabilidade e patch: verdadeiro = afetado. Conformidade: verdadeiro = atendida
+        if (def.cls == "compliance") {
+            expr = negated(expr);
+        }
+        add(id, rule(ruleId(id), def.title, def.description, QString(), def.severity,
+                     def.platforms, def.references, formats, expr));
+    }
+    
+    span.setArg("rules", result.size());
+    span.setArg("skipped", m_skipped.size());
+    return result;
+}
+
+QJsonValue ScapImporter::translateDefinition(const QString &id, QStringList *formats, ScapSkip *skip, int depth) const
+{
+    auto it = m_definitions.constFind(id);
+    if (depth > MAX_DEFINITION_DEPTH) {
+        skip->reason = "extend_definition aninhado demais";
+    } else if (it == m_definitions.constEnd()) {
+        skip->reason = "definição OVAL ausente";
+    } else if (!it->problem.isEmpty()) {
+        skip->reason = it->problem;
+    } else {
+        return translateCriteria(it->criteria, formats, skip, depth);
+    }
+    skip->detail = id;
+    return QJsonValue();
+}
+
+QJsonValue ScapImporter::translateCriteria(const Criteria &criteria, QStringList *formats, ScapSkip *skip, int depth) const
+{
+    QJsonValue result;
+    
+    switch (criteria.kind) {
+        case Criteria::Kind::Test:
+            result = translateTest(criteria.ref, formats, skip);
+            break;
+        case Criteria::Kind::Definition:
+            result = translateDefinition(criteria.ref, formats, skip, depth + 1);
+            break;
+        case Criteria::Kind::All:
+        case Criteria::Kind::Any: {
+            // Um ramo sem tradução invalida a definição inteira, mesmo num OR
+            QJsonArray items;
+            for (const Criteria &child : criteria.children) {
+                const QJsonValue item = translateCriteria(child, formats, skip, depth);
+                if (item.isNull()) {
+                    return QJsonValue();
+                }
+                items.append(item);
+            }
+            if (items.isEmpty()) {
+                skip->reason = "criteria vazio";
+                return QJsonValue();
+            }
+            result = combine(criteria.kind == Criteria::Kind::All ? "all" : "any", items);
+            break;
+        }
+    }
+    
+    if (result.isNull() || !criteria.negate) {
+        return result;
+    }
+    return negated(result);
+}
+
+QJsonValue ScapImporter::translateTest(const QString &id, QStringList *formats, ScapSkip *skip) const
+{
+    auto fail = [skip](const QString &reason, const QString &detail) {
+        skip->reason = reason;
+        skip->detail = detail;
+        return QJsonValue();
+    };
+    
+    if (m_unsupported.contains(id)) {
+        return fail(m_unsupported.value(id), id);
+    }
+    if (!m_tests.contains(id)) {
+        return fail("teste OVAL ausente", id);
+    }
+    const OvalTest test = m_tests.value(id);
+    
+    if (m_unsupported.contains(test.objectRef)) {
+        return fail(m_unsupported.value(test.objectRef), test.objectRef);
+    }
+    if (!m_objects.contains(test.objectRef)) {
+        return fail("objeto OVAL ausente", test.objectRef);
+    }
+    const OvalObject object = m_objects.value(test.objectRef);
+    QStringList targets = object.targets;
+    if (!object.varRef.isEmpty()) {
+        if (!m_variables.contains(object.varRef)) {
+            return fail(m_unsupported.value(object.varRef, "variável OVAL ausente"), object.varRef);
+        }
+        targets = m_variables.value(object.varRef);
+    }
+    if (targets.isEmpty()) {
+        return fail("objeto sem alvo", test.objectRef);
+    }
+    
+    const bool hasState = !test.stateRef.isEmpty();
+    OvalState state;
+    if (hasState) {
+        if (m_unsupported.contains(test.stateRef)) {
+            return fail(m_unsupported.value(test.stateRef), test.stateRef);
+        }
+        if (!m_states.contains(test.stateRef)) {
+            return fail("estado OVAL ausente", test.stateRef);
+        }
+        state = m_states.value(test.stateRef);
+        if (!state.varRef.isEmpty()) {
+            const QStringList values = m_variables.value(state.varRef);
+            if (values.size() != 1) {
+                return fail(m_unsupported.value(state.varRef, "variável de estado sem valor único"), state.varRef);
+            }
+            state.value = values.first();
+        }
+    }
+    
+    if (hasState && state.value.isEmpty() && object.kind != FILE_KIND) {
+        return fail("estado sem valor", test.stateRef);
+    }
+    // A subexpressão é o primeiro grupo capturado pelo padrão
+    if (hasState && object.kind == TEXTFILECONTENT && QRegularExpression(object.pattern).captureCount() < 1) {
+        return fail("subexpression sem grupo de captura", test.objectRef);
+    }
+    
+    if (object.kind == RPMINFO || object.kind == DPKGINFO) {
+        const QString format = object.kind == RPMINFO ? "rpm" : "dpkg";
+        if (!formats->contains(format)) {
+            formats->append(format);
+        }
+    }
+    
+    // Para cada item do objeto: existe (E) e satisfaz o estado (S). Todas as
+    // primitivas de S já exigem a existência do item.
+    // Com instance >= 1 cada ocorrência do padrão é um item: check="all" exige
+    // que todas as ocorrências do arquivo satisfaçam o estado, os demais checks
+    // olham para qualquer uma. Com instance = 1 só a primeira conta.
+    QString occurrences = "any";
+    if (object.kind == TEXTFILECONTENT && hasState) {
+        if (object.firstInstance) {
+            occurrences = "first";
+        } else if (test.check.isEmpty() || test.check == "all") {
+            occurrences = "all";
+        } else if (test.check == "only one") {
+            return fail("check only one com várias ocorrências", id);
+        }
+    }
+    
+    QJsonArray exists;
+    QJsonArray satisfies;
+    QJsonArray missingOrSatisfies;
+    for (const QString &target : targets) {
+        QJsonObject e;
+        QJsonObject s;
+        if (object.kind == TEXTFILECONTENT) {
+            e["type"] = "file_matches";
+            e["path"] = target;
+            e["pattern"] = object.pattern;
+            s = e;
+            s["capture"] = state.value;
+            if (occurrences != "any") {
+                s["match"] = occurrences;
+            }
+        } else if (object.kind == FILE_KIND) {
+            e["type"] = "file_exists";
+            e["path"] = target;
+            s["type"] = "file_mode";
+            s["path"] = target;
+            s["mode"] = QString::number(state.mode, 8);
+            s["mask"] = QString::number(state.mask, 8);
+        } else if (object.kind == SYSCTL) {
+            e["type"] = "file_exists";
+            e["path"] = "/proc/sys/" + QString(target).replace('.', '/');
+            s["type"] = "sysctl";
+            s["key"] = target;
+            s["value"] = state.value;
+        } else {
+            e["type"] = "package_installed";
+            e["name"] = target;
+            s["type"] = "package_version";
+            s["name"] = target;
+            s["below"] = state.value;
+        }
+        exists.append(e);
+        satisfies.append(s);
+        missingOrSatisfies.append(combine("any", QJsonArray{ negated(e), s }));
+    }
+    
+    QJsonValue existence;
+    if (test.existence == "at_least_one_exists") {
+        existence = combine("any", exists);
+    } else if (test.existence == "all_exist") {
+        existence = combine("all", exists);
+    } else if (test.existence == "none_exist" && !hasState) {
+        QJsonArray none;
+        for (const QJsonValue &e : exists) {
+            none.append(negated(e));
+        }
+        return combine("all", none);
+    } else if (test.existence == "only_one_exists" && targets.size() == 1) {
+        existence = exists.first();
+    } else if (test.existence != "any_exist" || !hasState) {
+        return fail(QString("check_existence %1").arg(test.existence), id);
+    }
+    
+    if (!hasState) {
+        return existence;
+    }
+    
+    QJsonValue check;
+    if (test.check.isEmpty() || test.check == "all") {
+        check = combine("all", missingOrSatisfies);
+    } else if (test.check == "at least one" || (test.check == "only one" && targets.size() == 1)) {
+        check = combine("any", satisfies);
+    } else if (test.check == "none satisfy") {
+        QJsonArray none;
+        for (const QJsonValue &s : satisfies) {
+            none.append(negated(s));
+        }
+        check = combine("all", none);
+    } else {
+        return fail(QString("check %1").arg(test.check), id);
+    }
+    
+    // any_exist: nenhum item também serve
+    if (existence.isNull()) {
+        return check;
+    }
+    return combine("all", QJsonArray{ existence, check });
+}
+
+QJsonObject ScapImporter::rule(const QString &id, const QString &name, const QString &description,
+                               const QString &impact, const QString &severity, const QStringList &platforms,
+                               const QStringList &tags, const QStringList &formats, const QJsonValue &check)
+{
+    QJsonObject obj;
+    obj["id"] = id;
+    obj["name"] = name.isEmpty() ? id : name;
+    obj["description"] = description;
+    obj["impact"] = impact;
+    obj["severity"] = severityName(severity);
+    
+    QStringList allTags = { "scap" };
+    for (const QString &tag : tags) {
+        if (allTags.size() < MAX_TAGS && !tag.isEmpty() && !allTags.contains(tag)) {
+            allTags.append(tag);
+        }
+    }
+    obj["tags"] = QJsonArray::fromStringList(allTags);
+    
+    const QJsonObject appliesTo = applicability(platforms, formats);
+    if (!appliesTo.isEmpty()) {
+        obj["applies_to"] = appliesTo;
+    }
+    obj["check"] = check;
+    return obj;
+}
+
+QJsonObject ScapImporter::applicability(const QStringList &platforms, const QStringList &formats)
+{
+    QJsonObject result;
+    QStringList distros;
+    QStringList versions;
+    bool versionKnown = true;
+    
+    for (const QString &platform : platforms) {
+        // Plataforma "machine" do SCAP Security Guide: sistema fora de contêiner
+        if (platform == "#machine" || platform.endsWith(":machine")) {
+            result["container"] = false;
+            continue;
+        }
+        QString distro;
+        QString version;
+        if (!platformDistro(platform, &distro, &version)) {
+            continue;
+        }
+        if (!distros.contains(distro)) {
+            distros.append(distro);
+        }
+        if (version.isEmpty()) {
+            versionKnown = false;
+        } else if (!versions.contains(version)) {
+            versions.append(version);
+        }
+    }
+    
+    if (!distros.isEmpty()) {
+        result["distro"] = QJsonArray::fromStringList(distros);
+        // Faixa só quando todas as plataformas apontam a mesma versão. Versão
+        // sem ponto vale para as menores: "8.9" fica antes de "9~" na ordem do dpkg
+        if (versionKnown && versions.size() == 1) {
+            const QString version = versions.first();
+            QJsonObject range;
+            range["min"] = version;
+            range["max"] = version.contains('.') ? version : QString::number(version.toInt() + 1) + "~";
+            result["version"] = range;
+        }
+    }
+    
+    // Pacotes testados num único formato decidem o gerenciador
+    if (formats.size() == 1) {
+        result["package_manager"] = formats.first() == "rpm" ? QJsonArray{ "dnf", "yum", "zypper" }
+                                                              : QJsonArray{ "apt" };
+    }
+    
+    return result;
+}
+
+QString ScapImporter::ruleId(const QString &scapId)
+{
+    QString id;
+    if (scapId.startsWith("oval:")) {
+        // oval:com.redhat.rhsa:def:20230001 -> RHSA_20230001
+        const QStringList parts = scapId.split(':');
+        id = parts.value(1).section('.', -1) + '_' + parts.value(3);
+    } else {
+        // xccdf_org.ssgproject.content_rule_sshd_disable_root_login -> SSHD_DISABLE_ROOT_LOGIN
+        const int rule = scapId.indexOf("_rule_");
+        id = rule >= 0 ? scapId.mid(rule + 6) : scapId;
+    }
+    
+    id = id.toUpper();
+    for (QChar &c : id) {
+        if (c.unicode() > 127 || (!c.isLetterOrNumber() && c != '_')) {
+            c = '_';
+        }
+    }
+    return id;
+}
+
+QString ScapImporter::readText(QXmlStreamReader &xml)
+{
+    // Texto do elemento e dos filhos XHTML, em uma linha e com tamanho limitado
+    QString text = xml.readElementText(QXmlStreamReader::IncludeChildElements).simplified();
+    if (text.size() > MAX_TEXT_LENGTH) {
+        text.truncate(MAX_TEXT_LENGTH - 1);
+        text.append(QChar(0x2026));
+    }
+    return text;
+}
@@ -6,6 +6,12 @@
 #include <QScrollArea>
 #include <QSysInfo>
 #include <QProcess>
+#include <QSet>
+#include "ServiceStateProvider.h"
+#include "PackageInventory.h"
+#include "NetworkExposure.h"
+#include "TraceRecorder.h"
+#include "PlatformFingerprint.h"
 
 SecurityChecker::SecurityChecker(QWidget *parent)
     : QWidget(parent)
@@ -27,8 +33,18 @@ SecurityChecker::SecurityChecker(QWidget *parent)
     // Conectar sinais
     connect(m_systemChecker, &SystemChecker::checkCompleted,
             this, &SecurityChecker::onCheckCompleted);
+    connect(m_systemChecker, &SystemChecker::checkTimedOut,
+            this, &SecurityChecker::onCheckTimedOut);
+    connect(m_systemChecker, &SystemChecker::checkNotApplicable,
+            this, &SecurityChecker::onCheckNotApplicable);
+    connect(m_systemChecker, &SystemChecker::allChecksCompleted,
+            this, &SecurityChecker::onAllChecksCompleted);
+    connect(m_systemChecker, &SystemChecker::fixTimedOut,
+            this, &SecurityChecker::onFixTimedOut);
     connect(m_systemChecker, &SystemChecker::fixCompleted,
             this, &SecurityChecker::onFixCompleted);
+    connect(m_systemChecker, &SystemChecker::fixOutput,
+            this, &SecurityChecker::onFixOutput);
     connect(m_systemChecker, &SystemChecker::errorOccurred,
             this, &SecurityChecker::onErrorOccurred);
     
@@ -37,6 +53,10 @@ SecurityChecker::SecurityChecker(QWidget *parent)
             this, &SecurityChecker::onOllamaVulnerabilitiesReceived);
     connect(m_ollamaClient, &OllamaClient::errorOccurred,
             this, &SecurityChecker::onOllamaError);
+    connect(m_ollamaClient, &OllamaClient::usageReported,
+            this, &SecurityChecker::onOllamaUsageReported);
+    connect(m_vulnerabilityManager, &VulnerabilityManager::definitionsReloaded,
+            this, &SecurityChecker::onDefinitionsReloaded);
     
     // Carregar vulnerabilidades
     loadVulnerabilities();
@@ -56,6 +76,16 @@ void SecurityChecker::setScanMode(LandingPage::ScanMode mode, const QString &mod
     loadVulnerabilities();
 }
 
+void SecurityChecker::setFullScan(bool fullScan)
+{
+    m_systemChecker->setIncremental(!fullScan);
+}
+
+void SecurityChecker::setMetricsPath(const QString &path)
+{
+    m_metricsPath = path;
+}
+
 void SecurityChecker::setupUI()
 {
     m_mainLayout = new QVBoxLayout(this);
@@ -249,7 +279,7 @@ void SecurityChecker::setupUI()
             background: white;
         }
         
-        QTextEdit {
+        QTextEdit, QPlainTextEdit {
             background: white;
             color: #1f2937;
             border: 1px solid #d1d5db;
@@ -440,6 +470,15 @@ void SecurityChecker::createCheckSection()
     
     checkLayout->addWidget(m_fixCommandEdit);
     
+    // Saída da correção em andamento; o limite de blocos mantém a memória constante
+    m_outputView = new QPlainTextEdit();
+    m_outputView->setMaximumHeight(160);
+    m_outputView->setReadOnly(true);
+    m_outputView->setMaximumBlockCount(500);
+    m_outputView->hide();
+    
+    checkLayout->addWidget(m_outputView);
+    
     // Result frame
     m_resultFrame = new QFrame();
     m_resultFrame->setObjectName("resultFrame");
@@ -477,11 +516,20 @@ void SecurityChecker::createActionButtons()
     m_startCheckButton->setObjectName("primaryButton");
     connect(m_startCheckButton, &QPushButton::clicked, this, &SecurityChecker::onStartCheckClicked);
     
+    m_checkAllButton = new QPushButton("⚡ Verificar Tudo");
+    m_checkAllButton->setObjectName("secondaryButton");
+    connect(m_checkAllButton, &QPushButton::clicked, this, &SecurityChecker::onCheckAllClicked);
+    
     m_fixButton = new QPushButton("🔧 Corrigir e Continuar");
     m_fixButton->setObjectName("successButton");
     m_fixButton->hide();
     connect(m_fixButton, &QPushButton::clicked, this, &SecurityChecker::onFixClicked);
     
+    m_fixAllButton = new QPushButton("🛠️ Corrigir Todas");
+    m_fixAllButton->setObjectName("secondaryButton");
+    m_fixAllButton->hide();
+    connect(m_fixAllButton, &QPushButton::clicked, this, &SecurityChecker::onFixAllClicked);
+    
     m_skipButton = new QPushButton("⏭️ Pular sem Corrigir");
     m_skipButton->setObjectName("secondaryButton");
     m_skipButton->hide();
@@ -493,7 +541,9 @@ void SecurityChecker::createActionButtons()
     connect(m_nextButton, &QPushButton::clicked, this, &SecurityChecker::onNextClicked);
     
     buttonLayout->addWidget(m_startCheckButton);
+    buttonLayout->addWidget(m_checkAllButton);
     buttonLayout->addWidget(m_fixButton);
+    buttonLayout->addWidget(m_fixAllButton);
     buttonLayout->addWidget(m_skipButton);
     buttonLayout->addWidget(m_nextButton);
     
@@ -523,7 +573,7 @@ void SecurityChecker::loadVulnerabilities()
 {
     if (m_scanMode == LandingPage::ScanMode::Ollama) {
         // Limpar vulnerabilidades anteriores
-        m_currentVulnerabilities.clear();
+        setCurrentVulnerabilities(QVector<VulnerabilityDefinition>());
         m_checkResults.clear();
         m_currentCheckIndex = 0;
         
@@ -534,26 +584,29 @@ void SecurityChecker::loadVulnerabilities()
         return;
     }
     
-    // Modo local - usar JSON
-    QString filePath = QCoreApplication::applicationDirPath() + "/vulnerabilities.json";
-    if (!m_vulnerabilityManager->loadDefinitions(filePath)) {
-        emit errorOccurred("Não foi possível carregar as definições de vulnerabilidades");
-        return;
+    // Modo local - usar JSON. O arquivo é lido uma vez e depois observado;
+    // trocas de modo usam o catálogo publicado mais recente
+    if (m_vulnerabilityManager->catalog()->isEmpty()) {
+        QString filePath = QCoreApplication::applicationDirPath() + "/vulnerabilities.json";
+        if (!m_vulnerabilityManager->loadDefinitions(filePath)) {
+            emit errorOccurred("Não foi possível carregar as definições de vulnerabilidades");
+            return;
+        }
+        m_vulnerabilityManager->watchDefinitions();
     }
     
     m_currentOS = m_vulnerabilityManager->getCurrentOS();
     updateOSDisplay();
     
-    QVector<VulnerabilityDefinition> definitions = m_vulnerabilityManager->getDefinitionsForOS(m_currentOS);
-    
-    m_currentVulnerabilities.clear();
-    for (const auto &def : definitions) {
-        m_currentVulnerabilities.append(def);
-    }
+    setCurrentVulnerabilities(m_vulnerabilityManager->getDefinitionsForOS(m_currentOS));
     
     m_checkResults.clear();
     m_checkResults.resize(m_currentVulnerabilities.size());
     
+    // Nova varredura: fatos do sistema serão coletados novamente
+    m_systemChecker->beginScan(m_currentVulnerabilities);
+    m_metrics.setRules(m_currentVulnerabilities);
+    
     updateProgress();
     updateCurrentCheck();
 }
@@ -584,13 +637,15 @@ void SecurityChecker::startOllamaAnalysis()
 
 SystemInfo SecurityChecker::collectSystemInfo() const
 {
+    TraceSpan span("ollama", "collectSystemInfo");
     SystemInfo info;
     
     // Informações básicas do sistema
-    info.osType = QSysInfo::kernelType();
-    info.osVersion = QSysInfo::productVersion();
-    info.kernelVersion = QSysInfo::kernelVersion();
-    info.architecture = QSysInfo::currentCpuArchitecture();
+    const PlatformFingerprint &platform = PlatformFingerprint::current();
+    info.osType = platform.prettyName.isEmpty() ? platform.family : platform.prettyName;
+    info.osVersion = platform.versionId;
+    info.kernelVersion = platform.kernelRelease;
+    info.architecture = platform.architecture;
     
     // Coletar serviços em execução (limitado para não sobrecarregar)
     QProcess process;
@@ -623,8 +678,14 @@ SystemInfo SecurityChecker::collectSystemInfo() const
         }
     }
 #elif defined(Q_OS_LINUX)
-    process.start("systemctl", QStringList() << "list-units" << "--type=service" << "--state=running" << "--no-pager");
-    if (process.waitForFinished(5000)) {
+    // Lista completa de serviços em execução direto do systemd
+    ServiceStateProvider serviceStates;
+    if (serviceStates.refresh()) {
+        info.runningServices = serviceStates.runningServices();
+    } else {
+        process.start("systemctl", QStringList() << "list-units" << "--type=service" << "--state=running" << "--no-pager");
+    }
+    if (!serviceStates.isLoaded() && process.waitForFinished(5000)) {
         QString output = process.readAllStandardOutput();
         QStringList lines = output.split('\n');
         for (const QString &line : lines) {
@@ -637,16 +698,29 @@ SystemInfo SecurityChecker::collectSystemInfo() const
         }
     }
     
-    // Portas abertas
-    process.start("ss", QStringList() << "-tuln");
-    if (process.waitForFinished(5000)) {
-        QString output = process.readAllStandardOutput();
-        QStringList lines = output.split('\n');
-        for (const QString &line : lines) {
-            if ((line.contains("LISTEN") || line.contains("UNCONN")) && info.openPorts.size() < 15) {
-                info.openPorts.append(line.trimmed());
-            }
+    // Portas abertas, já com o processo e a unidade donos de cada socket. Para
+    // o prompt só interessa o que está exposto: loopback fica de fora, IPv4 e
+    // IPv6 do mesmo processo na mesma porta contam uma vez, e a lista tem o
+    // mesmo limite das outras plataformas
+    NetworkExposure network;
+    network.collect();
+    const QVector<ListeningSocket> sockets = network.sockets();
+    QSet<QString> seen;
+    int omitted = 0;
+    for (const ListeningSocket &socket : sockets) {
+        const QString key = QString("%1/%2 %3").arg(socket.port).arg(socket.protocol.left(3)).arg(socket.pid);
+        if (socket.isLoopback() || seen.contains(key)) {
+            continue;
         }
+        seen.insert(key);
+        if (info.openPorts.size() < 15) {
+            info.openPorts.append(socket.toString());
+        } else {
+            omitted++;
+        }
+    }
+    if (omitted > 0) {
+        info.openPorts.append(QString("... e mais %1 portas expostas omitidas").arg(omitted));
     }
 #elif defined(Q_OS_MACOS)
     process.start("launchctl", QStringList() << "list");
@@ -678,6 +752,30 @@ SystemInfo SecurityChecker::collectSystemInfo() const
         }
     }
 #endif
+
+#ifdef Q_OS_LINUX
+    // Software exposto à rede ou ligado à segurança, lido direto do banco de
+    // pacotes; a lista inteira (milhares de pacotes) não caberia no prompt
+    static const QStringList relevantPrefixes = {
+        "linux-image", "kernel", "openssh", "openssl", "libssl", "sudo", "apache2", "httpd",
+        "nginx", "mysql", "mariadb", "postgresql", "redis", "mongodb", "samba", "vsftpd",
+        "proftpd", "bind9", "bind", "postfix", "exim", "dovecot", "php", "docker", "containerd",
+        "ufw", "firewalld", "iptables", "nftables", "fail2ban", "apparmor", "selinux"
+    };
+    
+    PackageInventory inventory;
+    if (inventory.load()) {
+        const QVector<PackageRecord> packages = inventory.packages();
+        for (const PackageRecord &package : packages) {
+            for (const QString &prefix : relevantPrefixes) {
+                if (package.name.startsWith(prefix)) {
+                    info.installedSoftware.append(package.name + " " + package.version);
+                    break;
+                }
+            }
+        }
+    }
+#endif
     
     return info;
 }
@@ -735,12 +833,58 @@ void SecurityChecker::updateCurrentCheck()
     
     m_fixCommandEdit->setPlainText(vuln.fix);
     m_fixCommandEdit->hide();
+    m_outputView->clear();
+    m_outputView->hide();
     m_resultFrame->hide();
     
+    // Resultado pode já estar disponível pela verificação em lote
+    showCurrentResult();
+    
     updateActionButtons();
     updateProgress();
 }
 
+void SecurityChecker::showCurrentResult()
+{
+    if (m_currentCheckIndex >= m_checkResults.size()) {
+        return;
+    }
+    
+    switch (m_checkResults[m_currentCheckIndex].status) {
+        case CheckStatus::Checking:
+            m_resultFrame->show();
+            m_resultIcon->setText("🔍");
+            m_resultText->setText("Verificando...");
+            break;
+        case CheckStatus::Vulnerable:
+            m_resultFrame->show();
+            m_resultIcon->setText("⚠️");
+            m_resultText->setText("Vulnerabilidade encontrada!");
+            m_fixCommandEdit->show();
+            break;
+        case CheckStatus::Safe:
+            m_resultFrame->show();
+            m_resultIcon->setText("✅");
+            m_resultText->setText("Sistema seguro");
+            m_fixCommandEdit->hide();
+            break;
+        case CheckStatus::TimedOut:
+            m_resultFrame->show();
+            m_resultIcon->setText("⏱️");
+            m_resultText->setText("Verificação excedeu o tempo limite");
+            m_fixCommandEdit->hide();
+            break;
+        case CheckStatus::NotApplicable:
+            m_resultFrame->show();
+            m_resultIcon->setText("➖");
+            m_resultText->setText("Não aplicável a este sistema");
+            m_fixCommandEdit->hide();
+            break;
+        default:
+            break;
+    }
+}
+
 void SecurityChecker::updateActionButtons()
 {
     if (m_currentCheckIndex >= m_currentVulnerabilities.size()) {
@@ -749,10 +893,20 @@ void SecurityChecker::updateActionButtons()
     
     const CheckResult &result = m_checkResults[m_currentCheckIndex];
     
-    m_startCheckButton->setVisible(result.status == CheckStatus::Pending);
+    m_startCheckButton->setVisible(result.status == CheckStatus::Pending || result.status == CheckStatus::TimedOut);
+    m_checkAllButton->setVisible(result.status == CheckStatus::Pending);
     m_fixButton->setVisible(result.status == CheckStatus::Vulnerable);
+    
+    // Com várias vulnerabilidades já encontradas, corrigir todas em um único plano
+    int vulnerableCount = 0;
+    for (const CheckResult &other : m_checkResults) {
+        if (other.status == CheckStatus::Vulnerable) {
+            vulnerableCount++;
+        }
+    }
+    m_fixAllButton->setVisible(result.status == CheckStatus::Vulnerable && vulnerableCount > 1);
     m_skipButton->setVisible(result.status == CheckStatus::Vulnerable);
-    m_nextButton->setVisible(result.status == CheckStatus::Safe || result.status == CheckStatus::Fixed || result.status == CheckStatus::Skipped);
+    m_nextButton->setVisible(result.status == CheckStatus::Safe || result.status == CheckStatus::Fixed || result.status == CheckStatus::Skipped || result.status == CheckStatus::TimedOut || result.status == CheckStatus::NotApplicable);
 }
 
 void SecurityChecker::updateOSDisplay()
@@ -853,7 +1007,7 @@ void SecurityChecker::resetChecker()
     m_currentCheckIndex = 0;
     m_isCompleted = false;
     m_checkResults.clear();
-    m_currentVulnerabilities.clear();
+    setCurrentVulnerabilities(QVector<VulnerabilityDefinition>());
     
     m_checkFrame->show();
     m_resultsFrame->hide();
@@ -885,6 +1039,8 @@ QString SecurityChecker::getStatusText(CheckStatus status) const
         case CheckStatus::Safe: return "Seguro";
         case CheckStatus::Skipped: return "Ignorado";
         case CheckStatus::Fixed: return "Corrigido";
+        case CheckStatus::TimedOut: return "Tempo esgotado";
+        case CheckStatus::NotApplicable: return "Não aplicável";
         default: return "Desconhecido";
     }
 }
@@ -896,12 +1052,17 @@ QString SecurityChecker::getStatusColor(CheckStatus status) const
         case CheckStatus::Safe: return "#10b981";
         case CheckStatus::Fixed: return "#2563eb";
         case CheckStatus::Skipped: return "#6b7280";
+        case CheckStatus::TimedOut: return "#d97706";
+        case CheckStatus::NotApplicable: return "#6b7280";
         default: return "#9ca3af";
     }
 }
 
 void SecurityChecker::onBackClicked()
 {
+    // Não deixar comandos rodando depois de sair da tela
+    m_systemChecker->cancelChecks();
+    m_systemChecker->cancelFix();
     emit backRequested();
 }
 
@@ -921,9 +1082,32 @@ void SecurityChecker::onStartCheckClicked()
     m_resultText->setText("Verificando...");
     
     // Iniciar verificação
+    m_scanTimer.start();
     m_systemChecker->checkVulnerability(vuln);
 }
 
+void SecurityChecker::onCheckAllClicked()
+{
+    // Agendar todas as verificações pendentes de uma vez
+    QVector<VulnerabilityDefinition> pending;
+    for (int i = m_currentCheckIndex; i < m_currentVulnerabilities.size(); i++) {
+        if (m_checkResults[i].status == CheckStatus::Pending) {
+            m_checkResults[i].status = CheckStatus::Checking;
+            pending.append(m_currentVulnerabilities[i]);
+        }
+    }
+    
+    if (pending.isEmpty()) {
+        return;
+    }
+    
+    showCurrentResult();
+    updateActionButtons();
+    
+    m_scanTimer.start();
+    m_systemChecker->checkAll(pending);
+}
+
 void SecurityChecker::onFixClicked()
 {
     if (m_currentCheckIndex >= m_currentVulnerabilities.size()) {
@@ -934,11 +1118,34 @@ void SecurityChecker::onFixClicked()
     
     m_resultIcon->setText("🔧");
     m_resultText->setText("Aplicando correção...");
+    m_outputView->clear();
+    m_outputView->show();
     
     // Iniciar correção
     m_systemChecker->fixVulnerability(vuln);
 }
 
+void SecurityChecker::onFixAllClicked()
+{
+    QVector<VulnerabilityDefinition> selected;
+    for (int i = 0; i < m_checkResults.size() && i < m_currentVulnerabilities.size(); i++) {
+        if (m_checkResults[i].status == CheckStatus::Vulnerable) {
+            selected.append(m_currentVulnerabilities[i]);
+        }
+    }
+    
+    if (selected.isEmpty()) {
+        return;
+    }
+    
+    m_resultIcon->setText("🔧");
+    m_resultText->setText(QString("Aplicando %1 correções...").arg(selected.size()));
+    m_outputView->clear();
+    m_outputView->show();
+    
+    m_systemChecker->fixAll(selected);
+}
+
 void SecurityChecker::onSkipClicked()
 {
     if (m_currentCheckIndex >= m_currentVulnerabilities.size()) {
@@ -960,54 +1167,141 @@ void SecurityChecker::onNextClicked()
     updateCurrentCheck();
 }
 
-void SecurityChecker::onCheckCompleted(const QString &id, bool isVulnerable)
+void SecurityChecker::onCheckCompleted(const QString &id, bool isVulnerable, const QString &evidence)
 {
+    TraceSpan span("ui", "onCheckCompleted");
+    
     // Encontrar o índice da verificação
-    int index = -1;
-    for (int i = 0; i < m_currentVulnerabilities.size(); i++) {
-        if (m_currentVulnerabilities[i].id == id) {
-            index = i;
-            break;
-        }
-    }
+    const int index = ruleIndex(id);
     
-    if (index == -1 || index != m_currentCheckIndex) {
+    // Dependências são verificadas automaticamente, então também aceitar pendentes
+    if (index == -1 || (m_checkResults[index].status != CheckStatus::Checking
+                        && m_checkResults[index].status != CheckStatus::Pending)) {
         return;
     }
     
     m_checkResults[index].status = isVulnerable ? CheckStatus::Vulnerable : CheckStatus::Safe;
     m_checkResults[index].isVulnerable = isVulnerable;
+    m_checkResults[index].evidence = evidence;
+    observeCheckDuration(id);
     
-    if (isVulnerable) {
-        m_resultIcon->setText("⚠️");
-        m_resultText->setText("Vulnerabilidade encontrada!");
-        m_fixCommandEdit->show();
-    } else {
-        m_resultIcon->setText("✅");
-        m_resultText->setText("Sistema seguro");
-        m_fixCommandEdit->hide();
+    // Resultados em lote chegam fora de ordem; só atualizar a tela da verificação atual
+    if (index != m_currentCheckIndex) {
+        return;
     }
     
+    showCurrentResult();
     updateActionButtons();
 }
 
-void SecurityChecker::onFixCompleted(const QString &id, bool success)
+void SecurityChecker::onAllChecksCompleted()
 {
-    // Encontrar o índice da correção
-    int index = -1;
-    for (int i = 0; i < m_currentVulnerabilities.size(); i++) {
-        if (m_currentVulnerabilities[i].id == id) {
-            index = i;
-            break;
+    TraceSpan span("ui", "onAllChecksCompleted");
+    
+    int vulnerable = 0;
+    for (CheckResult &result : m_checkResults) {
+        // Verificações que falharam voltam a ficar pendentes
+        if (result.status == CheckStatus::Checking) {
+            result.status = CheckStatus::Pending;
+        } else if (result.status == CheckStatus::Vulnerable) {
+            vulnerable++;
         }
     }
     
-    if (index == -1 || index != m_currentCheckIndex) {
+    updateActionButtons();
+    
+    if (m_scanTimer.isValid()) {
+        m_metrics.observeScanDuration(m_scanTimer.nsecsElapsed() / 1e9);
+        m_scanTimer.invalidate();
+    }
+    writeMetrics();
+    
+    qDebug() << "Verificação em lote concluída:" << vulnerable << "vulnerabilidades encontradas";
+}
+
+void SecurityChecker::onCheckTimedOut(const QString &id, const QString &evidence)
+{
+    TraceSpan span("ui", "onCheckTimedOut");
+    
+    const int index = ruleIndex(id);
+    
+    if (index == -1 || m_checkResults[index].status != CheckStatus::Checking) {
+        return;
+    }
+    
+    m_checkResults[index].status = CheckStatus::TimedOut;
+    m_checkResults[index].evidence = evidence;
+    observeCheckDuration(id);
+    
+    if (index == m_currentCheckIndex) {
+        showCurrentResult();
+        updateActionButtons();
+    }
+}
+
+void SecurityChecker::onCheckNotApplicable(const QString &id)
+{
+    TraceSpan span("ui", "onCheckNotApplicable");
+    
+    const int index = ruleIndex(id);
+    
+    if (index == -1 || (m_checkResults[index].status != CheckStatus::Checking
+                        && m_checkResults[index].status != CheckStatus::Pending)) {
+        return;
+    }
+    
+    m_checkResults[index].status = CheckStatus::NotApplicable;
+    m_checkResults[index].isVulnerable = false;
+    observeCheckDuration(id);
+    
+    if (index == m_currentCheckIndex) {
+        showCurrentResult();
+        updateActionButtons();
+    }
+}
+
+void SecurityChecker::onFixTimedOut(const QString &id, const QString &log)
+{
+    TraceSpan span("ui", "onFixTimedOut");
+    
+    const int index = ruleIndex(id);
+    if (index != -1 && index < m_checkResults.size()) {
+        m_checkResults[index].fixLog = log;
+    }
+    
+    if (m_currentCheckIndex >= m_currentVulnerabilities.size()
+        || m_currentVulnerabilities[m_currentCheckIndex].id != id) {
         return;
     }
     
+    m_resultIcon->setText("⏱️");
+    m_resultText->setText("Correção excedeu o tempo limite e foi interrompida");
+    
+    updateActionButtons();
+}
+
+void SecurityChecker::onFixCompleted(const QString &id, bool success, const QString &log)
+{
+    TraceSpan span("ui", "onFixCompleted");
+    
+    // Encontrar o índice da correção
+    const int index = ruleIndex(id);
+    
+    if (index == -1) {
+        return;
+    }
+    m_checkResults[index].fixLog = log;
     if (success) {
         m_checkResults[index].status = CheckStatus::Fixed;
+    }
+    writeMetrics();
+    
+    // Correções em lote concluem regras que não estão na tela
+    if (index != m_currentCheckIndex) {
+        return;
+    }
+    
+    if (success) {
         m_resultIcon->setText("✅");
         m_resultText->setText("Vulnerabilidade corrigida com sucesso!");
     } else {
@@ -1018,6 +1312,17 @@ void SecurityChecker::onFixCompleted(const QString &id, bool success)
     updateActionButtons();
 }
 
+void SecurityChecker::onFixOutput(const QString &step, const QString &text)
+{
+    TraceSpan span("ui", "onFixOutput");
+    
+    m_resultText->setText(step + "...");
+    
+    m_outputView->moveCursor(QTextCursor::End);
+    m_outputView->insertPlainText(text);
+    m_outputView->ensureCursorVisible();
+}
+
 void SecurityChecker::onErrorOccurred(const QString &error)
 {
     // Mostrar erro na interface
@@ -1062,6 +1367,12 @@ void SecurityChecker::onSaveReportClicked()
         out << "Descrição: " << vuln.description << Qt::endl;
         out << "Impacto: " << vuln.impact << Qt::endl;
         out << "Correção: " << vuln.fix << Qt::endl;
+        if (!result.evidence.trimmed().isEmpty()) {
+            out << "Evidência:" << Qt::endl << result.evidence.trimmed() << Qt::endl;
+        }
+        if (!result.fixLog.trimmed().isEmpty()) {
+            out << "Saída da correção:" << Qt::endl << result.fixLog.trimmed() << Qt::endl;
+        }
         out << Qt::endl;
     }
     
@@ -1070,9 +1381,11 @@ void SecurityChecker::onSaveReportClicked()
 
 void SecurityChecker::onOllamaVulnerabilitiesReceived(const QVector<VulnerabilityDefinition> &vulnerabilities)
 {
+    TraceSpan span("ui", "onOllamaVulnerabilitiesReceived");
+    
     qDebug() << "Vulnerabilidades recebidas da IA:" << vulnerabilities.size();
     
-    m_currentVulnerabilities = vulnerabilities;
+    setCurrentVulnerabilities(vulnerabilities);
     m_checkResults.clear();
     m_checkResults.resize(vulnerabilities.size());
     
@@ -1083,6 +1396,8 @@ void SecurityChecker::onOllamaVulnerabilitiesReceived(const QVector<Vulnerabilit
     }
     
     m_currentCheckIndex = 0;
+    m_systemChecker->beginScan(m_currentVulnerabilities);
+    m_metrics.setRules(m_currentVulnerabilities);
     
     // Restaurar progresso normal após análise da IA
     m_progressBar->setRange(0, vulnerabilities.size());
@@ -1116,8 +1431,66 @@ void SecurityChecker::onOllamaError(const QString &error)
     // Mostrar botão para voltar e sugerir verificação local
     m_startCheckButton->hide();
     m_fixButton->hide();
+    m_fixAllButton->hide();
     m_skipButton->hide();
     m_nextButton->hide();
 }
+
+void SecurityChecker::onOllamaUsageReported(const OllamaUsage &usage)
+{
+    m_metrics.observeOllamaRequest(usage);
+    writeMetrics();
+}
+
+void SecurityChecker::onDefinitionsReloaded()
+{
+    // Regras na tela só são trocadas enquanto nada foi verificado; depois
+    // disso o catálogo novo vale a partir da próxima verificação
+    if (m_scanMode != LandingPage::ScanMode::Local || m_systemChecker->pendingCheckCount() > 0) {
+        return;
+    }
+    for (const CheckResult &result : m_checkResults) {
+        if (result.status != CheckStatus::Pending) {
+            qDebug() << "Catálogo recarregado; será usado na próxima verificação";
+            return;
+        }
+    }
+    
+    loadVulnerabilities();
+}
+
+void SecurityChecker::setCurrentVulnerabilities(const QVector<VulnerabilityDefinition> &rules)
+{
+    m_currentVulnerabilities = rules;
+    m_ruleIndex.clear();
+    m_ruleIndex.reserve(rules.size());
+    for (int i = 0; i < rules.size(); i++) {
+        m_ruleIndex.insert(rules[i].id, i);
+    }
+}
+
+int SecurityChecker::ruleIndex(const QString &id) const
+{
+    return m_ruleIndex.value(id, -1);
+}
+
+void SecurityChecker::observeCheckDuration(const QString &id)
+{
+    m_metrics.observeRuleDuration(id, m_systemChecker->checkDuration(id));
+}
+
+void SecurityChecker::writeMetrics()
+{
+    if (m_metricsPath.isEmpty()) {
+        return;
+    }
+    
+    // Estados mudam em vários pontos da interface; a fonte é m_checkResults
+    for (int i = 0; i < m_currentVulnerabilities.size() && i < m_checkResults.size(); i++) {
+        m_metrics.setResult(m_currentVulnerabilities[i].id, m_checkResults[i].status);
+    }
+    m_metrics.setCounters(m_systemChecker->counters());
+    m_metrics.write(m_metricsPath);
+}
     
     // Header
\ No newline at end of file
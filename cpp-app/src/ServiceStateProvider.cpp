@@ -0,0 +1,376 @@
+#include "ServiceStateProvider.h"
+#include <QObject>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTimer>
+#include <QSharedPointer>
+#include <QDebug>
+
+#ifdef SECURITYCHECKER_HAS_DBUS
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCall>
+#include <QDBusPendingCallWatcher>
+#include <QDBusArgument>
+#include <QDBusObjectPath>
+#include <QDBusError>
+
+static const char *SYSTEMD_PATH = "/org/freedesktop/systemd1";
+static const char *SYSTEMD_MANAGER = "org.freedesktop.systemd1.Manager";
+#endif
+
+static const int SYSTEMCTL_TIMEOUT_MS = 5000;
+
+// Onde o systemd procura arquivos de unidade, do mais ao menos prioritário
+static const char *UNIT_DIRS[] = {
+    "/etc/systemd/system", "/run/systemd/system", "/usr/local/lib/systemd/system",
+    "/usr/lib/systemd/system", "/lib/systemd/system"
+};
+
+static QStringList systemctlArguments(const QString &command)
+{
+    return QStringList() << command << "--all" << "--full" << "--plain" << "--no-legend" << "--no-pager";
+}
+
+static bool processSucceeded(const QProcess &process)
+{
+    return process.error() == QProcess::UnknownError
+           && process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+}
+
+ServiceStateProvider::ServiceStateProvider(const QString &busAddress, const QString &serviceName)
+    : m_busAddress(busAddress)
+    , m_serviceName(serviceName)
+    , m_connectionName(QString("securitychecker-systemd-%1").arg(quintptr(this), 0, 16))
+    , m_loaded(false)
+    , m_refreshing(false)
+    , m_generation(0)
+{
+}
+
+ServiceStateProvider::~ServiceStateProvider()
+{
+#ifdef SECURITYCHECKER_HAS_DBUS
+    // Conexões com nome ficam abertas no QDBusConnection até serem desfeitas
+    if (!m_busAddress.isEmpty()) {
+        QDBusConnection::disconnectFromBus(m_connectionName);
+    }
+#endif
+}
+
+#ifdef SECURITYCHECKER_HAS_DBUS
+static QDBusConnection systemdBus(const QString &busAddress, const QString &connectionName)
+{
+    return busAddress.isEmpty()
+        ? QDBusConnection::systemBus()
+        : QDBusConnection::connectToBus(busAddress, connectionName);
+}
+
+// a(ssssssouso): nome, descrição, load, active, sub, following, caminho, job...
+static void readListUnits(const QDBusMessage &reply, QHash<QString, UnitState> &table)
+{
+    const QDBusArgument units = reply.arguments().value(0).value<QDBusArgument>();
+    units.beginArray();
+    while (!units.atEnd()) {
+        QString name, description, loadState, following, jobType;
+        QDBusObjectPath unitPath, jobPath;
+        uint jobId = 0;
+        UnitState state;
+        
+        units.beginStructure();
+        units >> name >> description >> loadState >> state.activeState >> state.subState
+              >> following >> unitPath >> jobId >> jobType >> jobPath;
+        units.endStructure();
+        
+        table.insert(name, state);
+    }
+    units.endArray();
+}
+
+// a(ss): caminho do arquivo da unidade e estado (enabled, disabled...)
+static QList<QPair<QString, QString>> readListUnitFiles(const QDBusMessage &reply)
+{
+    QList<QPair<QString, QString>> unitFiles;
+    const QDBusArgument files = reply.arguments().value(0).value<QDBusArgument>();
+    files.beginArray();
+    while (!files.atEnd()) {
+        QString path, fileState;
+        files.beginStructure();
+        files >> path >> fileState;
+        files.endStructure();
+        unitFiles.append(qMakePair(path, fileState));
+    }
+    files.endArray();
+    return unitFiles;
+}
+#endif
+
+bool ServiceStateProvider::refresh()
+{
+    clear();
+
+#ifdef SECURITYCHECKER_HAS_DBUS
+    QDBusConnection bus = systemdBus(m_busAddress, m_connectionName);
+    if (!bus.isConnected()) {
+        qWarning() << "Barramento D-Bus indisponível:" << bus.lastError().message();
+        return false;
+    }
+    
+    // As duas chamadas saem juntas; a espera cobre só a mais lenta
+    QDBusPendingCall unitsCall = bus.asyncCall(
+        QDBusMessage::createMethodCall(m_serviceName, SYSTEMD_PATH, SYSTEMD_MANAGER, "ListUnits"));
+    QDBusPendingCall filesCall = bus.asyncCall(
+        QDBusMessage::createMethodCall(m_serviceName, SYSTEMD_PATH, SYSTEMD_MANAGER, "ListUnitFiles"));
+    unitsCall.waitForFinished();
+    filesCall.waitForFinished();
+    
+    if (unitsCall.isError()) {
+        qWarning() << "ListUnits falhou:" << unitsCall.error().message();
+        return false;
+    }
+    
+    readListUnits(unitsCall.reply(), m_units);
+    if (!filesCall.isError()) {
+        for (const auto &unitFile : readListUnitFiles(filesCall.reply())) {
+            addUnitFile(unitFile.first, unitFile.second);
+        }
+    }
+    
+    m_loaded = true;
+    qDebug() << "Estado de" << m_units.size() << "unidades obtido do systemd";
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ServiceStateProvider::refreshFromSystemctl()
+{
+    clear();
+    
+    // Todas as unidades de uma vez, nos mesmos formatos de ListUnits e ListUnitFiles;
+    // os dois processos rodam em paralelo
+    QProcess units;
+    QProcess files;
+    units.start("systemctl", systemctlArguments("list-units"));
+    files.start("systemctl", systemctlArguments("list-unit-files"));
+    units.waitForFinished(SYSTEMCTL_TIMEOUT_MS);
+    files.waitForFinished(SYSTEMCTL_TIMEOUT_MS);
+    if (!processSucceeded(units)) {
+        qWarning() << "Falha ao consultar estado dos serviços com systemctl";
+        return false;
+    }
+    
+    loadSystemctlOutput(units.readAllStandardOutput(),
+                        processSucceeded(files) ? files.readAllStandardOutput() : QByteArray());
+    m_loaded = true;
+    return true;
+}
+
+void ServiceStateProvider::loadSystemctlOutput(const QByteArray &units, const QByteArray &files)
+{
+    // unidade, load, active, sub, descrição; unidades com falha podem vir com "●"
+    const QStringList unitLines = QString::fromUtf8(units).split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : unitLines) {
+        QStringList fields = line.simplified().split(' ');
+        if (!fields.isEmpty() && (fields.first() == QStringLiteral("●") || fields.first() == "*")) {
+            fields.removeFirst();
+        }
+        if (fields.size() < 4) {
+            continue;
+        }
+        UnitState &state = m_units[fields[0]];
+        state.activeState = fields[2];
+        state.subState = fields[3];
+    }
+    
+    // unidade, estado do arquivo, preset; o caminho vem dos diretórios de unidades
+    const QStringList fileLines = QString::fromUtf8(files).split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : fileLines) {
+        const QStringList fields = line.simplified().split(' ');
+        if (fields.size() < 2) {
+            continue;
+        }
+        QString path = fields[0];
+        for (const char *dir : UNIT_DIRS) {
+            const QFileInfo info(QString::fromLatin1(dir) + '/' + fields[0]);
+            if (info.exists() || info.isSymLink()) {
+                path = info.filePath();
+                break;
+            }
+        }
+        addUnitFile(path, fields[1]);
+    }
+}
+
+void ServiceStateProvider::refreshAsync(QObject *context, const std::function<void()> &onReady)
+{
+    clear();
+    m_refreshing = true;
+    const quint64 generation = m_generation;
+
+#ifdef SECURITYCHECKER_HAS_DBUS
+    QDBusConnection bus = systemdBus(m_busAddress, m_connectionName);
+    if (bus.isConnected()) {
+        const QDBusPendingCall unitsCall = bus.asyncCall(
+            QDBusMessage::createMethodCall(m_serviceName, SYSTEMD_PATH, SYSTEMD_MANAGER, "ListUnits"));
+        const QDBusPendingCall filesCall = bus.asyncCall(
+            QDBusMessage::createMethodCall(m_serviceName, SYSTEMD_PATH, SYSTEMD_MANAGER, "ListUnitFiles"));
+        
+        // Um vigia por chamada; o último a terminar monta a tabela. O vigia
+        // entrega o sinal pelo laço de eventos mesmo se a chamada já terminou.
+        auto remaining = QSharedPointer<int>::create(2);
+        for (const QDBusPendingCall &call : { unitsCall, filesCall }) {
+            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, context);
+            QObject::connect(watcher, &QDBusPendingCallWatcher::finished, context,
+                             [this, context, generation, onReady, remaining, unitsCall, filesCall, watcher]() {
+                watcher->deleteLater();
+                if (--*remaining > 0 || generation != m_generation) {
+                    return;
+                }
+                
+                if (unitsCall.isError()) {
+                    qWarning() << "ListUnits falhou:" << unitsCall.error().message();
+                    refreshFromSystemctlAsync(context, generation, onReady);
+                    return;
+                }
+                
+                readListUnits(unitsCall.reply(), m_units);
+                if (!filesCall.isError()) {
+                    for (const auto &unitFile : readListUnitFiles(filesCall.reply())) {
+                        addUnitFile(unitFile.first, unitFile.second);
+                    }
+                }
+                
+                m_loaded = true;
+                m_refreshing = false;
+                onReady();
+            });
+        }
+        return;
+    }
+    qWarning() << "Barramento D-Bus indisponível:" << bus.lastError().message();
+#endif
+
+    refreshFromSystemctlAsync(context, generation, onReady);
+}
+
+void ServiceStateProvider::refreshFromSystemctlAsync(QObject *context, quint64 generation,
+                                                      const std::function<void()> &onReady)
+{
+    QProcess *units = new QProcess(context);
+    QProcess *files = new QProcess(context);
+    
+    // Os dois processos rodam em paralelo; o último a terminar monta a tabela
+    auto remaining = QSharedPointer<int>::create(2);
+    auto finished = [this, generation, onReady, remaining, units, files]() {
+        if (--*remaining > 0) {
+            return;
+        }
+        units->deleteLater();
+        files->deleteLater();
+        if (generation != m_generation) {
+            return;
+        }
+        
+        m_refreshing = false;
+        if (!processSucceeded(*units)) {
+            qWarning() << "Falha ao consultar estado dos serviços com systemctl";
+            onReady();
+            return;
+        }
+        
+        loadSystemctlOutput(units->readAllStandardOutput(),
+                            processSucceeded(*files) ? files->readAllStandardOutput() : QByteArray());
+        m_loaded = true;
+        onReady();
+    };
+    
+    for (QProcess *process : { units, files }) {
+        QObject::connect(process, &QProcess::finished, context, finished);
+        QObject::connect(process, &QProcess::errorOccurred, context, [finished](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                finished();
+            }
+        });
+        // Um systemctl travado é morto e conta como falha
+        QTimer::singleShot(SYSTEMCTL_TIMEOUT_MS, process, [process]() {
+            process->kill();
+        });
+    }
+    units->start("systemctl", systemctlArguments("list-units"));
+    files->start("systemctl", systemctlArguments("list-unit-files"));
+}
+
+bool ServiceStateProvider::isRefreshing() const
+{
+    return m_refreshing;
+}
+
+bool ServiceStateProvider::isLoaded() const
+{
+    return m_loaded;
+}
+
+void ServiceStateProvider::clear()
+{
+    m_units.clear();
+    m_aliases.clear();
+    m_loaded = false;
+    m_refreshing = false;
+    m_generation++;
+}
+
+void ServiceStateProvider::addUnitFile(const QString &path, const QString &fileState)
+{
+    // Um alias é um link para o arquivo de outra unidade do mesmo tipo; links
+    // para /dev/null são unidades mascaradas e valem como arquivo próprio
+    const QFileInfo info(path);
+    const QString name = info.fileName();
+    if (info.isSymLink()) {
+        const QString target = QFileInfo(info.symLinkTarget()).fileName();
+        if (target != name && target.section('.', -1) == name.section('.', -1)) {
+            m_aliases.insert(name, target);
+            return;
+        }
+    }
+    
+    // Unidades só instaladas não aparecem em ListUnits: ficam inativas
+    UnitState &state = m_units[name];
+    if (state.activeState.isEmpty()) {
+        state.activeState = "inactive";
+    }
+    state.unitFileState = fileState;
+}
+
+UnitState ServiceStateProvider::unit(const QString &name) const
+{
+    const QString id = unitName(name);
+    return m_units.value(m_aliases.value(id, id));
+}
+
+QStringList ServiceStateProvider::runningServices() const
+{
+    QStringList services;
+    for (auto it = m_units.begin(); it != m_units.end(); ++it) {
+        if (it.key().endsWith(".service") && it->subState == "running") {
+            services.append(it.key());
+        }
+    }
+    services.sort();
+    return services;
+}
+
+QString ServiceStateProvider::unitName(const QString &name)
+{
+    // Sem sufixo o systemctl assume .service; manter o mesmo comportamento
+    static const QStringList suffixes = {
+        ".service", ".socket", ".timer", ".target", ".mount", ".path", ".slice", ".scope"
+    };
+    for (const QString &suffix : suffixes) {
+        if (name.endsWith(suffix)) {
+            return name;
+        }
+    }
+    return name + ".service";
+}
@@ -0,0 +1,349 @@
+#include "ShellSession.h"
+#include "TraceRecorder.h"
+#include <QDebug>
+#include <QRandomGenerator>
+
+#ifndef Q_OS_WIN
+#include <signal.h>
+#include <sys/types.h>
+
+// Laço executado pela sessão: lê comandos terminados em NUL do stdin e roda
+// cada um em um subshell isolado. Com "set -m" o subshell ganha seu próprio
+// grupo de processos; o PID (= PGID) e o código de saída voltam por marcadores.
+// O marcador chega como $1 e fica numa variável não exportada, apagada dentro
+// do subshell: um comando que lista o ambiente ou as variáveis (env, set) não
+// pode imprimi-lo e encerrar o quadro antes da hora.
+static const char *SESSION_DRIVER =
+    "__sc_marker=$1\n"
+    "set -m --\n"
+    "while IFS= read -r -d '' __sc_cmd; do\n"
+    "  ( unset __sc_marker; eval \"$__sc_cmd\" ) </dev/null 2>&1 &\n"
+    "  printf '\\n%s_PID %d\\n' \"$__sc_marker\" \"$!\"\n"
+    "  wait \"$!\"\n"
+    "  printf '\\n%s %d\\n' \"$__sc_marker\" \"$?\"\n"
+    "done\n";
+#endif
+
+// Intervalo entre SIGTERM, SIGKILL e o encerramento da sessão inteira
+static const int KILL_GRACE_MS = 2000;
+
+ShellSession::ShellSession(QObject *parent)
+    : QObject(parent)
+    , m_process(nullptr)
+    , m_decoder(QStringDecoder::System)
+    , m_busy(false)
+    , m_commandPid(0)
+    , m_commandStartUs(0)
+    , m_abortReason(AbortReason::None)
+    , m_killStage(0)
+    , m_timeoutTimer(new QTimer(this))
+    , m_killTimer(new QTimer(this))
+{
+    m_marker = QByteArray("__SC_DONE_")
+               + QByteArray::number(QRandomGenerator::global()->generate64(), 16)
+               + "__";
+    
+    m_timeoutTimer->setSingleShot(true);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &ShellSession::onTimeout);
+    
+    m_killTimer->setInterval(KILL_GRACE_MS);
+    connect(m_killTimer, &QTimer::timeout, this, &ShellSession::onKillTimer);
+}
+
+ShellSession::~ShellSession()
+{
+    if (m_process && m_process->state() != QProcess::NotRunning) {
+        m_process->disconnect(this);
+        if (m_busy) {
+            killProcessGroup(true);
+        }
+        m_process->closeWriteChannel();
+        if (!m_process->waitForFinished(1000)) {
+            m_process->kill();
+            m_process->waitForFinished(1000);
+        }
+    }
+}
+
+bool ShellSession::isBusy() const
+{
+    return m_busy;
+}
+
+void ShellSession::setOutputLimits(int headBytes, int tailBytes)
+{
+    m_output.setLimits(headBytes, tailBytes);
+}
+
+const OutputCapture &ShellSession::output() const
+{
+    return m_output;
+}
+
+bool ShellSession::run(const QString &command, int timeoutMs)
+{
+    if (m_busy || command.isEmpty()) {
+        return false;
+    }
+    
+    qDebug() << "Executando comando:" << command;
+    
+    m_command = command;
+    m_commandStartUs = TraceRecorder::now();
+    m_output.clear();
+    m_decoder.resetState();
+
+#ifdef Q_OS_WIN
+    if (!m_process) {
+        m_process = new QProcess(this);
+        m_process->setProcessChannelMode(QProcess::MergedChannels);
+        connect(m_process, &QProcess::readyReadStandardOutput,
+                this, &ShellSession::onReadyRead);
+        connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, &ShellSession::onProcessFinished);
+    }
+    
+    if (command.startsWith("powershell")) {
+        QString psCommand = command.mid(11); // Remove "powershell "
+        m_process->start("powershell.exe", QStringList() << "-Command" << psCommand);
+    } else {
+        m_process->start("cmd.exe", QStringList() << "/c" << command);
+    }
+    
+    if (!m_process->waitForStarted()) {
+        return false;
+    }
+    m_commandPid = m_process->processId();
+#else
+    if (!ensureStarted()) {
+        return false;
+    }
+    
+    m_buffer.clear();
+    m_commandPid = 0;
+    QByteArray frame = command.toUtf8();
+    frame.append('\0');
+    m_process->write(frame);
+#endif
+
+    m_busy = true;
+    m_abortReason = AbortReason::None;
+    m_killStage = 0;
+    
+    if (timeoutMs > 0) {
+        m_timeoutTimer->start(timeoutMs);
+    }
+    
+    return true;
+}
+
+void ShellSession::cancel()
+{
+    if (m_busy) {
+        abort(AbortReason::Cancelled);
+    }
+}
+
+bool ShellSession::ensureStarted()
+{
+    if (m_process && m_process->state() == QProcess::Running) {
+        return true;
+    }
+    
+    TraceSpan span("shell", "spawn");
+    
+    if (!m_process) {
+        m_process = new QProcess(this);
+        // Avisos de controle de jobs do bash vão para stderr e são descartados;
+        // a saída dos comandos já chega pelo stdout
+        m_process->setStandardErrorFile(QProcess::nullDevice());
+        connect(m_process, &QProcess::readyReadStandardOutput,
+                this, &ShellSession::onReadyRead);
+        connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, &ShellSession::onProcessFinished);
+    }
+
+#ifndef Q_OS_WIN
+    m_process->start("/bin/bash", QStringList() << "--noprofile" << "--norc" << "-c" << SESSION_DRIVER
+                                                << "securitychecker" << QString::fromLatin1(m_marker));
+#endif
+
+    if (!m_process->waitForStarted()) {
+        qWarning() << "Não foi possível iniciar a sessão de shell";
+        return false;
+    }
+    
+    return true;
+}
+
+void ShellSession::onReadyRead()
+{
+#ifdef Q_OS_WIN
+    appendOutput(m_process->readAllStandardOutput());
+#else
+    m_buffer.append(m_process->readAllStandardOutput());
+    
+    while (true) {
+        int markerIndex = m_buffer.indexOf(m_marker);
+        if (markerIndex == -1) {
+            // Repassar a saída, guardando só o final, onde o marcador (e a quebra
+            // de linha que o precede) pode estar chegando pela metade
+            int keep = m_marker.size() + 1;
+            if (m_buffer.size() > keep) {
+                appendOutput(m_buffer.left(m_buffer.size() - keep));
+                m_buffer.remove(0, m_buffer.size() - keep);
+            }
+            return;
+        }
+        
+        // O driver imprime uma quebra de linha antes de cada marcador
+        int outputEnd = markerIndex;
+        if (outputEnd > 0 && m_buffer.at(outputEnd - 1) == '\n') {
+            outputEnd--;
+        }
+        appendOutput(m_buffer.left(outputEnd));
+        m_buffer.remove(0, markerIndex);
+        
+        int lineEnd = m_buffer.indexOf('\n');
+        if (lineEnd == -1) {
+            return; // Restante da linha ainda não chegou
+        }
+        
+        QByteArray value = m_buffer.mid(m_marker.size(), lineEnd - m_marker.size());
+        m_buffer.remove(0, lineEnd + 1);
+        
+        if (value.startsWith("_PID ")) {
+            m_commandPid = value.mid(5).trimmed().toLongLong();
+            // Pedido de cancelamento chegou antes do PID
+            if (m_abortReason != AbortReason::None) {
+                killProcessGroup(false);
+            }
+            continue;
+        }
+        
+        bool ok = false;
+        int exitCode = value.trimmed().toInt(&ok);
+        completeCommand(ok ? exitCode : -1, false);
+        return;
+    }
+#endif
+}
+
+void ShellSession::appendOutput(const QByteArray &data)
+{
+    if (!m_busy || data.isEmpty()) {
+        return;
+    }
+    
+    m_output.append(data);
+    emit outputReceived(m_decoder.decode(data));
+}
+
+void ShellSession::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+#ifdef Q_OS_WIN
+    onReadyRead();
+    completeCommand(exitStatus == QProcess::CrashExit ? -1 : exitCode, false);
+#else
+    Q_UNUSED(exitCode);
+    Q_UNUSED(exitStatus);
+    
+    // A sessão morreu; o próximo comando inicia uma nova
+    if (m_busy) {
+        completeCommand(-1, true);
+    }
+#endif
+}
+
+void ShellSession::completeCommand(int exitCode, bool sessionLost)
+{
+    if (TraceRecorder::isEnabled()) {
+        QJsonObject args;
+        args["command"] = m_command;
+        args["pid"] = m_commandPid;
+        args["exit_code"] = exitCode;
+        args["output_bytes"] = m_output.totalBytes();
+        if (m_abortReason == AbortReason::TimedOut) {
+            args["timed_out"] = true;
+        }
+        TraceRecorder::completeAsync("shell", "exec", m_commandStartUs, args);
+    }
+    
+    m_timeoutTimer->stop();
+    m_killTimer->stop();
+    m_buffer.clear();
+    m_busy = false;
+    m_commandPid = 0;
+    
+    AbortReason reason = m_abortReason;
+    m_abortReason = AbortReason::None;
+    
+    if (reason == AbortReason::TimedOut) {
+        emit commandTimedOut();
+    } else if (reason == AbortReason::Cancelled) {
+        emit commandCancelled();
+    } else if (sessionLost) {
+        emit commandFailed("Sessão de shell encerrada durante o comando");
+    } else if (exitCode < 0 || exitCode > 128) {
+        // Códigos acima de 128 indicam que o comando foi encerrado por sinal
+        emit commandFailed("Comando encerrado de forma anormal");
+    } else {
+        emit commandFinished(exitCode);
+    }
+}
+
+void ShellSession::onTimeout()
+{
+    if (m_busy) {
+        qWarning() << "Tempo limite excedido, encerrando grupo de processos" << m_commandPid;
+        abort(AbortReason::TimedOut);
+    }
+}
+
+void ShellSession::abort(AbortReason reason)
+{
+    if (m_abortReason != AbortReason::None) {
+        return;
+    }
+    
+    m_abortReason = reason;
+    m_timeoutTimer->stop();
+    m_killStage = 0;
+    
+    killProcessGroup(false);
+    m_killTimer->start();
+}
+
+void ShellSession::onKillTimer()
+{
+    if (!m_busy) {
+        m_killTimer->stop();
+        return;
+    }
+    
+    m_killStage++;
+    if (m_killStage == 1) {
+        killProcessGroup(true);
+    } else {
+        // O grupo não morreu nem com SIGKILL: descartar a sessão inteira
+        m_killTimer->stop();
+        if (m_process) {
+            m_process->kill();
+        }
+    }
+}
+
+void ShellSession::killProcessGroup(bool force)
+{
+    if (m_commandPid <= 0) {
+        return;
+    }
+
+#ifdef Q_OS_WIN
+    Q_UNUSED(force);
+    // Encerrar a árvore de processos inteira
+    QProcess::execute("taskkill", QStringList() << "/T" << "/F" << "/PID" << QString::number(m_commandPid));
+#else
+    ::kill(-static_cast<pid_t>(m_commandPid), force ? SIGKILL : SIGTERM);
+#endif
+}
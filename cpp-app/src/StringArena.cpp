@@ -0,0 +1,46 @@
+#include "StringArena.h"
+
+StringArena::StringArena()
+    : m_data(1, '\0')
+{
+}
+
+StringArena::Ref StringArena::intern(const QString &text)
+{
+    if (text.isEmpty()) {
+        return 0;
+    }
+    
+    const QByteArray utf8 = text.toUtf8();
+    auto it = m_index.constFind(utf8);
+    if (it != m_index.constEnd()) {
+        return it.value();
+    }
+    
+    const Ref ref = Ref(m_data.size());
+    m_data.append(utf8);
+    m_data.append('\0');
+    m_index.insert(utf8, ref);
+    return ref;
+}
+
+QString StringArena::text(Ref ref) const
+{
+    return ref == 0 ? QString() : QString::fromUtf8(utf8(ref));
+}
+
+const char *StringArena::utf8(Ref ref) const
+{
+    return m_data.constData() + ref;
+}
+
+int StringArena::size() const
+{
+    return m_data.size();
+}
+
+void StringArena::squeeze()
+{
+    m_index = QHash<QByteArray, Ref>();
+    m_data.squeeze();
+}
@@ -1,8 +1,13 @@
 #include "SystemChecker.h"
+#include "CheckExpression.h"
+#include "Applicability.h"
+#include "PlatformFingerprint.h"
+#include "TraceRecorder.h"
 #include <QDebug>
 #include <QStandardPaths>
 #include <QDir>
 #include <QRandomGenerator>
+#include <QThread>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -12,293 +17,746 @@
 #include <sys/types.h>
 #endif
 
+const int SystemChecker::DEFAULT_CHECK_TIMEOUT_MS = 30000;
+const int SystemChecker::DEFAULT_FIX_TIMEOUT_MS = 900000;
+const int SystemChecker::DEFAULT_OUTPUT_LIMIT_BYTES = 16384;
+
 SystemChecker::SystemChecker(QObject *parent)
     : QObject(parent)
-    , m_checkProcess(nullptr)
-    , m_fixProcess(nullptr)
+    , m_fixPhase(0)
+    , m_fixActive(false)
+    , m_fixPlanStartUs(0)
+    , m_maxConcurrentChecks(qMax(2, QThread::idealThreadCount()))
+    , m_scanActive(false)
+    , m_checkTimeoutMs(DEFAULT_CHECK_TIMEOUT_MS)
+    , m_fixTimeoutMs(DEFAULT_FIX_TIMEOUT_MS)
+    , m_outputLimit(DEFAULT_OUTPUT_LIMIT_BYTES)
+    , m_resultCacheLoaded(false)
+    , m_incremental(true)
+{
+    m_checkClock.start();
+}
+
+void SystemChecker::beginScan(const QVector<VulnerabilityDefinition> &rules)
 {
+    m_facts.clear();
+    m_scanResults.clear();
+    
+    if (!m_resultCacheLoaded) {
+        m_resultCache.load();
+        m_resultCacheLoaded = true;
+    }
+    m_settledChecks.clear();
+    m_inputStamps.clear();
+    m_checkStartUs.clear();
+    m_checkRunStartNs.clear();
+    
+    m_scanRules.clear();
+    m_inapplicable.clear();
+    for (const VulnerabilityDefinition &rule : rules) {
+        m_scanRules.insert(rule.id, rule);
+        planApplicability(rule);
+    }
+}
+
+void SystemChecker::planApplicability(const VulnerabilityDefinition &rule)
+{
+    QString reason;
+    if (rule.applicability && !rule.applicability->matches(PlatformFingerprint::current(), QString(), &reason)) {
+        qDebug().noquote() << "Regra não aplicável:" << rule.id << "-" << reason;
+        m_inapplicable.insert(rule.id);
+    }
 }
 
 void SystemChecker::checkVulnerability(const VulnerabilityDefinition &vuln)
 {
-    if (m_checkProcess && m_checkProcess->state() != QProcess::NotRunning) {
-        emit errorOccurred("Uma verificação já está em andamento");
-        return;
+    scheduleCheck(vuln);
+    m_scanActive = true;
+    startPendingChecks();
+}
+
+void SystemChecker::checkAll(const QVector<VulnerabilityDefinition> &vulns)
+{
+    // Coletar de uma vez os fatos de todas as verificações do lote,
+    // exceto das que serão atendidas pelo cache
+    FactRequirements requirements;
+    for (const VulnerabilityDefinition &vuln : vulns) {
+        if (!m_scanRules.contains(vuln.id)) {
+            m_scanRules.insert(vuln.id, vuln);
+            planApplicability(vuln);
+        }
+        if (m_inapplicable.contains(vuln.id)) {
+            continue;
+        }
+        bool cached = false;
+        if (vuln.check && !cachedResult(vuln, &cached)) {
+            requirements.merge(vuln.check->requirements());
+        }
+    }
+    // O estado dos serviços chega pelo laço de eventos; a fila espera por ele
+    m_facts.prefetchServices(requirements, this, [this]() {
+        startPendingChecks();
+    });
+    m_facts.collect(requirements);
+    
+    for (const VulnerabilityDefinition &vuln : vulns) {
+        scheduleCheck(vuln);
     }
+    m_scanActive = true;
     
-    m_currentCheckId = vuln.id;
+    qDebug() << "Agendadas" << m_pendingChecks.size() << "verificações com até"
+             << m_maxConcurrentChecks << "em paralelo";
     
-    if (!m_checkProcess) {
-        m_checkProcess = new QProcess(this);
-        connect(m_checkProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                this, &SystemChecker::onCheckProcessFinished);
+    startPendingChecks();
+}
+
+void SystemChecker::recheck(const QStringList &ids)
+{
+    // Dependentes também mudam: um "skip_if" pode ter deixado de valer
+    QStringList affected = ids;
+    for (int i = 0; i < affected.size(); i++) {
+        for (const VulnerabilityDefinition &rule : m_scanRules) {
+            if (rule.dependsOn.contains(affected[i]) && !affected.contains(rule.id)) {
+                affected.append(rule.id);
+            }
+        }
     }
     
-    QString command = getCheckCommand(vuln);
-    if (command.isEmpty()) {
-        emit errorOccurred("Comando de verificação não implementado para esta vulnerabilidade");
-        return;
+    QVector<VulnerabilityDefinition> rules;
+    for (const QString &id : affected) {
+        if (!m_scanRules.contains(id)) {
+            continue;
+        }
+        const VulnerabilityDefinition &rule = m_scanRules[id];
+        if (rule.check) {
+            m_facts.invalidate(rule.check->requirements());
+        }
+        m_scanResults.remove(id);
+        m_settledChecks.remove(id);
+        m_inputStamps.remove(id);
+        rules.append(rule);
     }
     
-    if (!executeCommand(command, m_checkProcess)) {
-        emit errorOccurred("Falha ao executar comando de verificação");
+    if (!rules.isEmpty()) {
+        checkAll(rules);
     }
 }
 
-void SystemChecker::fixVulnerability(const VulnerabilityDefinition &vuln)
+void SystemChecker::scheduleCheck(const VulnerabilityDefinition &vuln)
 {
-    if (m_fixProcess && m_fixProcess->state() != QProcess::NotRunning) {
-        emit errorOccurred("Uma correção já está em andamento");
+    if (m_scheduledChecks.contains(vuln.id)) {
         return;
     }
-    
-    m_currentFixId = vuln.id;
-    
-    if (!m_fixProcess) {
-        m_fixProcess = new QProcess(this);
-        connect(m_fixProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                this, &SystemChecker::onFixProcessFinished);
+    m_scheduledChecks.insert(vuln.id);
+    m_settledChecks.remove(vuln.id);
+    if (TraceRecorder::isEnabled()) {
+        m_checkStartUs.insert(vuln.id, TraceRecorder::now());
     }
     
-    QString command = getFixCommand(vuln);
-    if (command.isEmpty()) {
-        emit errorOccurred("Comando de correção não implementado para esta vulnerabilidade");
-        return;
+    // Dependências ainda sem resultado entram na fila antes da regra;
+    // uma regra não aplicável não precisa delas
+    if (!m_inapplicable.contains(vuln.id)) {
+        for (const QString &dep : vuln.dependsOn) {
+            if (!m_settledChecks.contains(dep) && m_scanRules.contains(dep)) {
+                scheduleCheck(m_scanRules.value(dep));
+            }
+        }
     }
     
-    if (!executeCommand(command, m_fixProcess)) {
-        emit errorOccurred("Falha ao executar comando de correção");
+    m_pendingChecks.append(vuln);
+}
+
+bool SystemChecker::isReady(const VulnerabilityDefinition &vuln) const
+{
+    for (const QString &dep : vuln.dependsOn) {
+        if (m_scheduledChecks.contains(dep) && !m_settledChecks.contains(dep)) {
+            return false;
+        }
     }
+    return true;
 }
 
-bool SystemChecker::isRunningAsAdmin() const
+bool SystemChecker::isSkipped(const VulnerabilityDefinition &vuln) const
 {
-#ifdef Q_OS_WIN
-    BOOL isAdmin = FALSE;
-    PSID adminGroup = NULL;
-    SID_IDENTIFIER_AUTHORITY ntAuthority = SECURITY_NT_AUTHORITY;
+    for (auto it = vuln.skipIf.begin(); it != vuln.skipIf.end(); ++it) {
+        if (m_scanResults.contains(it.key()) && m_scanResults.value(it.key()) == it.value()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SystemChecker::settleCheck(const QString &id)
+{
+    m_scheduledChecks.remove(id);
+    m_settledChecks.insert(id);
     
-    if (AllocateAndInitializeSid(&ntAuthority, 2, SECURITY_BUILTIN_DOMAIN_RID,
-                                DOMAIN_ALIAS_RID_ADMINS, 0, 0, 0, 0, 0, 0, &adminGroup)) {
-        CheckTokenMembership(NULL, adminGroup, &isAdmin);
-        FreeSid(adminGroup);
+    // Resultados do cache e regras puladas não contam como avaliação
+    if (m_checkRunStartNs.contains(id)) {
+        m_checkDurations.insert(id, (m_checkClock.nsecsElapsed() - m_checkRunStartNs.take(id)) / 1e9);
+    } else {
+        m_checkDurations.remove(id);
     }
     
-    return isAdmin == TRUE;
-#else
-    return geteuid() == 0;
-#endif
+    // Da entrada na fila até o resultado: inclui a espera por dependências e sessões
+    if (m_checkStartUs.contains(id)) {
+        TraceRecorder::completeAsync("check", id, m_checkStartUs.take(id));
+    }
 }
 
-void SystemChecker::onCheckProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void SystemChecker::completeCheck(const QString &id, bool isVulnerable, const QString &evidence)
 {
-    if (exitStatus == QProcess::CrashExit) {
-        emit errorOccurred("Processo de verificação falhou");
-        return;
+    m_scanResults.insert(id, isVulnerable);
+    settleCheck(id);
+    emit checkCompleted(id, isVulnerable, evidence);
+}
+
+QByteArray SystemChecker::inputStamp(const VulnerabilityDefinition &vuln)
+{
+    // Um stat() por entrada e por varredura; recheck() descarta a assinatura
+    // das regras que reavalia
+    auto it = m_inputStamps.constFind(vuln.id);
+    if (it == m_inputStamps.constEnd()) {
+        it = m_inputStamps.insert(vuln.id, ResultCache::inputStamp(vuln.check->requirements()));
     }
-    
-    // Interpretar código de saída:
-    // 0 = comando encontrou algo (vulnerável)
-    // 1 = comando não encontrou nada (seguro)
-    bool isVulnerable = (exitCode == 0);
-    emit checkCompleted(m_currentCheckId, isVulnerable);
+    return *it;
 }
 
-void SystemChecker::onFixProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+bool SystemChecker::cachedResult(const VulnerabilityDefinition &vuln, bool *isVulnerable)
 {
-    if (exitStatus == QProcess::CrashExit) {
-        emit errorOccurred("Processo de correção falhou");
-        return;
+    if (!m_incremental || !vuln.check || vuln.check->isShell()) {
+        return false;
     }
     
-    // 0 = sucesso, outros = falha
-    bool success = (exitCode == 0);
-    emit fixCompleted(m_currentFixId, success);
+    return m_resultCache.lookup(vuln, inputStamp(vuln), isVulnerable);
+}
+
+void SystemChecker::setIncremental(bool enabled)
+{
+    m_incremental = enabled;
+}
+
+bool SystemChecker::isIncremental() const
+{
+    return m_incremental;
 }
 
-QString SystemChecker::getCheckCommand(const VulnerabilityDefinition &vuln) const
+void SystemChecker::setMaxConcurrentChecks(int limit)
 {
-    // Comandos reais de verificação para cada vulnerabilidade
+    m_maxConcurrentChecks = qMax(1, limit);
+    startPendingChecks();
+}
+
+int SystemChecker::maxConcurrentChecks() const
+{
+    return m_maxConcurrentChecks;
+}
+
+int SystemChecker::pendingCheckCount() const
+{
+    return m_pendingChecks.size() + m_runningChecks.size();
+}
+
+void SystemChecker::setDefaultTimeouts(int checkTimeoutMs, int fixTimeoutMs)
+{
+    m_checkTimeoutMs = checkTimeoutMs;
+    m_fixTimeoutMs = fixTimeoutMs;
+}
+
+const ScanCounters &SystemChecker::counters() const
+{
+    return m_counters;
+}
+
+double SystemChecker::checkDuration(const QString &id) const
+{
+    return m_checkDurations.value(id, -1.0);
+}
+
+void SystemChecker::setOutputLimit(int bytes)
+{
+    m_outputLimit = qMax(0, bytes);
     
-#ifdef Q_OS_WIN
-    if (vuln.id == "UAC_DISABLED") {
-        return "reg query \"HKLM\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Policies\\System\" /v EnableLUA | findstr \"0x0\"";
-    }
-    else if (vuln.id == "FIREWALL_DISABLED") {
-        return "netsh advfirewall show allprofiles state | findstr \"OFF\"";
-    }
-    else if (vuln.id == "SMB1_ENABLED") {
-        return "powershell \"Get-WindowsOptionalFeature -Online -FeatureName SMB1Protocol | Where-Object {$_.State -eq 'Enabled'}\"";
+    // Sessões ocupadas mantêm o limite até o próximo comando
+    for (ShellSession *session : m_checkSessions + m_fixSessions) {
+        if (!session->isBusy()) {
+            session->setOutputLimits(m_outputLimit / 4, m_outputLimit - m_outputLimit / 4);
+        }
     }
-    else if (vuln.id == "AUTORUN_ENABLED") {
-        return "reg query \"HKCU\\Software\\Microsoft\\Windows\\CurrentVersion\\Policies\\Explorer\" /v NoDriveTypeAutoRun | findstr \"0x\"";
-    }
-    else if (vuln.id == "WINDOWS_UPDATE_DISABLED") {
-        return "sc query wuauserv | findstr \"STOPPED\"";
-    }
-    else if (vuln.id == "RDP_PORT_OPEN") {
-        return "netstat -an | findstr \":3389\"";
-    }
-    else if (vuln.id == "ADMIN_USER_DEFAULT") {
-        return "net user Administrator | findstr \"Account active.*Yes\"";
-    }
-    else if (vuln.id == "MACROS_ENABLED") {
-        return "reg query \"HKCU\\Software\\Microsoft\\Office\\16.0\\Excel\\Security\" /v VBAWarnings | findstr \"0x1\"";
-    }
-    else if (vuln.id == "ANTIVIRUS_DISABLED") {
-        return "powershell \"Get-MpPreference | Where-Object {$_.DisableRealtimeMonitoring -eq $true}\"";
-    }
-    else if (vuln.id == "GUEST_ACCOUNT_ENABLED") {
-        return "net user Guest | findstr \"Account active.*Yes\"";
-    }
-#elif defined(Q_OS_LINUX)
-    if (vuln.id == "SSH_ROOT_LOGIN") {
-        return "grep -i '^PermitRootLogin yes' /etc/ssh/sshd_config";
-    }
-    else if (vuln.id == "NO_FIREWALL") {
-        // Verificar se UFW não está instalado
-        return "! command -v ufw >/dev/null 2>&1";
-    }
-    else if (vuln.id == "UFW_INACTIVE") {
-        // Verificar se UFW está instalado mas inativo
-        return "command -v ufw >/dev/null 2>&1 && ufw status | grep -i 'Status: inactive'";
+}
+
+int SystemChecker::outputLimit() const
+{
+    return m_outputLimit;
+}
+
+void SystemChecker::cancelChecks()
+{
+    // Regras ainda na fila terminam sem resultado, como as em execução
+    const QList<VulnerabilityDefinition> pending = m_pendingChecks;
+    m_pendingChecks.clear();
+    for (const VulnerabilityDefinition &vuln : pending) {
+        settleCheck(vuln.id);
+        emit checkTimedOut(vuln.id, QString());
     }
-    else if (vuln.id == "SSH_DEFAULT_PORT") {
-        return "grep -q '^Port 22$' /etc/ssh/sshd_config 2>/dev/null || (! grep -q '^Port' /etc/ssh/sshd_config 2>/dev/null && test -f /etc/ssh/sshd_config)";
+    
+    // As sessões respondem com commandCancelled depois que o grupo de processos morre
+    const QList<ShellSession *> sessions = m_runningChecks.keys();
+    for (ShellSession *session : sessions) {
+        session->cancel();
     }
-    else if (vuln.id == "FAIL2BAN_NOT_INSTALLED") {
-        return "! command -v fail2ban-server >/dev/null 2>&1";
+    
+    startPendingChecks();
+}
+
+void SystemChecker::cancelFix()
+{
+    if (!m_fixActive) {
+        return;
     }
-    else if (vuln.id == "FAIL2BAN_INACTIVE") {
-        return "command -v fail2ban-server >/dev/null 2>&1 && ! systemctl is-active fail2ban >/dev/null 2>&1";
+    
+    // Fases seguintes não começam; os passos em andamento encerram seus grupos de processos
+    m_fixPhase = m_fixPlan.phases.size();
+    const QList<ShellSession *> sessions = m_runningFixSteps.keys();
+    for (ShellSession *session : sessions) {
+        session->cancel();
     }
-    else if (vuln.id == "UNATTENDED_UPGRADES_OFF") {
-        return "! dpkg -l | grep -q unattended-upgrades || ! systemctl is-enabled unattended-upgrades >/dev/null 2>&1";
+}
+
+void SystemChecker::startPendingChecks()
+{
+    // Nada começa enquanto a consulta ao systemd não responde
+    if (m_facts.isWaitingForServices()) {
+        return;
     }
-    else if (vuln.id == "APPARMOR_NOT_INSTALLED") {
-        return "! command -v apparmor_status >/dev/null 2>&1";
+    
+    // Percorre a fila em ordem topológica: só inicia regras cujas dependências
+    // já terminaram. Regras nativas concluem na hora e podem liberar outras,
+    // por isso a fila é percorrida de novo enquanto houver progresso.
+    bool progress = true;
+    while (progress && !m_pendingChecks.isEmpty() && m_runningChecks.size() < m_maxConcurrentChecks) {
+        progress = false;
+        
+        for (int i = 0; i < m_pendingChecks.size() && m_runningChecks.size() < m_maxConcurrentChecks; ) {
+            // Fora do "applies_to": decidido no início da varredura, sem custo
+            if (m_inapplicable.contains(m_pendingChecks[i].id)) {
+                const QString id = m_pendingChecks.takeAt(i).id;
+                progress = true;
+                settleCheck(id);
+                emit checkNotApplicable(id);
+                continue;
+            }
+            
+            if (!isReady(m_pendingChecks[i])) {
+                i++;
+                continue;
+            }
+            
+            VulnerabilityDefinition vuln = m_pendingChecks.takeAt(i);
+            progress = true;
+            
+            // A pré-condição já decidiu o resultado: nada a executar
+            if (isSkipped(vuln)) {
+                settleCheck(vuln.id);
+                emit checkNotApplicable(vuln.id);
+                continue;
+            }
+            
+            if (!vuln.check) {
+                settleCheck(vuln.id);
+                emit errorOccurred("Comando de verificação não implementado para esta vulnerabilidade");
+                continue;
+            }
+            
+            // Regra que chegou sem checkAll() (checkVulnerability, dependências) e
+            // é a primeira a pedir serviços: volta para a fila até o systemd responder
+            if (!vuln.check->isShell()
+                && m_facts.prefetchServices(vuln.check->requirements(), this, [this]() { startPendingChecks(); })) {
+                m_pendingChecks.insert(i, vuln);
+                return;
+            }
+            
+            // Primitivas nativas são avaliadas sobre a fotografia de fatos, sem criar processo
+            if (!vuln.check->isShell()) {
+                // Assinatura tirada antes da leitura (em checkAll, quando a regra
+                // veio por ele): uma mudança no meio invalida o resultado
+                const QByteArray stamp = inputStamp(vuln);
+                
+                bool isVulnerable = false;
+                QString evidence;
+                if (m_incremental && m_resultCache.lookup(vuln, stamp, &isVulnerable, &evidence)) {
+                    qDebug() << "Resultado em cache:" << vuln.id;
+                    completeCheck(vuln.id, isVulnerable, evidence);
+                    continue;
+                }
+                
+                // A duração conta só avaliações de verdade, não acertos do cache
+                m_checkRunStartNs.insert(vuln.id, m_checkClock.nsecsElapsed());
+                m_facts.collect(vuln.check->requirements());
+                isVulnerable = vuln.check->evaluate(m_facts);
+                evidence = vuln.check->evidence(m_facts);
+                m_resultCache.store(vuln, stamp, isVulnerable, evidence);
+                completeCheck(vuln.id, isVulnerable, evidence);
+                continue;
+            }
+            
+            QString command = vuln.check->shellCommand();
+            ShellSession *session = idleCheckSession();
+            int timeoutMs = vuln.checkTimeoutMs > 0 ? vuln.checkTimeoutMs : m_checkTimeoutMs;
+            m_checkRunStartNs.insert(vuln.id, m_checkClock.nsecsElapsed());
+            if (!session->run(command, timeoutMs)) {
+                m_counters.failures++;
+                settleCheck(vuln.id);
+                emit errorOccurred("Falha ao executar comando de verificação");
+                continue;
+            }
+            m_counters.commands++;
+            m_runningChecks.insert(session, vuln.id);
+        }
     }
-    else if (vuln.id == "APPARMOR_INACTIVE") {
-        return "command -v apparmor_status >/dev/null 2>&1 && ! systemctl is-active apparmor >/dev/null 2>&1";
+    
+    // Ciclo de dependências: nada está pronto e nada está rodando
+    if (!progress && m_runningChecks.isEmpty() && !m_pendingChecks.isEmpty()) {
+        qWarning() << "Ciclo de dependências entre regras; executando" << m_pendingChecks.first().id << "sem aguardar";
+        m_pendingChecks.first().dependsOn.clear();
+        startPendingChecks();
+        return;
     }
-    else if (vuln.id == "SUDO_NOPASSWD") {
-        return "grep -r 'NOPASSWD' /etc/sudoers /etc/sudoers.d/ 2>/dev/null";
+    
+    if (m_scanActive && m_pendingChecks.isEmpty() && m_runningChecks.isEmpty()) {
+        m_scanActive = false;
+        m_resultCache.save();
+        emit allChecksCompleted();
     }
-    else if (vuln.id == "WEAK_FILE_PERMS") {
-        return "stat -c '%a' /etc/passwd | grep -v '^644$' || stat -c '%a' /etc/shadow | grep -v '^600$' || stat -c '%a' /etc/group | grep -v '^644$' || stat -c '%a' /etc/gshadow | grep -v '^600$'";
+}
+
+ShellSession *SystemChecker::idleCheckSession()
+{
+    for (ShellSession *session : m_checkSessions) {
+        if (!m_runningChecks.contains(session)) {
+            return session;
+        }
     }
-    else if (vuln.id == "OLD_KERNEL") {
-        return "apt list --upgradable 2>/dev/null | grep linux-image";
+    
+    ShellSession *session = createSession();
+    connect(session, &ShellSession::commandFinished,
+            this, &SystemChecker::onCheckCommandFinished);
+    connect(session, &ShellSession::commandFailed,
+            this, &SystemChecker::onCheckCommandFailed);
+    connect(session, &ShellSession::commandTimedOut,
+            this, &SystemChecker::onCheckCommandTimedOut);
+    connect(session, &ShellSession::commandCancelled,
+            this, &SystemChecker::onCheckCommandCancelled);
+    connect(session, &ShellSession::outputReceived,
+            this, &SystemChecker::onCheckOutput);
+    m_checkSessions.append(session);
+    return session;
+}
+
+ShellSession *SystemChecker::createSession()
+{
+    ShellSession *session = new ShellSession(this);
+    session->setOutputLimits(m_outputLimit / 4, m_outputLimit - m_outputLimit / 4);
+    return session;
+}
+
+ShellSession *SystemChecker::takeRunningCheck(QString &id)
+{
+    ShellSession *session = qobject_cast<ShellSession *>(sender());
+    if (!session || !m_runningChecks.contains(session)) {
+        return nullptr;
     }
-#elif defined(Q_OS_MACOS)
-    if (vuln.id == "GATEKEEPER_OFF") {
-        return "spctl --status | grep 'assessments disabled'";
+    
+    id = m_runningChecks.take(session);
+    return session;
+}
+
+void SystemChecker::fixVulnerability(const VulnerabilityDefinition &vuln)
+{
+    fixAll(QVector<VulnerabilityDefinition>() << vuln);
+}
+
+void SystemChecker::fixAll(const QVector<VulnerabilityDefinition> &vulns)
+{
+    if (m_fixActive) {
+        emit errorOccurred("Uma correção já está em andamento");
+        return;
     }
-    else if (vuln.id == "FIREWALL_OFF") {
-        return "/usr/libexec/ApplicationFirewall/socketfilterfw --getglobalstate | grep 'Firewall is disabled'";
+    
+    m_fixPlan = RemediationPlanner().plan(vulns);
+    if (m_fixPlan.isEmpty()) {
+        emit errorOccurred("Comando de correção não implementado para esta vulnerabilidade");
+        return;
     }
-    else if (vuln.id == "NO_FILEVAULT") {
-        return "fdesetup status | grep 'FileVault is Off'";
+    
+    qDebug().noquote() << "Plano de correção com" << m_fixPlan.stepCount() << "passos:\n" << m_fixPlan.toScript();
+    
+    m_fixPhase = 0;
+    m_failedFixes.clear();
+    m_timedOutFixes.clear();
+    m_fixLogs.clear();
+    m_fixActive = true;
+    m_fixPlanStartUs = TraceRecorder::now();
+    startFixPhase();
+}
+
+bool SystemChecker::isFixing() const
+{
+    return m_fixActive;
+}
+
+void SystemChecker::startFixPhase()
+{
+    while (m_fixPhase < m_fixPlan.phases.size()) {
+        const QVector<RemediationStep> &phase = m_fixPlan.phases[m_fixPhase];
+        
+        for (const RemediationStep &step : phase) {
+            bool blocked = false;
+            for (const QString &id : step.ruleIds) {
+                blocked = blocked || (step.requiresRules && m_failedFixes.contains(id));
+            }
+            if (blocked) {
+                // As regras do passo ficam como falhas, com o motivo no log
+                qWarning() << "Passo de correção ignorado:" << step.description;
+                const QString log = "# " + step.description + "\nIgnorado: um passo anterior das regras falhou";
+                for (const QString &id : step.ruleIds) {
+                    m_failedFixes.insert(id);
+                    QString &ruleLog = m_fixLogs[id];
+                    ruleLog += ruleLog.isEmpty() ? log : "\n" + log;
+                }
+                continue;
+            }
+            
+            ShellSession *session = nullptr;
+            for (ShellSession *candidate : m_fixSessions) {
+                if (!m_runningFixSteps.contains(candidate)) {
+                    session = candidate;
+                    break;
+                }
+            }
+            if (!session) {
+                session = createSession();
+                connect(session, &ShellSession::commandFinished,
+                        this, &SystemChecker::onFixCommandFinished);
+                connect(session, &ShellSession::commandFailed,
+                        this, &SystemChecker::onFixCommandFailed);
+                connect(session, &ShellSession::commandTimedOut,
+                        this, &SystemChecker::onFixCommandTimedOut);
+                connect(session, &ShellSession::commandCancelled,
+                        this, &SystemChecker::onFixCommandCancelled);
+                connect(session, &ShellSession::outputReceived,
+                        this, &SystemChecker::onFixOutput);
+                m_fixSessions.append(session);
+            }
+            
+            int timeoutMs = step.timeoutMs > 0 ? step.timeoutMs : m_fixTimeoutMs;
+            qDebug() << "Correção:" << step.description;
+            if (!session->run(step.command, timeoutMs)) {
+                m_counters.failures++;
+                for (const QString &id : step.ruleIds) {
+                    m_failedFixes.insert(id);
+                }
+                emit errorOccurred("Falha ao executar comando de correção");
+                continue;
+            }
+            m_counters.commands++;
+            m_runningFixSteps.insert(session, step);
+            m_fixStepStartUs.insert(session, TraceRecorder::now());
+        }
+        
+        m_fixPhase++;
+        
+        // A próxima fase espera todos os passos desta terminarem
+        if (!m_runningFixSteps.isEmpty()) {
+            return;
+        }
     }
-    else if (vuln.id == "AUTOMOUNT_USB") {
-        return "defaults read /Library/Preferences/SystemConfiguration/autodiskmount AutomountDisksWithoutUserLogin | grep 1";
+    
+    if (m_runningFixSteps.isEmpty()) {
+        finishFixPlan();
     }
-    else if (vuln.id == "ICLOUD_BACKUP_ON") {
-        return "defaults read ~/Library/Preferences/MobileMeAccounts Accounts | grep Documents";
+}
+
+void SystemChecker::finishFixStep(bool success, bool timedOut)
+{
+    ShellSession *session = qobject_cast<ShellSession *>(sender());
+    if (!session || !m_runningFixSteps.contains(session)) {
+        return;
     }
-    else if (vuln.id == "UNKNOWN_EXTENSIONS_ENABLED") {
-        return "spctl --list | grep 'unknown'";
+    
+    const RemediationStep step = m_runningFixSteps.take(session);
+    const qint64 stepStartUs = m_fixStepStartUs.take(session);
+    if (TraceRecorder::isEnabled()) {
+        QJsonObject args;
+        args["rules"] = step.ruleIds.join(',');
+        args["success"] = success;
+        args["timed_out"] = timedOut;
+        TraceRecorder::completeAsync("fix", step.description, stepStartUs, args);
     }
-    else if (vuln.id == "NO_PASSWORD_SLEEP") {
-        return "defaults read com.apple.screensaver askForPassword | grep 0";
+    
+    const OutputCapture &output = session->output();
+    if (!output.isEmpty()) {
+        const QString log = "# " + step.description + "\n" + output.text();
+        for (const QString &id : step.ruleIds) {
+            QString &ruleLog = m_fixLogs[id];
+            ruleLog += ruleLog.isEmpty() ? log : "\n" + log;
+        }
     }
-    else if (vuln.id == "SHARING_SERVICES_ON") {
-        return "launchctl list | grep com.apple.sharing";
+    
+    if (!success) {
+        qWarning() << "Passo de correção falhou:" << step.description;
+        for (const QString &id : step.ruleIds) {
+            m_failedFixes.insert(id);
+            if (timedOut) {
+                m_timedOutFixes.insert(id);
+            }
+        }
     }
-    else if (vuln.id == "SIP_DISABLED") {
-        return "csrutil status | grep disabled";
+    
+    if (m_runningFixSteps.isEmpty()) {
+        startFixPhase();
     }
-    else if (vuln.id == "REMOTE_LOGIN_ENABLED") {
-        return "systemsetup -getremotelogin | grep On";
+}
+
+void SystemChecker::finishFixPlan()
+{
+    m_fixActive = false;
+    TraceRecorder::completeAsync("fix", "plan", m_fixPlanStartUs,
+                                 QJsonObject{ { "steps", m_fixPlan.stepCount() } });
+    
+    for (const QString &id : m_fixPlan.ruleIds) {
+        const QString log = m_fixLogs.value(id);
+        if (m_timedOutFixes.contains(id)) {
+            emit fixTimedOut(id, log);
+        } else {
+            emit fixCompleted(id, !m_failedFixes.contains(id), log);
+        }
     }
-#endif
     
-    return QString(); // Comando não implementado
+    m_fixPlan = RemediationPlan();
+    m_fixLogs.clear();
 }
 
-QString SystemChecker::getFixCommand(const VulnerabilityDefinition &vuln) const
+bool SystemChecker::isRunningAsAdmin() const
 {
-    // Comandos de correção específicos e inteligentes
+#ifdef Q_OS_WIN
+    BOOL isAdmin = FALSE;
+    PSID adminGroup = NULL;
+    SID_IDENTIFIER_AUTHORITY ntAuthority = SECURITY_NT_AUTHORITY;
     
-#ifdef Q_OS_LINUX
-    if (vuln.id == "NO_FIREWALL") {
-        // Instalar UFW
-        return "echo 'Instalando UFW...' && apt update && apt install -y ufw && echo 'UFW instalado com sucesso!'";
-    }
-    else if (vuln.id == "UFW_INACTIVE") {
-        // Ativar UFW
-        return "echo 'Ativando UFW...' && ufw --force enable && echo 'UFW ativado com sucesso!'";
-    }
-    else if (vuln.id == "SSH_DEFAULT_PORT") {
-        return "echo 'Configurando SSH na porta 2222...' && "
-               "cp /etc/ssh/sshd_config /etc/ssh/sshd_config.backup && "
-               "if grep -q '^Port' /etc/ssh/sshd_config; then "
-               "  sed -i 's/^Port.*/Port 2222/' /etc/ssh/sshd_config; "
-               "else "
-               "  echo 'Port 2222' >> /etc/ssh/sshd_config; "
-               "fi && "
-               "sshd -t && "
-               "systemctl restart sshd && "
-               "echo 'SSH configurado na porta 2222 com sucesso!'";
-    }
-    else if (vuln.id == "FAIL2BAN_NOT_INSTALLED") {
-        return "echo 'Instalando Fail2Ban...' && apt update && apt install -y fail2ban && echo 'Fail2Ban instalado com sucesso!'";
-    }
-    else if (vuln.id == "FAIL2BAN_INACTIVE") {
-        return "echo 'Ativando Fail2Ban...' && systemctl enable fail2ban && systemctl start fail2ban && echo 'Fail2Ban ativado com sucesso!'";
-    }
-    else if (vuln.id == "UNATTENDED_UPGRADES_OFF") {
-        return "echo 'Configurando atualizações automáticas...' && apt update && apt install -y unattended-upgrades && echo 'unattended-upgrades unattended-upgrades/enable_auto_updates boolean true' | debconf-set-selections && dpkg-reconfigure -f noninteractive unattended-upgrades && echo 'Atualizações automáticas configuradas!'";
-    }
-    else if (vuln.id == "APPARMOR_NOT_INSTALLED") {
-        return "echo 'Instalando AppArmor...' && apt update && apt install -y apparmor apparmor-utils && echo 'AppArmor instalado com sucesso!'";
-    }
-    else if (vuln.id == "APPARMOR_INACTIVE") {
-        return "echo 'Ativando AppArmor...' && systemctl enable apparmor && systemctl start apparmor && echo 'AppArmor ativado com sucesso!'";
-    }
-    else if (vuln.id == "SUDO_NOPASSWD") {
-        return "echo 'Removendo configurações NOPASSWD...' && sed -i '/NOPASSWD/d' /etc/sudoers && find /etc/sudoers.d/ -type f -exec sed -i '/NOPASSWD/d' {} \\; && echo 'Configurações NOPASSWD removidas!'";
+    if (AllocateAndInitializeSid(&ntAuthority, 2, SECURITY_BUILTIN_DOMAIN_RID,
+                                DOMAIN_ALIAS_RID_ADMINS, 0, 0, 0, 0, 0, 0, &adminGroup)) {
+        CheckTokenMembership(NULL, adminGroup, &isAdmin);
+        FreeSid(adminGroup);
     }
-    else if (vuln.id == "WEAK_FILE_PERMS") {
-        return "echo 'Corrigindo permissões de arquivos...' && chmod 644 /etc/passwd && chmod 600 /etc/shadow && chmod 644 /etc/group && chmod 600 /etc/gshadow && echo 'Permissões corrigidas!'";
+    
+    return isAdmin == TRUE;
+#else
+    return geteuid() == 0;
+#endif
+}
+
+void SystemChecker::onCheckCommandFinished(int exitCode)
+{
+    QString id;
+    ShellSession *session = takeRunningCheck(id);
+    if (!session) {
+        return;
     }
-    else if (vuln.id == "OLD_KERNEL") {
-        return "echo 'Atualizando sistema...' && apt update && apt upgrade -y && echo 'Sistema atualizado! Reinicie quando possível.'";
+    
+    // Interpretar código de saída:
+    // 0 = comando encontrou algo (vulnerável)
+    // 1 = comando não encontrou nada (seguro)
+    bool isVulnerable = (exitCode == 0);
+    completeCheck(id, isVulnerable, session->output().text());
+    
+    startPendingChecks();
+}
+
+void SystemChecker::onCheckCommandFailed(const QString &error)
+{
+    QString id;
+    if (!takeRunningCheck(id)) {
+        return;
     }
-#endif
     
-    // Para outras vulnerabilidades, usar comando da definição
-    return vuln.fix;
+    m_counters.failures++;
+    settleCheck(id);
+    qWarning() << "Verificação" << id << "falhou:" << error;
+    emit errorOccurred("Processo de verificação falhou");
+    
+    startPendingChecks();
 }
 
-bool SystemChecker::executeCommand(const QString &command, QProcess *process)
+void SystemChecker::onCheckCommandTimedOut()
 {
-    if (command.isEmpty() || !process) {
-        return false;
+    QString id;
+    ShellSession *session = takeRunningCheck(id);
+    if (!session) {
+        return;
     }
     
-    qDebug() << "Executando comando:" << command;
+    m_counters.timeouts++;
+    settleCheck(id);
+    qWarning() << "Verificação" << id << "excedeu o tempo limite";
+    emit checkTimedOut(id, session->output().text());
     
-#ifdef Q_OS_WIN
-    if (command.startsWith("powershell")) {
-        QString psCommand = command.mid(11); // Remove "powershell "
-        process->start("powershell.exe", QStringList() << "-Command" << psCommand);
-    } else {
-        process->start("cmd.exe", QStringList() << "/c" << command);
+    startPendingChecks();
+}
+
+void SystemChecker::onCheckCommandCancelled()
+{
+    QString id;
+    ShellSession *session = takeRunningCheck(id);
+    if (!session) {
+        return;
     }
-#else
-    process->start("/bin/bash", QStringList() << "-c" << command);
-#endif
     
-    return process->waitForStarted();
+    // Sem resultado, como no tempo esgotado: a linha sai de "Verificando..." e
+    // o modo headless não a conta como pendente
+    settleCheck(id);
+    qDebug() << "Verificação cancelada:" << id;
+    emit checkTimedOut(id, session->output().text());
+    
+    startPendingChecks();
+}
+
+void SystemChecker::onFixCommandFinished(int exitCode)
+{
+    // 0 = sucesso, outros = falha
+    finishFixStep(exitCode == 0, false);
+}
+
+void SystemChecker::onFixCommandFailed(const QString &error)
+{
+    qWarning() << "Correção falhou:" << error;
+    m_counters.failures++;
+    finishFixStep(false, false);
+}
+
+void SystemChecker::onFixCommandTimedOut()
+{
+    m_counters.timeouts++;
+    finishFixStep(false, true);
+}
+
+void SystemChecker::onFixCommandCancelled()
+{
+    finishFixStep(false, false);
+}
+
+void SystemChecker::onCheckOutput(const QString &text)
+{
+    ShellSession *session = qobject_cast<ShellSession *>(sender());
+    if (session && m_runningChecks.contains(session)) {
+        emit checkOutput(m_runningChecks.value(session), text);
+    }
+}
+
+void SystemChecker::onFixOutput(const QString &text)
+{
+    ShellSession *session = qobject_cast<ShellSession *>(sender());
+    if (session && m_runningFixSteps.contains(session)) {
+        emit fixOutput(m_runningFixSteps.value(session).description, text);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,405 @@
+#include "SystemFacts.h"
+#include "TraceRecorder.h"
+#include <QFile>
+#include <QDir>
+#include <QStandardPaths>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// PATH usado para procurar binários dentro de uma raiz alternativa
+static const QStringList ROOT_PATH_DIRS = {
+    "/usr/local/sbin", "/usr/local/bin", "/usr/sbin", "/usr/bin", "/sbin", "/bin"
+};
+
+void FactRequirements::merge(const FactRequirements &other)
+{
+    auto append = [](QStringList &target, const QStringList &source) {
+        for (const QString &item : source) {
+            if (!target.contains(item)) {
+                target.append(item);
+            }
+        }
+    };
+    
+    append(files, other.files);
+    append(directories, other.directories);
+    append(binaries, other.binaries);
+    append(services, other.services);
+    append(packages, other.packages);
+    append(upgradable, other.upgradable);
+    append(ports, other.ports);
+}
+
+bool FactRequirements::needsLiveSystem() const
+{
+    if (!services.isEmpty() || !ports.isEmpty()) {
+        return true;
+    }
+    for (const QString &path : files) {
+        if (path.startsWith("/proc/")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SystemFacts::SystemFacts()
+    : m_serviceStatesQueried(false)
+    , m_packagesLoaded(false)
+    , m_packageCandidatesLoaded(false)
+{
+}
+
+void SystemFacts::setRoot(const QString &root)
+{
+    const QString cleaned = root.isEmpty() ? QString() : QDir::cleanPath(root);
+    m_root = (cleaned == "/") ? QString() : cleaned;
+    m_packages.setRoot(m_root);
+    clear();
+}
+
+QString SystemFacts::root() const
+{
+    return m_root;
+}
+
+QString SystemFacts::resolveInRoot(const QString &root, const QString &path)
+{
+#ifndef _WIN32
+    QStringList pending = path.split('/', Qt::SkipEmptyParts);
+    QStringList resolved;
+    int links = 0;
+    
+    while (!pending.isEmpty()) {
+        const QString part = pending.takeFirst();
+        if (part == ".") {
+            continue;
+        }
+        if (part == "..") {
+            if (!resolved.isEmpty()) {
+                resolved.removeLast();
+            }
+            continue;
+        }
+        
+        resolved.append(part);
+        const QByteArray current = QFile::encodeName(root + '/' + resolved.join('/'));
+        char target[4096];
+        ssize_t length = readlink(current.constData(), target, sizeof(target) - 1);
+        if (length < 0) {
+            continue; // não é link, ou não existe
+        }
+        if (++links > 40) {
+            break; // laço de links
+        }
+        target[length] = '\0';
+        
+        // O link substitui o componente; absoluto recomeça na raiz
+        resolved.removeLast();
+        if (target[0] == '/') {
+            resolved.clear();
+        }
+        pending = QFile::decodeName(target).split('/', Qt::SkipEmptyParts) + pending;
+    }
+    
+    return root + '/' + resolved.join('/');
+#else
+    return root + path;
+#endif
+}
+
+void SystemFacts::collect(const FactRequirements &requirements)
+{
+    TraceSpan span("facts", "collect");
+    if (!m_root.isEmpty()) {
+        span.setArg("root", m_root);
+    }
+    
+    // Fatos já presentes na fotografia não são coletados de novo
+    for (const QString &path : requirements.files) {
+        collectFile(path);
+    }
+    
+    for (const QString &dirPath : requirements.directories) {
+        if (m_directories.contains(dirPath)) {
+            continue;
+        }
+        
+        QStringList entries;
+        QDir dir(m_root.isEmpty() ? dirPath : resolveInRoot(m_root, dirPath));
+        const QStringList names = dir.entryList(QDir::Files | QDir::Hidden, QDir::Name);
+        for (const QString &name : names) {
+            // Caminhos guardados como vistos de dentro da raiz
+            QString path = QDir(dirPath).filePath(name);
+            collectFile(path);
+            entries.append(path);
+        }
+        m_directories.insert(dirPath, entries);
+    }
+    
+    for (const QString &binary : requirements.binaries) {
+        if (m_binaries.contains(binary)) {
+            continue;
+        }
+        m_binaries.insert(binary, findBinary(m_root, binary));
+    }
+    
+    // Estado em execução não existe em uma raiz alternativa
+    QStringList missingServices;
+    for (const QString &unit : requirements.services) {
+        if (!m_services.contains(unit)) {
+            missingServices.append(unit);
+        }
+    }
+    if (!missingServices.isEmpty() && m_root.isEmpty()) {
+        collectServices(missingServices);
+    }
+    
+    if ((!requirements.packages.isEmpty() || !requirements.upgradable.isEmpty()) && !m_packagesLoaded) {
+        collectPackages();
+    }
+    
+    if (!requirements.upgradable.isEmpty() && !m_packageCandidatesLoaded) {
+        TraceSpan candidatesSpan("facts", "apt_candidates");
+        m_packageCandidatesLoaded = true;
+        m_packages.loadAptCandidates();
+    }
+    
+    if (!requirements.ports.isEmpty() && !m_network.isLoaded() && m_root.isEmpty()) {
+        TraceSpan networkSpan("facts", "network");
+        m_network.collect();
+    }
+    
+    if (!m_collectedAt.isValid()) {
+        m_collectedAt = QDateTime::currentDateTimeUtc();
+    }
+}
+
+bool SystemFacts::prefetchServices(const FactRequirements &requirements, QObject *context,
+                                   const std::function<void()> &onReady)
+{
+#ifdef Q_OS_LINUX
+    if (requirements.services.isEmpty() || !m_root.isEmpty() || m_serviceStatesQueried) {
+        return false;
+    }
+    
+    m_serviceStatesQueried = true;
+    m_serviceStates.refreshAsync(context, onReady);
+    return true;
+#else
+    Q_UNUSED(requirements);
+    Q_UNUSED(context);
+    Q_UNUSED(onReady);
+    return false;
+#endif
+}
+
+bool SystemFacts::isWaitingForServices() const
+{
+    return m_serviceStates.isRefreshing();
+}
+
+void SystemFacts::clear()
+{
+    m_files.clear();
+    m_directories.clear();
+    m_binaries.clear();
+    m_services.clear();
+    m_serviceStates.clear();
+    m_serviceStatesQueried = false;
+    m_packages.clear();
+    m_packagesLoaded = false;
+    m_packageCandidatesLoaded = false;
+    m_network.clear();
+    m_collectedAt = QDateTime();
+}
+
+void SystemFacts::invalidate(const FactRequirements &requirements)
+{
+    for (const QString &path : requirements.files) {
+        m_files.remove(path);
+    }
+    for (const QString &dirPath : requirements.directories) {
+        const QStringList entries = m_directories.take(dirPath);
+        for (const QString &path : entries) {
+            m_files.remove(path);
+        }
+    }
+    for (const QString &binary : requirements.binaries) {
+        m_binaries.remove(binary);
+    }
+    for (const QString &unit : requirements.services) {
+        m_services.remove(unit);
+    }
+    if (!requirements.services.isEmpty()) {
+        m_serviceStates.clear();
+        m_serviceStatesQueried = false;
+    }
+    if (!requirements.packages.isEmpty() || !requirements.upgradable.isEmpty()) {
+        m_packages.clear();
+        m_packagesLoaded = false;
+        m_packageCandidatesLoaded = false;
+    }
+    if (!requirements.ports.isEmpty()) {
+        m_network.clear();
+    }
+}
+
+bool SystemFacts::findBinary(const QString &root, const QString &name)
+{
+    if (root.isEmpty()) {
+        return !QStandardPaths::findExecutable(name).isEmpty();
+    }
+    
+    for (const QString &dir : ROOT_PATH_DIRS) {
+        const QFileInfo info(resolveInRoot(root, dir + '/' + name));
+        if (info.isFile() && info.isExecutable()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SystemFacts::isEmpty() const
+{
+    return !m_collectedAt.isValid();
+}
+
+QDateTime SystemFacts::collectedAt() const
+{
+    return m_collectedAt;
+}
+
+bool SystemFacts::fileExists(const QString &path) const
+{
+    return m_files.value(path).exists;
+}
+
+QByteArray SystemFacts::fileContent(const QString &path) const
+{
+    return m_files.value(path).content;
+}
+
+int SystemFacts::fileMode(const QString &path) const
+{
+    const FileFact fact = m_files.value(path);
+    return fact.exists ? static_cast<int>(fact.mode) : -1;
+}
+
+QStringList SystemFacts::filesInDirectory(const QString &dir) const
+{
+    return m_directories.value(dir);
+}
+
+bool SystemFacts::hasBinary(const QString &name) const
+{
+    return m_binaries.value(name, false);
+}
+
+bool SystemFacts::isServiceActive(const QString &unit) const
+{
+    return m_services.value(unit).activeState == "active";
+}
+
+bool SystemFacts::isServiceEnabled(const QString &unit) const
+{
+    return m_services.value(unit).enabledState == "enabled";
+}
+
+bool SystemFacts::isPackageInstalled(const QString &name) const
+{
+    return m_packages.contains(name);
+}
+
+bool SystemFacts::hasPackageUpdate(const QString &namePattern) const
+{
+    return !m_packages.upgradable(namePattern).isEmpty();
+}
+
+const PackageInventory &SystemFacts::packages() const
+{
+    return m_packages;
+}
+
+bool SystemFacts::isPortListening(quint16 port, const QString &protocol, bool exposedOnly) const
+{
+    return m_network.isListening(port, protocol, exposedOnly);
+}
+
+const NetworkExposure &SystemFacts::network() const
+{
+    return m_network;
+}
+
+void SystemFacts::collectFile(const QString &path)
+{
+    if (m_files.contains(path)) {
+        return;
+    }
+    
+    FileFact fact;
+    const QString realPath = m_root.isEmpty() ? path : resolveInRoot(m_root, path);
+
+#ifndef _WIN32
+    struct stat st;
+    if (::stat(QFile::encodeName(realPath).constData(), &st) == 0) {
+        fact.exists = true;
+        fact.mode = st.st_mode & 07777;
+    }
+#else
+    fact.exists = QFile::exists(realPath);
+#endif
+
+    if (fact.exists) {
+        QFile file(realPath);
+        if (file.open(QIODevice::ReadOnly)) {
+            fact.content = file.readAll();
+        }
+    }
+    
+    m_files.insert(path, fact);
+}
+
+void SystemFacts::collectServices(const QStringList &units)
+{
+    TraceSpan span("facts", "services");
+    span.setArg("units", units.size());
+    
+#ifdef Q_OS_LINUX
+    // Uma única consulta por varredura responde por todas as unidades do sistema:
+    // via D-Bus ou, sem ele (contêineres, chroot), com o systemctl
+    if (!m_serviceStatesQueried) {
+        m_serviceStatesQueried = true;
+        if (!m_serviceStates.refresh()) {
+            m_serviceStates.refreshFromSystemctl();
+        }
+    }
+    
+    // Consulta de prefetchServices() ainda em andamento: nada a registrar
+    if (m_serviceStates.isRefreshing()) {
+        return;
+    }
+    
+    // Unidades desconhecidas ou sem resposta ficam registradas como vazias
+    // (inativas, não habilitadas) para não serem consultadas de novo a cada regra
+    for (const QString &unit : units) {
+        const UnitState state = m_serviceStates.unit(unit);
+        ServiceFact fact;
+        fact.activeState = state.activeState;
+        fact.enabledState = state.unitFileState;
+        m_services.insert(unit, fact);
+    }
+#else
+    Q_UNUSED(units);
+#endif
+}
+
+void SystemFacts::collectPackages()
+{
+    TraceSpan span("facts", "packages");
+    m_packagesLoaded = true;
+    m_packages.load();
+}
@@ -0,0 +1,260 @@
+#include "TraceRecorder.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+#include <atomic>
+
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct TraceState {
+    QMutex mutex;
+    QString path;
+    QElapsedTimer clock;
+    QJsonArray metadata;              // nomes do processo e das threads, nunca descartados
+    QJsonArray events;
+    QHash<qint64, QString> threads;   // tid -> nome já registrado
+    quint64 nextAsyncId = 1;
+    int maxEvents = 0;
+    qint64 droppedEvents = 0;
+};
+
+std::atomic<bool> g_enabled(false);
+
+TraceState &state()
+{
+    static TraceState instance;
+    return instance;
+}
+
+// No Linux o tid do kernel, o mesmo que aparece em ps e no /proc
+qint64 currentThreadId()
+{
+#ifdef Q_OS_LINUX
+    return qint64(syscall(SYS_gettid));
+#else
+    return qint64(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+#endif
+}
+
+// Chamado com o mutex travado: nomeia a thread na primeira vez que aparece
+QJsonObject baseEvent(TraceState &s, const char *phase, const char *category, const QString &name, qint64 ts)
+{
+    const qint64 tid = currentThreadId();
+    const qint64 pid = QCoreApplication::applicationPid();
+    
+    if (!s.threads.contains(tid)) {
+        QString threadName = QThread::currentThread()->objectName();
+        if (QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread()) {
+            threadName = "main";
+        } else if (threadName.isEmpty()) {
+            threadName = QString("thread %1").arg(tid);
+        }
+        s.threads.insert(tid, threadName);
+        
+        QJsonObject meta;
+        meta["ph"] = "M";
+        meta["name"] = "thread_name";
+        meta["pid"] = pid;
+        meta["tid"] = tid;
+        meta["args"] = QJsonObject{ { "name", threadName } };
+        s.metadata.append(meta);
+    }
+    
+    QJsonObject event;
+    event["ph"] = phase;
+    event["cat"] = category;
+    event["name"] = name;
+    event["ts"] = ts;
+    event["pid"] = pid;
+    event["tid"] = tid;
+    return event;
+}
+
+// Chamado com o mutex travado. Descarta de uma vez o quarto mais antigo, para
+// não pagar a cópia do array a cada evento novo
+void append(TraceState &s, const QJsonObject &event)
+{
+    s.events.append(event);
+    if (s.maxEvents > 0 && s.events.size() > s.maxEvents) {
+        const int drop = qMax(1, s.maxEvents / 4);
+        QJsonArray kept;
+        for (int i = drop; i < s.events.size(); i++) {
+            kept.append(s.events.at(i));
+        }
+        s.events = kept;
+        s.droppedEvents += drop;
+    }
+}
+
+// Chamado com o mutex travado
+bool write(TraceState &s)
+{
+    QJsonArray all = s.metadata;
+    const QJsonArray &events = s.events;
+    for (const QJsonValue &event : events) {
+        all.append(event);
+    }
+    
+    QJsonObject root;
+    root["traceEvents"] = all;
+    root["displayTimeUnit"] = "ms";
+    if (s.droppedEvents > 0) {
+        root["otherData"] = QJsonObject{ { "droppedEvents", s.droppedEvents } };
+    }
+    
+    QSaveFile file(s.path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning().noquote() << "Não foi possível gravar o trace:" << s.path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        return false;
+    }
+    
+    qDebug().noquote() << "Trace com" << s.events.size() << "eventos gravado em" << s.path;
+    return true;
+}
+
+}
+
+void TraceRecorder::start(const QString &path)
+{
+    TraceState &s = state();
+    QMutexLocker locker(&s.mutex);
+    s.path = path;
+    s.metadata = QJsonArray();
+    s.events = QJsonArray();
+    s.threads.clear();
+    s.droppedEvents = 0;
+    s.clock.start();
+    
+    QJsonObject meta;
+    meta["ph"] = "M";
+    meta["name"] = "process_name";
+    meta["pid"] = QCoreApplication::applicationPid();
+    meta["args"] = QJsonObject{ { "name", QCoreApplication::applicationName() } };
+    s.metadata.append(meta);
+    
+    g_enabled.store(true, std::memory_order_release);
+}
+
+bool TraceRecorder::stop()
+{
+    if (!g_enabled.exchange(false)) {
+        return true;
+    }
+    
+    TraceState &s = state();
+    QMutexLocker locker(&s.mutex);
+    const bool written = write(s);
+    s.metadata = QJsonArray();
+    s.events = QJsonArray();
+    return written;
+}
+
+bool TraceRecorder::flush()
+{
+    if (!isEnabled()) {
+        return true;
+    }
+    
+    TraceState &s = state();
+    QMutexLocker locker(&s.mutex);
+    return write(s);
+}
+
+void TraceRecorder::setMaxEvents(int maxEvents)
+{
+    TraceState &s = state();
+    QMutexLocker locker(&s.mutex);
+    s.maxEvents = qMax(0, maxEvents);
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return g_enabled.load(std::memory_order_acquire);
+}
+
+qint64 TraceRecorder::now()
+{
+    if (!isEnabled()) {
+        return 0;
+    }
+    return state().clock.nsecsElapsed() / 1000;
+}
+
+void TraceRecorder::complete(const char *category, const QString &name, qint64 startUs, const QJsonObject &args)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    
+    TraceState &s = state();
+    const qint64 end = now();
+    QMutexLocker locker(&s.mutex);
+    
+    QJsonObject event = baseEvent(s, "X", category, name, startUs);
+    event["dur"] = qMax<qint64>(0, end - startUs);
+    if (!args.isEmpty()) {
+        event["args"] = args;
+    }
+    append(s, event);
+}
+
+void TraceRecorder::completeAsync(const char *category, const QString &name, qint64 startUs, const QJsonObject &args)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    
+    TraceState &s = state();
+    const qint64 end = now();
+    QMutexLocker locker(&s.mutex);
+    
+    const QString id = QString("0x%1").arg(s.nextAsyncId++, 0, 16);
+    QJsonObject begin = baseEvent(s, "b", category, name, startUs);
+    begin["id"] = id;
+    if (!args.isEmpty()) {
+        begin["args"] = args;
+    }
+    QJsonObject finish = baseEvent(s, "e", category, name, end);
+    finish["id"] = id;
+    append(s, begin);
+    append(s, finish);
+}
+
+TraceSpan::TraceSpan(const char *category, const QString &name)
+    : m_category(category)
+    , m_start(-1)
+{
+    if (TraceRecorder::isEnabled()) {
+        m_name = name;
+        m_start = TraceRecorder::now();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (m_start >= 0) {
+        TraceRecorder::complete(m_category, m_name, m_start, m_args);
+    }
+}
+
+void TraceSpan::setArg(const QString &key, const QJsonValue &value)
+{
+    if (m_start >= 0) {
+        m_args.insert(key, value);
+    }
+}
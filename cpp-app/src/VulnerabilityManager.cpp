@@ -1,19 +1,44 @@
 #include "VulnerabilityManager.h"
+#include "TraceRecorder.h"
+#include "PlatformFingerprint.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QThread>
+#include <QTimer>
 #include <QJsonParseError>
 #include <QDebug>
-#include <QCoreApplication>
-#include <QSysInfo>
-#include <QProcess>
-#include <QStandardPaths>
+#include <QCryptographicHash>
+
+const int VulnerabilityManager::RELOAD_DEBOUNCE_MS = 250;
 
 VulnerabilityManager::VulnerabilityManager(QObject *parent)
     : QObject(parent)
+    , m_catalog(new RuleCatalog)
+    , m_watcher(nullptr)
+    , m_reloadDebounce(new QTimer(this))
+    , m_reloadThread(nullptr)
+    , m_reloadAgain(false)
+{
+    // Editores e ferramentas de deploy gravam em várias etapas
+    m_reloadDebounce->setSingleShot(true);
+    m_reloadDebounce->setInterval(RELOAD_DEBOUNCE_MS);
+    connect(m_reloadDebounce, &QTimer::timeout, this, &VulnerabilityManager::startReload);
+}
+
+VulnerabilityManager::~VulnerabilityManager()
 {
+    if (m_reloadThread) {
+        m_reloadThread->wait();
+        delete m_reloadThread;
+    }
 }
 
 bool VulnerabilityManager::loadDefinitions(const QString &filePath)
 {
+    TraceSpan span("catalog", "loadDefinitions");
+    span.setArg("path", filePath);
+    
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Não foi possível abrir o arquivo:" << filePath;
@@ -23,262 +48,125 @@ bool VulnerabilityManager::loadDefinitions(const QString &filePath)
     QByteArray data = file.readAll();
     file.close();
     
-    QJsonParseError error;
-    m_definitions = QJsonDocument::fromJson(data, &error);
-    
-    if (error.error != QJsonParseError::NoError) {
-        qWarning() << "Erro ao parsear JSON:" << error.errorString();
+    QString error;
+    RuleCatalogPtr catalog = RuleCatalog::fromJson(filePath, data, false, &error);
+    if (!catalog) {
+        qWarning().noquote() << error;
         return false;
     }
     
+    m_catalog = catalog;
+    m_path = filePath;
     return true;
 }
 
-QVector<VulnerabilityDefinition> VulnerabilityManager::getDefinitionsForOS(const QString &os) const
+QVector<VulnerabilityDefinition> VulnerabilityManager::getDefinitionsForOS(const QString &os, RuleText fields) const
 {
-    QVector<VulnerabilityDefinition> definitions;
-    
-    if (!m_definitions.isObject()) {
-        return definitions;
-    }
-    
-    QJsonObject root = m_definitions.object();
-    if (!root.contains(os) || !root[os].isArray()) {
-        return definitions;
-    }
-    
-    QJsonArray osArray = root[os].toArray();
-    for (const QJsonValue &value : osArray) {
-        if (!value.isObject()) continue;
-        
-        QJsonObject obj = value.toObject();
-        VulnerabilityDefinition def;
-        
-        def.id = obj["id"].toString();
-        def.name = obj["name"].toString();
-        def.description = obj["description"].toString();
-        def.impact = obj["impact"].toString();
-        def.severity = stringToSeverity(obj["severity"].toString());
-        def.fix = obj["fix"].toString();
-        
-        definitions.append(def);
-    }
+    TraceSpan span("catalog", "getDefinitionsForOS");
+    span.setArg("os", os);
     
+    const QVector<VulnerabilityDefinition> definitions = m_catalog->rules(os, fields);
+    span.setArg("rules", definitions.size());
     return definitions;
 }
 
 QStringList VulnerabilityManager::getSupportedOS() const
 {
-    QStringList osList;
-    
-    if (!m_definitions.isObject()) {
-        return osList;
-    }
-    
-    QJsonObject root = m_definitions.object();
-    for (auto it = root.begin(); it != root.end(); ++it) {
-        osList.append(it.key());
-    }
-    
-    return osList;
+    return m_catalog->systems();
 }
 
-QString VulnerabilityManager::getCurrentOS() const
+RuleCatalogPtr VulnerabilityManager::catalog() const
 {
-    qDebug() << "=== DETECÇÃO DETALHADA DO SISTEMA OPERACIONAL ===";
-    
-    // Informações básicas do Qt
-    qDebug() << "Qt SysInfo:";
-    qDebug() << "  - Kernel Type:" << QSysInfo::kernelType();
-    qDebug() << "  - Kernel Version:" << QSysInfo::kernelVersion();
-    qDebug() << "  - Product Type:" << QSysInfo::productType();
-    qDebug() << "  - Product Version:" << QSysInfo::productVersion();
-    qDebug() << "  - Pretty Product Name:" << QSysInfo::prettyProductName();
-    qDebug() << "  - Machine Host Name:" << QSysInfo::machineHostName();
-    qDebug() << "  - CPU Architecture:" << QSysInfo::currentCpuArchitecture();
-    
-    // Macros de compilação
-    qDebug() << "\nMacros de Compilação Qt:";
-#ifdef Q_OS_WIN
-    qDebug() << "  - Q_OS_WIN: DEFINIDA";
-#else
-    qDebug() << "  - Q_OS_WIN: NÃO DEFINIDA";
-#endif
-
-#ifdef Q_OS_LINUX
-    qDebug() << "  - Q_OS_LINUX: DEFINIDA";
-#else
-    qDebug() << "  - Q_OS_LINUX: NÃO DEFINIDA";
-#endif
-
-#ifdef Q_OS_UNIX
-    qDebug() << "  - Q_OS_UNIX: DEFINIDA";
-#else
-    qDebug() << "  - Q_OS_UNIX: NÃO DEFINIDA";
-#endif
-
-#ifdef Q_OS_MAC
-    qDebug() << "  - Q_OS_MAC: DEFINIDA";
-#else
-    qDebug() << "  - Q_OS_MAC: NÃO DEFINIDA";
-#endif
-
-#ifdef Q_OS_MACOS
-    qDebug() << "  - Q_OS_MACOS: DEFINIDA";
-#else
-    qDebug() << "  - Q_OS_MACOS: NÃO DEFINIDA";
-#endif
-
-    // Macros padrão do compilador
-    qDebug() << "\nMacros Padrão do Compilador:";
-#ifdef _WIN32
-    qDebug() << "  - _WIN32: DEFINIDA";
-#else
-    qDebug() << "  - _WIN32: NÃO DEFINIDA";
-#endif
+    return m_catalog;
+}
 
-#ifdef __linux__
-    qDebug() << "  - __linux__: DEFINIDA";
-#else
-    qDebug() << "  - __linux__: NÃO DEFINIDA";
-#endif
+void VulnerabilityManager::watchDefinitions()
+{
+    if (m_path.isEmpty()) {
+        return;
+    }
+    
+    // O diretório cobre substituições por rename, que tiram o arquivo da observação
+    stopWatching();
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath(QFileInfo(m_path).absolutePath());
+    m_watcher->addPath(m_path);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &VulnerabilityManager::onWatchedPathChanged);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &VulnerabilityManager::onWatchedPathChanged);
+    qDebug() << "Observando o catálogo" << m_path;
+}
 
-#ifdef __APPLE__
-    qDebug() << "  - __APPLE__: DEFINIDA";
-#else
-    qDebug() << "  - __APPLE__: NÃO DEFINIDA";
-#endif
+void VulnerabilityManager::stopWatching()
+{
+    delete m_watcher;
+    m_watcher = nullptr;
+    m_reloadDebounce->stop();
+}
 
-#ifdef __unix__
-    qDebug() << "  - __unix__: DEFINIDA";
-#else
-    qDebug() << "  - __unix__: NÃO DEFINIDA";
-#endif
+void VulnerabilityManager::onWatchedPathChanged()
+{
+    // Depois de um rename o arquivo novo precisa ser observado de novo
+    if (m_watcher && !m_watcher->files().contains(m_path) && QFile::exists(m_path)) {
+        m_watcher->addPath(m_path);
+    }
+    m_reloadDebounce->start();
+}
 
-    // Detecção por comando do sistema
-    qDebug() << "\nDetecção por Comandos do Sistema:";
-    
-    QProcess process;
-    process.setProcessChannelMode(QProcess::MergedChannels);
-    
-    // Tentar comando 'uname'
-    process.start("uname", QStringList() << "-a");
-    if (process.waitForFinished(3000)) {
-        QString unameOutput = process.readAllStandardOutput().trimmed();
-        qDebug() << "  - uname -a:" << unameOutput;
-    } else {
-        qDebug() << "  - uname: comando não disponível";
+void VulnerabilityManager::startReload()
+{
+    // Uma recarga por vez; mudanças durante a leitura geram outra ao final
+    if (m_reloadThread) {
+        m_reloadAgain = true;
+        return;
     }
     
-    // Tentar ler /etc/os-release (Linux)
-    QFile osRelease("/etc/os-release");
-    if (osRelease.open(QIODevice::ReadOnly)) {
-        QString content = osRelease.readAll();
-        qDebug() << "  - /etc/os-release encontrado:";
-        QStringList lines = content.split('\n');
-        for (const QString &line : lines) {
-            if (line.startsWith("NAME=") || line.startsWith("VERSION=") || 
-                line.startsWith("ID=") || line.startsWith("PRETTY_NAME=")) {
-                qDebug() << "    " << line;
-            }
+    const QString path = m_path;
+    const QByteArray currentDigest = m_catalog->digest();
+    m_reloadResult.reset();
+    m_reloadError.clear();
+    
+    // O lambda só escreve nos membros de resultado, lidos depois de "finished"
+    m_reloadThread = QThread::create([this, path, currentDigest]() {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            // Arquivo removido ou no meio de uma substituição: nada a publicar
+            return;
         }
-    } else {
-        qDebug() << "  - /etc/os-release: não encontrado";
-    }
-    
-    // Tentar comando 'lsb_release' (Linux)
-    process.start("lsb_release", QStringList() << "-a");
-    if (process.waitForFinished(3000)) {
-        QString lsbOutput = process.readAllStandardOutput().trimmed();
-        if (!lsbOutput.isEmpty()) {
-            qDebug() << "  - lsb_release -a:" << lsbOutput;
+        const QByteArray data = file.readAll();
+        if (QCryptographicHash::hash(data, QCryptographicHash::Sha1) == currentDigest) {
+            return;
         }
-    } else {
-        qDebug() << "  - lsb_release: comando não disponível";
-    }
-    
-    // Verificar arquivos específicos do Windows
-    if (QFile::exists("C:\\Windows\\System32")) {
-        qDebug() << "  - C:\\Windows\\System32: EXISTE (Windows detectado)";
-    } else {
-        qDebug() << "  - C:\\Windows\\System32: NÃO EXISTE";
-    }
-    
-    qDebug() << "\n=== RESULTADO DA DETECÇÃO ===";
-    
-    // Lógica de detecção baseada em múltiplas fontes
-    QString kernelType = QSysInfo::kernelType().toLower();
-    QString productType = QSysInfo::productType().toLower();
-    
-    qDebug() << "Kernel Type (lowercase):" << kernelType;
-    qDebug() << "Product Type (lowercase):" << productType;
-    
-    // Detecção por kernel type (mais confiável)
-    if (kernelType == "winnt" || productType.contains("windows")) {
-        qDebug() << "DETECTADO: Windows (via kernelType/productType)";
-        return "windows";
-    }
-    
-    if (kernelType == "linux" || productType.contains("linux") || productType == "kali" || productType == "ubuntu" || productType == "debian" || productType == "fedora" || productType == "centos" || productType == "arch") {
-        qDebug() << "DETECTADO: Linux (via kernelType/productType)";
-        return "linux";
+        m_reloadResult = RuleCatalog::fromJson(path, data, true, &m_reloadError);
+    });
+    connect(m_reloadThread, &QThread::finished, this, &VulnerabilityManager::onReloadFinished);
+    m_reloadThread->start();
+}
+
+void VulnerabilityManager::onReloadFinished()
+{
+    m_reloadThread->deleteLater();
+    m_reloadThread = nullptr;
+    
+    if (m_reloadResult) {
+        m_catalog = m_reloadResult;
+        m_reloadResult.reset();
+        qDebug() << "Catálogo recarregado:" << m_path;
+        emit definitionsReloaded();
+    } else if (!m_reloadError.isEmpty()) {
+        qWarning().noquote() << "Catálogo novo rejeitado, o anterior continua ativo:" << m_reloadError;
+        emit reloadFailed(m_reloadError);
     }
     
-    if (kernelType == "darwin" || productType.contains("macos") || productType.contains("osx")) {
-        qDebug() << "DETECTADO: macOS (via kernelType/productType)";
-        return "macos";
+    if (m_reloadAgain) {
+        m_reloadAgain = false;
+        startReload();
     }
-    
-    // Fallback para macros Qt
-#ifdef Q_OS_WIN
-    qDebug() << "DETECTADO: Windows (via macro Q_OS_WIN)";
-    return "windows";
-#elif defined(Q_OS_LINUX)
-    qDebug() << "DETECTADO: Linux (via macro Q_OS_LINUX)";
-    return "linux";
-#elif defined(Q_OS_MAC) || defined(Q_OS_MACOS)
-    qDebug() << "DETECTADO: macOS (via macro Q_OS_MAC/Q_OS_MACOS)";
-    return "macos";
-#elif defined(Q_OS_UNIX)
-    // Se é Unix mas não Linux nem macOS, assumir Linux como mais provável
-    qDebug() << "DETECTADO: Sistema Unix-like, assumindo Linux (via macro Q_OS_UNIX)";
-    return "linux";
-#endif
-    
-    // Fallback para macros padrão
-#ifdef _WIN32
-    qDebug() << "DETECTADO: Windows (via macro _WIN32)";
-    return "windows";
-#elif defined(__linux__)
-    qDebug() << "DETECTADO: Linux (via macro __linux__)";
-    return "linux";
-#elif defined(__APPLE__)
-    qDebug() << "DETECTADO: macOS (via macro __APPLE__)";
-    return "macos";
-#elif defined(__unix__)
-    qDebug() << "DETECTADO: Sistema Unix-like, assumindo Linux (via macro __unix__)";
-    return "linux";
-#endif
-    
-    qDebug() << "ERRO: Sistema operacional não pôde ser detectado!";
-    qDebug() << "Sistemas suportados: Windows, Linux, macOS";
-    return "unknown";
 }
 
-Severity VulnerabilityManager::stringToSeverity(const QString &severityStr) const
+QString VulnerabilityManager::getCurrentOS() const
 {
-    if (severityStr == "Alta") return Severity::Alta;
-    if (severityStr == "Média") return Severity::Media;
-    if (severityStr == "Baixa") return Severity::Baixa;
-    return Severity::Media;
+    // Calculado uma vez por processo, sem criar processos
+    return PlatformFingerprint::current().family;
 }
-
-QString VulnerabilityManager::severityToString(Severity severity) const
-{
-    switch (severity) {
-        case Severity::Alta: return "Alta";
-        case Severity::Media: return "Média";
-        case Severity::Baixa: return "Baixa";
-        default: return "Média";
-    }
-}
\ No newline at end of file
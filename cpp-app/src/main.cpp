@@ -4,8 +4,10 @@
 #include <QStandardPaths>
 #include <QStyleFactory>
 #include <QFont>
+#include <QCommandLineParser>
 #include <unistd.h>
 #include "MainWindow.h"
+#include "TraceRecorder.h"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -51,6 +53,22 @@ int main(int argc, char *argv[])
     app.setOrganizationName("OpenSource Security Tools");
     app.setApplicationDisplayName("Security Checker");
     
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Verificador de vulnerabilidades de segurança");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption fullOption("full", "Reavaliar todas as regras, ignorando o cache de resultados");
+    QCommandLineOption metricsOption("metrics", "Gravar resultados e tempos no formato texto do Prometheus (coletor textfile do node_exporter)", "arquivo");
+    QCommandLineOption traceOption("trace", "Gravar os tempos de cada fase em formato trace-event do Chrome (abrir no Perfetto)", "arquivo");
+    parser.addOption(fullOption);
+    parser.addOption(metricsOption);
+    parser.addOption(traceOption);
+    parser.process(app);
+    
+    if (parser.isSet(traceOption)) {
+        TraceRecorder::start(parser.value(traceOption));
+    }
+    
     // Configurar estilo da aplicação
     app.setStyle(QStyleFactory::create("Fusion"));
     
@@ -119,7 +137,11 @@ int main(int argc, char *argv[])
     
     // Criar e mostrar janela principal
     MainWindow window;
+    window.setFullScan(parser.isSet(fullOption));
+    window.setMetricsPath(parser.value(metricsOption));
     window.show();
     
-    return app.exec();
+    const int exitCode = app.exec();
+    TraceRecorder::stop();
+    return exitCode;
 }
\ No newline at end of file
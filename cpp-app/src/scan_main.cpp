@@ -0,0 +1,205 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <QLoggingCategory>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QMap>
+#include <QDebug>
+#include "HeadlessScanner.h"
+#include "ScapImporter.h"
+#include "RuleCatalog.h"
+#include "TraceRecorder.h"
+
+#ifndef _WIN32
+#include <QSocketNotifier>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// No modo --watch o trace é regravado a cada minuto e guarda só os eventos
+// mais recentes, para a memória não crescer enquanto o processo vive
+static const int TRACE_FLUSH_INTERVAL_MS = 60 * 1000;
+static const int WATCH_TRACE_MAX_EVENTS = 200000;
+
+#ifndef _WIN32
+static int g_signalFds[2] = { -1, -1 };
+
+static void onTerminationSignal(int signo)
+{
+    const char byte = char(signo);
+    ssize_t ignored = ::write(g_signalFds[0], &byte, 1);
+    Q_UNUSED(ignored);
+}
+
+// SIGTERM e SIGINT encerram o laço de eventos em vez de matar o processo, para
+// o trace ser gravado. O tratador só escreve em um socket; a
+// leitura acontece no laço de eventos (self-pipe). Sai com 128 + sinal, como
+// um processo morto pelo sinal.
+static void installTerminationHandler(QCoreApplication *app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, g_signalFds) != 0) {
+        qWarning() << "Não foi possível instalar o tratador de sinais";
+        return;
+    }
+    // Comandos de verificação não herdam o socket (SOCK_CLOEXEC não existe no macOS)
+    ::fcntl(g_signalFds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(g_signalFds[1], F_SETFD, FD_CLOEXEC);
+    
+    auto *notifier = new QSocketNotifier(g_signalFds[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, [notifier]() {
+        char signo = 0;
+        if (::read(g_signalFds[1], &signo, 1) == 1) {
+            notifier->setEnabled(false);
+            qDebug() << "Sinal" << int(signo) << "recebido; encerrando";
+            QCoreApplication::exit(128 + int(signo));
+        }
+    });
+    
+    struct sigaction action = {};
+    action.sa_handler = onTerminationSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+}
+#endif
+
+// Converte conteúdo SCAP em um catálogo na saída padrão; o resumo do que ficou
+// de fora vai para stderr, agrupado pelo motivo (cada item com --verbose)
+static int importScap(const QStringList &files)
+{
+    ScapImporter importer;
+    for (const QString &file : files) {
+        QString error;
+        if (!importer.addFile(file, &error)) {
+            qCritical().noquote() << error;
+            return HeadlessScanner::ExitError;
+        }
+    }
+    
+    const QJsonArray rules = importer.rules();
+    QJsonObject catalog;
+    catalog["linux"] = rules;
+    const QByteArray data = QJsonDocument(catalog).toJson(QJsonDocument::Indented);
+    
+    // O catálogo gerado precisa carregar como um escrito à mão
+    QString error;
+    if (!RuleCatalog::fromJson(QString(), data, true, &error)) {
+        qCritical().noquote() << error;
+        return HeadlessScanner::ExitError;
+    }
+    
+    QMap<QString, int> reasons;
+    for (const ScapSkip &skip : importer.skipped()) {
+        reasons[skip.reason]++;
+        qDebug().noquote() << "Ignorada:" << skip.id << "-" << skip.reason << skip.detail;
+    }
+    
+    QTextStream err(stderr);
+    err << "Importadas " << rules.size() << " regras; " << importer.skipped().size() << " ignoradas" << Qt::endl;
+    for (auto it = reasons.begin(); it != reasons.end(); ++it) {
+        err << QString("%1  %2").arg(it.value(), 7).arg(it.key()) << Qt::endl;
+    }
+    
+    QTextStream(stdout) << data;
+    return rules.isEmpty() ? HeadlessScanner::ExitError : HeadlessScanner::ExitClean;
+}
+
+// Varredura sem interface gráfica, para cron e ferramentas de gerência de
+// configuração. O código de saída indica a maior severidade encontrada.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("SecurityChecker");
+    app.setApplicationVersion("1.0.0");
+    app.setOrganizationName("OpenSource Security Tools");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Verificador de vulnerabilidades de segurança (sem interface)\n\n"
+        "Códigos de saída: 0 nenhuma vulnerabilidade, 1 baixa, 2 média, 3 alta, 4 erro");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption fullOption("full", "Reavaliar todas as regras, ignorando o cache de resultados");
+    QCommandLineOption rulesOption("rules", "Catálogo de regras (padrão: vulnerabilities.json ao lado do executável)", "arquivo");
+    QCommandLineOption formatOption("format", "Formato da saída: json ou text (padrão: json)", "formato", "json");
+    QCommandLineOption watchOption("watch", "Continuar em execução e reavaliar regras quando suas entradas mudarem");
+    QCommandLineOption intervalOption("interval", "Intervalo, em segundos, para reavaliar no modo --watch as regras sem entradas observáveis (padrão: 300)", "segundos", "300");
+    QCommandLineOption rootOption("root", "Varrer offline um sistema de arquivos montado em vez do sistema atual (pode ser repetido)", "diretório");
+    QCommandLineOption jobsOption("jobs", "Raízes varridas em paralelo com --root (padrão: uma por núcleo)", "n", "0");
+    QCommandLineOption metricsOption("metrics", "Gravar resultados e tempos no formato texto do Prometheus (coletor textfile do node_exporter)", "arquivo");
+    QCommandLineOption traceOption("trace", "Gravar os tempos de cada fase em formato trace-event do Chrome (abrir no Perfetto)", "arquivo");
+    QCommandLineOption importOption("import-scap", "Converter conteúdo SCAP (benchmark XCCDF, definições OVAL ou data stream) em um catálogo de regras na saída padrão (pode ser repetido)", "arquivo");
+    QCommandLineOption verboseOption("verbose", "Mostrar mensagens de depuração em stderr");
+    parser.addOption(fullOption);
+    parser.addOption(rulesOption);
+    parser.addOption(formatOption);
+    parser.addOption(watchOption);
+    parser.addOption(intervalOption);
+    parser.addOption(rootOption);
+    parser.addOption(jobsOption);
+    parser.addOption(metricsOption);
+    parser.addOption(traceOption);
+    parser.addOption(importOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+    
+    // stdout leva só o resultado; avisos e erros continuam em stderr
+    if (!parser.isSet(verboseOption)) {
+        QLoggingCategory::setFilterRules("*.debug=false");
+    }
+    
+    const QString format = parser.value(formatOption);
+    if (format != "json" && format != "text") {
+        qCritical().noquote() << "Formato desconhecido:" << format;
+        return HeadlessScanner::ExitError;
+    }
+    
+    const QStringList roots = parser.values(rootOption);
+    if (!roots.isEmpty() && parser.isSet(watchOption)) {
+        qWarning() << "--watch não se aplica a --root; fazendo uma única varredura";
+    }
+    
+    if (parser.isSet(traceOption)) {
+        TraceRecorder::start(parser.value(traceOption));
+    }
+    
+    if (parser.isSet(importOption)) {
+        const int exitCode = importScap(parser.values(importOption));
+        TraceRecorder::stop();
+        return exitCode;
+    }
+    
+    HeadlessScanner scanner;
+    scanner.setFullScan(parser.isSet(fullOption));
+    scanner.setWatchMode(parser.isSet(watchOption) && roots.isEmpty(), parser.value(intervalOption).toInt());
+    scanner.setRoots(roots);
+    scanner.setJobs(parser.value(jobsOption).toInt());
+    scanner.setMetricsPath(parser.value(metricsOption));
+    scanner.setOutputFormat(format == "text" ? HeadlessScanner::OutputFormat::Text
+                                             : HeadlessScanner::OutputFormat::Json);
+    if (parser.isSet(rulesOption)) {
+        scanner.setRulesPath(parser.value(rulesOption));
+    }
+    
+    QTimer traceFlush;
+    if (parser.isSet(traceOption) && parser.isSet(watchOption) && roots.isEmpty()) {
+        TraceRecorder::setMaxEvents(WATCH_TRACE_MAX_EVENTS);
+        QObject::connect(&traceFlush, &QTimer::timeout, []() {
+            TraceRecorder::flush();
+        });
+        traceFlush.start(TRACE_FLUSH_INTERVAL_MS);
+    }
+
+#ifndef _WIN32
+    installTerminationHandler(&app);
+#endif
+
+    QTimer::singleShot(0, &scanner, &HeadlessScanner::start);
+    const int exitCode = app.exec();
+    TraceRecorder::stop();
+    return exitCode;
+}